@@ -2,6 +2,8 @@
 #define ACTIVATION_H
 
 #include <cmath>
+#include <cstddef>
+#include <algorithm>
 #include <stdexcept>
 
 class Activation
@@ -60,6 +62,38 @@ public:
         return activation_type;
     }
 
+    /**
+     * @brief Applique une fonction d'activation à un bloc contigu de valeurs.
+     *
+     * Le type n'est résolu qu'une seule fois pour tout le bloc, la boucle interne
+     * ne contient donc plus de branchement.
+     *
+     * @param type Le type de fonction d'activation à appliquer.
+     * @param values Les valeurs à transformer (modifiées sur place).
+     * @param count Le nombre de valeurs du bloc.
+     * @throws std::invalid_argument Si le type d'activation est inconnu.
+     */
+    static void apply(Type type, double *values, std::size_t count)
+    {
+        switch (type)
+        {
+        case Type::Sigmoid:
+            for (std::size_t i = 0; i < count; i++)
+                values[i] = sigmoid(values[i]);
+            break;
+        case Type::Tanh:
+            for (std::size_t i = 0; i < count; i++)
+                values[i] = tanh(values[i]);
+            break;
+        case Type::ReLU:
+            for (std::size_t i = 0; i < count; i++)
+                values[i] = relu(values[i]);
+            break;
+        default:
+            throw std::invalid_argument("Unknown activation type");
+        }
+    }
+
 private:
     Type activation_type;
 
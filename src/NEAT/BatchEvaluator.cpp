@@ -0,0 +1,310 @@
+#include "BatchEvaluator.h"
+#include <unordered_map>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <cassert>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Le nombre de lignes d'un groupe est arrondi à ce multiple, quel que soit le jeu d'instructions
+    constexpr int GROUP_ALIGN = 4;
+
+#if defined(__AVX2__)
+    constexpr int LANES = 4;
+    using vec = __m256d;
+
+    inline vec vload(const double *p) { return _mm256_loadu_pd(p); }
+    inline void vstore(double *p, vec v) { _mm256_storeu_pd(p, v); }
+    inline vec vset(double x) { return _mm256_set1_pd(x); }
+    inline vec vadd(vec a, vec b) { return _mm256_add_pd(a, b); }
+    inline vec vsub(vec a, vec b) { return _mm256_sub_pd(a, b); }
+    inline vec vmul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+    inline vec vdiv(vec a, vec b) { return _mm256_div_pd(a, b); }
+    inline vec vmin(vec a, vec b) { return _mm256_min_pd(a, b); }
+    inline vec vmax(vec a, vec b) { return _mm256_max_pd(a, b); }
+    // Arrondi à l'entier le plus proche
+    inline vec vround(vec x) { return _mm256_cvtepi32_pd(_mm256_cvtpd_epi32(x)); }
+    // 2^n pour n entier dans [-1022, 1023]
+    inline vec vexp2i(vec n)
+    {
+        __m128i e = _mm_add_epi32(_mm256_cvtpd_epi32(n), _mm_set1_epi32(1023));
+        return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepi32_epi64(e), 52));
+    }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+    constexpr int LANES = 2;
+    using vec = __m128d;
+
+    inline vec vload(const double *p) { return _mm_loadu_pd(p); }
+    inline void vstore(double *p, vec v) { _mm_storeu_pd(p, v); }
+    inline vec vset(double x) { return _mm_set1_pd(x); }
+    inline vec vadd(vec a, vec b) { return _mm_add_pd(a, b); }
+    inline vec vsub(vec a, vec b) { return _mm_sub_pd(a, b); }
+    inline vec vmul(vec a, vec b) { return _mm_mul_pd(a, b); }
+    inline vec vdiv(vec a, vec b) { return _mm_div_pd(a, b); }
+    inline vec vmin(vec a, vec b) { return _mm_min_pd(a, b); }
+    inline vec vmax(vec a, vec b) { return _mm_max_pd(a, b); }
+    inline vec vround(vec x) { return _mm_cvtepi32_pd(_mm_cvtpd_epi32(x)); }
+    inline vec vexp2i(vec n)
+    {
+        __m128i e = _mm_add_epi32(_mm_cvtpd_epi32(n), _mm_set1_epi32(1023));
+        e = _mm_unpacklo_epi32(e, _mm_setzero_si128());
+        return _mm_castsi128_pd(_mm_slli_epi64(e, 52));
+    }
+
+#else
+    constexpr int LANES = 1;
+    using vec = double;
+
+    inline vec vload(const double *p) { return *p; }
+    inline void vstore(double *p, vec v) { *p = v; }
+    inline vec vset(double x) { return x; }
+    inline vec vadd(vec a, vec b) { return a + b; }
+    inline vec vsub(vec a, vec b) { return a - b; }
+    inline vec vmul(vec a, vec b) { return a * b; }
+    inline vec vdiv(vec a, vec b) { return a / b; }
+    // Comme minpd et maxpd : b si la comparaison échoue (NaN)
+    inline vec vmin(vec a, vec b) { return a < b ? a : b; }
+    inline vec vmax(vec a, vec b) { return a > b ? a : b; }
+    inline vec vround(vec x) { return std::nearbyint(x); }
+    inline vec vexp2i(vec n) { return std::ldexp(1.0, static_cast<int>(n)); }
+#endif
+
+    // a * b + c en deux arrondis : une FMA changerait les résultats selon le jeu d'instructions
+    inline vec vmuladd(vec a, vec b, vec c) { return vadd(vmul(a, b), c); }
+
+    /**
+     * @brief Exponentielle vectorielle, la même pour tous les jeux d'instructions.
+     *
+     * x = n * ln(2) + r avec |r| <= ln(2) / 2, puis exp(r) par un polynôme de Taylor
+     * de degré 11 (erreur relative < 1e-14) multiplié par 2^n construit dans l'exposant.
+     */
+    inline vec vexp(vec x)
+    {
+        x = vmin(vmax(x, vset(-708.0)), vset(708.0));
+
+        const vec n = vround(vmul(x, vset(1.4426950408889634)));
+        vec r = vsub(x, vmul(n, vset(6.93145751953125e-1)));
+        r = vsub(r, vmul(n, vset(1.42860682030941723212e-6)));
+
+        vec p = vset(1.0 / 39916800.0);
+        p = vmuladd(p, r, vset(1.0 / 3628800.0));
+        p = vmuladd(p, r, vset(1.0 / 362880.0));
+        p = vmuladd(p, r, vset(1.0 / 40320.0));
+        p = vmuladd(p, r, vset(1.0 / 5040.0));
+        p = vmuladd(p, r, vset(1.0 / 720.0));
+        p = vmuladd(p, r, vset(1.0 / 120.0));
+        p = vmuladd(p, r, vset(1.0 / 24.0));
+        p = vmuladd(p, r, vset(1.0 / 6.0));
+        p = vmuladd(p, r, vset(0.5));
+        p = vmuladd(p, r, vset(1.0));
+        p = vmuladd(p, r, vset(1.0));
+
+        return vmul(p, vexp2i(n));
+    }
+
+    /**
+     * @brief Applique une activation à un bloc contigu de valeurs avec les noyaux vectoriels.
+     * count est un multiple de GROUP_ALIGN, donc de LANES.
+     */
+    void activate_block(Activation::Type type, double *values, std::size_t count)
+    {
+        assert(count % LANES == 0);
+        std::size_t i = 0;
+        const vec one = vset(1.0);
+        const vec two = vset(2.0);
+
+        switch (type)
+        {
+        case Activation::Type::Sigmoid:
+            for (; i + LANES <= count; i += LANES)
+            {
+                const vec x = vload(values + i);
+                vstore(values + i, vdiv(one, vadd(one, vexp(vsub(vset(0.0), x)))));
+            }
+            break;
+        case Activation::Type::Tanh:
+            // tanh(x) = 1 - 2 / (exp(2x) + 1)
+            for (; i + LANES <= count; i += LANES)
+            {
+                const vec e = vexp(vmul(two, vload(values + i)));
+                vstore(values + i, vsub(one, vdiv(two, vadd(e, one))));
+            }
+            break;
+        case Activation::Type::ReLU:
+            for (; i + LANES <= count; i += LANES)
+                vstore(values + i, vmax(vload(values + i), vset(0.0)));
+            break;
+        }
+    }
+}
+
+int BatchEvaluator::simd_width()
+{
+    return LANES;
+}
+
+std::size_t BatchEvaluator::topology_hash(const FeedForwardNeuralNetwork &network)
+{
+    const FeedForwardNeuralNetwork::Topology &plan = *network.m_topology;
+    std::size_t seed = plan.input_ids.size();
+    auto combine = [&seed](std::size_t value)
+    { seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2); };
+
+    for (int offset : plan.input_offsets)
+        combine(offset);
+    for (int source : plan.sources)
+        combine(source);
+    for (const auto &run : plan.runs)
+        combine((static_cast<std::size_t>(run.type) << 32) ^ run.end);
+    for (int slot : plan.output_slots)
+        combine(slot);
+
+    return seed;
+}
+
+bool BatchEvaluator::same_topology(const FeedForwardNeuralNetwork &a, const FeedForwardNeuralNetwork &b)
+{
+    auto same_runs = [](const auto &r1, const auto &r2)
+    { return r1.type == r2.type && r1.begin == r2.begin && r1.end == r2.end; };
+
+    // Réseaux issus du même plan (copies, NetworkCache)
+    if (a.m_topology == b.m_topology)
+        return true;
+
+    const FeedForwardNeuralNetwork::Topology &p1 = *a.m_topology;
+    const FeedForwardNeuralNetwork::Topology &p2 = *b.m_topology;
+    return p1.input_ids.size() == p2.input_ids.size() &&
+           p1.input_offsets == p2.input_offsets &&
+           p1.sources == p2.sources &&
+           p1.output_slots == p2.output_slots &&
+           std::equal(p1.runs.begin(), p1.runs.end(), p2.runs.begin(), p2.runs.end(), same_runs);
+}
+
+void BatchEvaluator::clear()
+{
+    m_networks.clear();
+    m_groups.clear();
+    m_input_count = 0;
+    m_output_count = 0;
+}
+
+void BatchEvaluator::rebuild(const std::vector<FeedForwardNeuralNetwork *> &networks)
+{
+    clear();
+    if (networks.empty())
+        return;
+
+    m_networks = networks;
+    m_input_count = networks.front()->input_count();
+    m_output_count = networks.front()->output_count();
+
+    // Regroupe les réseaux par topologie, le hash ne sert qu'à limiter les comparaisons
+    std::vector<std::vector<int>> classes;
+    std::unordered_map<std::size_t, std::vector<int>> classes_by_hash;
+
+    for (size_t n = 0; n < networks.size(); n++)
+    {
+        const FeedForwardNeuralNetwork &network = *networks[n];
+        if (network.input_count() != m_input_count || network.output_count() != m_output_count)
+            throw std::runtime_error("BatchEvaluator: all networks must have the same inputs and outputs.");
+
+        std::vector<int> &candidates = classes_by_hash[topology_hash(network)];
+        auto it = std::find_if(candidates.begin(), candidates.end(), [&](int c)
+                               { return same_topology(*networks[classes[c].front()], network); });
+
+        if (it != candidates.end())
+        {
+            classes[*it].push_back(n);
+        }
+        else
+        {
+            candidates.push_back(classes.size());
+            classes.push_back({static_cast<int>(n)});
+        }
+    }
+
+    for (std::vector<int> &members : classes)
+    {
+        Group group;
+        group.model = networks[members.front()];
+        group.width = (members.size() + GROUP_ALIGN - 1) / GROUP_ALIGN * GROUP_ALIGN;
+
+        const FeedForwardNeuralNetwork &model = *group.model;
+        const size_t num_neurons = model.m_parameters->bias.size();
+        const size_t num_links = model.m_parameters->weights.size();
+
+        // Les lignes de remplissage gardent des poids et des biais nuls
+        group.bias.assign(num_neurons * group.width, 0.0);
+        group.weights.assign(num_links * group.width, 0.0);
+        group.values.assign(model.m_values.size() * group.width, 0.0);
+
+        for (size_t j = 0; j < members.size(); j++)
+        {
+            const FeedForwardNeuralNetwork &network = *networks[members[j]];
+            for (size_t k = 0; k < num_neurons; k++)
+                group.bias[k * group.width + j] = network.m_parameters->bias[k];
+            for (size_t c = 0; c < num_links; c++)
+                group.weights[c * group.width + j] = network.m_parameters->weights[c];
+        }
+
+        group.members = std::move(members);
+        m_groups.push_back(std::move(group));
+    }
+}
+
+void BatchEvaluator::activate(const double *inputs, double *outputs)
+{
+    for (Group &group : m_groups)
+        activate_group(group, inputs, outputs);
+}
+
+void BatchEvaluator::activate_group(Group &group, const double *inputs, double *outputs)
+{
+    const FeedForwardNeuralNetwork &model = *group.model;
+    const size_t count = m_networks.size();
+    const size_t members = group.members.size();
+    const int width = group.width;
+
+    double *values = group.values.data();
+    const double *bias = group.bias.data();
+    const double *weights = group.weights.data();
+    const int *offsets = model.m_topology->input_offsets.data();
+    const int *sources = model.m_topology->sources.data();
+
+    for (size_t i = 0; i < m_input_count; i++)
+    {
+        for (size_t j = 0; j < members; j++)
+            values[i * width + j] = inputs[i * count + group.members[j]];
+    }
+
+    double *computed = values + m_input_count * width;
+    for (const auto &run : model.m_topology->runs)
+    {
+        for (int k = run.begin; k < run.end; k++)
+        {
+            for (int j = 0; j < width; j += LANES)
+            {
+                vec acc = vload(bias + k * width + j);
+                for (int c = offsets[k]; c < offsets[k + 1]; c++)
+                    acc = vmuladd(vload(values + sources[c] * width + j), vload(weights + c * width + j), acc);
+                vstore(computed + k * width + j, acc);
+            }
+        }
+        activate_block(run.type, computed + run.begin * width, (run.end - run.begin) * width);
+    }
+
+    for (size_t o = 0; o < m_output_count; o++)
+    {
+        const double *slot = values + model.m_topology->output_slots[o] * width;
+        for (size_t j = 0; j < members; j++)
+            outputs[o * count + group.members[j]] = slot[j];
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef BATCH_EVALUATOR_H
+#define BATCH_EVALUATOR_H
+
+#include <vector>
+#include <cstddef>
+#include "NeuralNetwork.h"
+
+/**
+ * @brief Évalue un lot de réseaux de neurones en une seule passe.
+ *
+ * Les réseaux partageant le même plan compilé (même topologie, seuls les poids et
+ * les biais diffèrent) sont regroupés : leurs paramètres sont stockés en
+ * structure-of-arrays, un réseau par ligne SIMD, et évalués ensemble par des noyaux
+ * AVX2 (si compilé avec -mavx2) ou SSE2. Un réseau sans équivalent dans le lot forme
+ * un groupe à lui seul.
+ *
+ * Chaque ligne fait les mêmes opérations, dans le même ordre et sans FMA, quels que soient
+ * le groupe et le jeu d'instructions : les sorties d'un réseau ne dépendent pas du reste du
+ * lot et sont identiques au bit près entre les builds AVX2, SSE2 et scalaires (compilés avec
+ * -ffp-contract=off, comme dans les Makefile, sinon le compilateur fusionne lui-même en FMA). Elles ne
+ * diffèrent de FeedForwardNeuralNetwork::activate que par l'exponentielle polynomiale
+ * des activations sigmoid et tanh (écart relatif < 1e-13 par neurone).
+ *
+ * Les entrées et les sorties sont des matrices structure-of-arrays :
+ * la valeur i du réseau n se trouve à l'indice i * size() + n.
+ */
+class BatchEvaluator
+{
+public:
+    /**
+     * @brief Prépare le lot : regroupe les réseaux par topologie et recopie leurs paramètres.
+     *
+     * A rappeler dès que l'un des réseaux change ou est détruit.
+     *
+     * @param networks Les réseaux du lot, ils doivent tous avoir le même nombre d'entrées et de sorties.
+     * @throws std::runtime_error Si les réseaux n'ont pas tous les mêmes dimensions.
+     */
+    void rebuild(const std::vector<FeedForwardNeuralNetwork *> &networks);
+
+    /**
+     * @brief Vide le lot.
+     */
+    void clear();
+
+    /**
+     * @brief Active tous les réseaux du lot.
+     *
+     * @param inputs Matrice des entrées (input_count() x size()).
+     * @param outputs Matrice recevant les sorties (output_count() x size()).
+     */
+    void activate(const double *inputs, double *outputs);
+
+    std::size_t size() const { return m_networks.size(); }
+    std::size_t input_count() const { return m_input_count; }
+    std::size_t output_count() const { return m_output_count; }
+
+    // Nombre de topologies différentes dans le lot
+    std::size_t group_count() const { return m_groups.size(); }
+
+    // Nombre de lignes traitées par instruction par les noyaux compilés (1, 2 ou 4)
+    static int simd_width();
+
+private:
+    // Réseaux de même topologie, paramètres rangés [neurone ou connexion][ligne]
+    struct Group
+    {
+        const FeedForwardNeuralNetwork *model;
+        std::vector<int> members;
+        int width;
+        std::vector<double> bias;
+        std::vector<double> weights;
+        std::vector<double> values;
+    };
+
+    void activate_group(Group &group, const double *inputs, double *outputs);
+
+    static std::size_t topology_hash(const FeedForwardNeuralNetwork &network);
+    static bool same_topology(const FeedForwardNeuralNetwork &a, const FeedForwardNeuralNetwork &b);
+
+    std::vector<FeedForwardNeuralNetwork *> m_networks;
+    std::vector<Group> m_groups;
+
+    std::size_t m_input_count = 0;
+    std::size_t m_output_count = 0;
+};
+
+#endif // BATCH_EVALUATOR_H
@@ -92,12 +92,13 @@ double ComputeFitness::evaluate_lab(const simu::Vec2i &startPos, const simu::Vec
     int goodWallAvoidanceMoves = ant.getGoodWallAvoidanceMoves();
     int numberOfCheckpoints = ant.getNumberOfCheckpoints();
     
-    std::unordered_set<std::pair<int, int>, simu::pair_hash> visitedPositions = ant.getVisitedPositions();
+    const simu::VisitedTiles &visitedPositions = ant.getVisitedPositions();
     Vec2i antPos = ant.getGridPos();
 
 
-    double current_distance = static_cast<double>(grid.findPath(antPos, goalPos).size());
-    double far_from_goal = static_cast<double>(grid.findPath(startPos, antPos).size());
+    // Lectures dans les champs de distance de l'arrivée et du départ (un BFS par révision de la grille)
+    double current_distance = static_cast<double>(grid.pathDistance(antPos, goalPos));
+    double far_from_goal = static_cast<double>(grid.pathDistance(antPos, startPos));
 
     
 
@@ -161,5 +162,17 @@ double ComputeFitness::evaluate_lab(const simu::Vec2i &startPos, const simu::Vec
     return fitness ;
 }
 
+std::vector<double> ComputeFitness::evaluate_lab_all(const simu::Vec2i &startPos, const simu::Vec2i &goalPos, simu::Grid &grid, const std::vector<simu::EntityHandle<simu::AntIA>> &ants, double initial_distance, int current_generation, simu::ThreadPool &pool) const {
+    std::vector<double> fitnesses(ants.size(), 0.0);
 
+    // Chaque fourmi écrit dans sa propre case, les A* utilisent la mémoire de travail de leur thread
+    pool.parallelFor(ants.size(), 4, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t i = begin; i < end; i++) {
+            if (auto ant = ants[i].lock()) {
+                fitnesses[i] = evaluate_lab(startPos, goalPos, grid, *ant, initial_distance, current_generation);
+            }
+        }
+    });
 
+    return fitnesses;
+}
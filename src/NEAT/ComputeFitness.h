@@ -6,6 +6,10 @@
     #include "../engine/tiles.h"  
     #include "../engine/types.h"
     #include "../engine/ant.h"
+    #include "../engine/entityPool.h"
+    #include "../engine/threadpool.h"
+    #include <vector>
+    #include <memory>
 
     class ComputeFitness {
     public:
@@ -21,6 +25,10 @@
         double evaluate_rpc(const Genome &genome, int ant_id) const;
 
         double evaluate_lab(const simu::Vec2i &startPos, const simu::Vec2i &goalPos, simu::Grid &grid, simu::AntIA &ant, double initial_distance,int current_generation) const;
+
+        // Évalue evaluate_lab pour toutes les fourmis sur le pool de threads.
+        // Renvoie la fitness de chaque fourmi dans l'ordre de ants (0 pour une fourmi expirée).
+        std::vector<double> evaluate_lab_all(const simu::Vec2i &startPos, const simu::Vec2i &goalPos, simu::Grid &grid, const std::vector<simu::EntityHandle<simu::AntIA>> &ants, double initial_distance, int current_generation, simu::ThreadPool &pool) const;
         
 
     private:
@@ -5,6 +5,11 @@
 #include <iostream>
 #include <vector>
 #include <functional>
+#include <limits>
+#include <algorithm>
+#include <unordered_set>
+#include <stdexcept>
+#include <string>
 
 // Constructeur par défaut
 Genome::Genome() : genome_id(0), num_inputs(0), num_outputs(0) {}
@@ -12,32 +17,31 @@ Genome::Genome() : genome_id(0), num_inputs(0), num_outputs(0) {}
 Genome::Genome(int id, int num_inputs, int num_outputs)
     : genome_id(id), num_inputs(num_inputs), num_outputs(num_outputs) {}
 
-// Crée un nouveau génome avec les neurones d'entrée, de sortie et un certain nombre de neurones cachés
-// Fonction auxiliaire pour vérifier si un lien créerait un cycle
 bool Genome::would_create_cycle(int input_id, int output_id) const {
-    std::unordered_set<int> visited;
-    std::unordered_map<int, std::vector<int>> graph;
-
-    // Construire le graphe actuel des connexions
-    for (const auto &link : links) {
-        if (link.is_enabled) {
-            graph[link.link_id.input_id].push_back(link.link_id.output_id);
+    if (input_id == output_id) return true;
+
+    const int size = rank.size();
+    if (input_id < 0 || output_id < 0 || input_id >= size || output_id >= size) return false;
+    if (rank[input_id] < 0 || rank[output_id] < 0) return false;
+
+    // Un lien vers un neurone placé après ne peut pas fermer de cycle
+    const int upper = rank[input_id];
+    if (rank[output_id] > upper) return false;
+
+    // Sinon, chercher un chemin output_id -> input_id parmi les neurones placés avant input_id
+    std::vector<int> stack{output_id};
+    std::unordered_set<int> visited{output_id};
+    while (!stack.empty()) {
+        const int current = stack.back();
+        stack.pop_back();
+        for (int next : successors[current]) {
+            if (next == input_id) return true;
+            if (rank[next] < upper && visited.insert(next).second) {
+                stack.push_back(next);
+            }
         }
     }
-
-    // Effectuer une recherche en profondeur pour voir s'il existe un chemin de output_id vers input_id
-    std::function<bool(int)> dfs = [&](int current) {
-        if (current == input_id) return true;
-        if (visited.count(current)) return false;
-
-        visited.insert(current);
-        for (int neighbor : graph[current]) {
-            if (dfs(neighbor)) return true;
-        }
-        return false;
-    };
-
-    return dfs(output_id);
+    return false;
 }
 
 bool Genome::operator==(const Genome &other) const {
@@ -354,11 +358,23 @@ Genome Genome::create_minimal_genome(int num_inputs, int num_outputs, RNG &rng)
 }
 
 double Genome::compute_distance(const Genome &other, const NeatConfig &config) const {
+    return compute_distance(other, config, std::numeric_limits<double>::infinity());
+}
+
+double Genome::compute_distance(const Genome &other, const NeatConfig &config, double limit) const {
     int num_disjoint = 0;
     int num_excess = 0;
     double weight_diff = 0.0;
     int matching_genes = 0;
 
+    int max_genes = std::max(links.size(), other.links.size());
+
+    // Les gènes disjoints et en excès ne font qu'augmenter la distance, le terme des poids est positif
+    auto structural = [&]() {
+        return (config.compatibility_coefficient_excess * num_excess) / max_genes +
+               (config.compatibility_coefficient_disjoint * num_disjoint) / max_genes;
+    };
+
     auto it1 = links.begin();
     auto it2 = other.links.begin();
 
@@ -381,15 +397,16 @@ double Genome::compute_distance(const Genome &other, const NeatConfig &config) c
             ++matching_genes;
             ++it1;
             ++it2;
+            continue;
         }
+
+        if (structural() >= limit)
+            return structural();
     }
 
-    int max_genes = std::max(links.size(), other.links.size());
     double avg_weight_diff = (matching_genes > 0) ? (weight_diff / matching_genes) : 0.0;
 
-    return (config.compatibility_coefficient_excess * num_excess) / max_genes +
-           (config.compatibility_coefficient_disjoint * num_disjoint) / max_genes +
-           (config.compatibility_coefficient_weights * avg_weight_diff);
+    return structural() + (config.compatibility_coefficient_weights * avg_weight_diff);
 }
 
 
@@ -415,7 +432,7 @@ neat::LinkGene Genome::create_link_div_with_inov(int input_id, int output_id, RN
         ? rng.uniform(-3.0, 3.0)  // Poids uniformes
         : rng.next_gaussian(0.0, 2.0);  // Poids gaussiens
 
-    int innovation_number = InnovationTracker::get_new_innovation();
+    int innovation_number = InnovationTracker::get_innovation({input_id, output_id});
 
     return neat::LinkGene{{input_id, output_id}, weight, true, innovation_number};
 }
@@ -438,20 +455,28 @@ int Genome::get_genome_id() const {
     return genome_id;  // Retourne l'ID du génome
 }
 
-std::vector<neat::NeuronGene> Genome::get_neurons() const {
+const std::vector<neat::NeuronGene>& Genome::get_neurons() const {
     return neurons;  // Retourne les neurones du génome
 }
 
-std::vector<neat::LinkGene> Genome::get_links() const {
+const std::vector<neat::LinkGene>& Genome::get_links() const {
     return links;  // Retourne les liens du génome
 }
 
-std::vector<neat::NeuronGene>& Genome::get_neurons() {
-    return neurons;  // Retourne les neurones du génome
+void Genome::set_bias(size_t neuron_index, double bias) {
+    neurons.at(neuron_index).bias = bias;
 }
 
-std::vector<neat::LinkGene>& Genome::get_links() {
-    return links;  // Retourne les liens du génome
+void Genome::set_activation(size_t neuron_index, Activation activation) {
+    neurons.at(neuron_index).activation = activation;
+}
+
+void Genome::set_weight(size_t link_index, double weight) {
+    links.at(link_index).weight = weight;
+}
+
+void Genome::set_enabled(size_t link_index, bool enabled) {
+    links.at(link_index).is_enabled = enabled;
 }
 
 int Genome::generate_next_neuron_id() {
@@ -464,31 +489,206 @@ int Genome::generate_next_neuron_id() {
     return max_id + 1;
 }
 
-// Ajout des fonctions de gestion de neurones et liens
+void Genome::reserve(size_t neuron_count, size_t link_count) {
+    neurons.reserve(neuron_count);
+    links.reserve(link_count);
+    topological_order.reserve(neuron_count);
+}
+
+// Ajout des fonctions de gestion de neurones et liens, à leur place dans l'ordre des ID / numéros d'innovation
 void Genome::add_neuron(const neat::NeuronGene &neuron) {
-    neurons.push_back(neuron);
+    add_node(neuron.neuron_id);
+
+    if (neurons.empty() || neurons.back().neuron_id <= neuron.neuron_id) {
+        neurons.push_back(neuron);  // Cas courant : neurone le plus récent
+        return;
+    }
+
+    auto position = std::upper_bound(neurons.begin(), neurons.end(), neuron.neuron_id,
+        [](int id, const neat::NeuronGene &other) { return id < other.neuron_id; });
+    neurons.insert(position, neuron);
 }
 
 void Genome::add_link(const neat::LinkGene &link) {
-    links.push_back(link);
+    neat::LinkGene added = link;
+    added.innovation_number = InnovationTracker::get_innovation(link.link_id);
+
+    add_edge(link.link_id.input_id, link.link_id.output_id);
+
+    if (links.empty() || links.back().innovation_number <= added.innovation_number) {
+        links.push_back(added);
+        return;
+    }
+
+    auto position = std::upper_bound(links.begin(), links.end(), added.innovation_number,
+        [](int innovation, const neat::LinkGene &other) { return innovation < other.innovation_number; });
+    links.insert(position, added);
+}
+
+void Genome::remove_link(neat::LinkId link_id) {
+    const int innovation = InnovationTracker::get_innovation(link_id);
+    auto it = std::lower_bound(links.begin(), links.end(), innovation,
+        [](const neat::LinkGene &link, int value) { return link.innovation_number < value; });
+    if (it == links.end() || !(it->link_id == link_id)) return;
+
+    links.erase(it);
+    remove_edge(link_id.input_id, link_id.output_id);
+}
+
+void Genome::remove_neuron(int neuron_id) {
+    links.erase(std::remove_if(links.begin(), links.end(),
+        [neuron_id](const neat::LinkGene &link) {
+            return link.link_id.input_id == neuron_id || link.link_id.output_id == neuron_id;
+        }), links.end());
+
+    neurons.erase(std::remove_if(neurons.begin(), neurons.end(),
+        [neuron_id](const neat::NeuronGene &neuron) { return neuron.neuron_id == neuron_id; }), neurons.end());
+
+    if (neuron_id < 0 || neuron_id >= static_cast<int>(rank.size()) || rank[neuron_id] < 0) return;
+
+    for (int next : successors[neuron_id]) {
+        auto &edges = predecessors[next];
+        edges.erase(std::remove(edges.begin(), edges.end(), neuron_id), edges.end());
+    }
+    for (int previous : predecessors[neuron_id]) {
+        auto &edges = successors[previous];
+        edges.erase(std::remove(edges.begin(), edges.end(), neuron_id), edges.end());
+    }
+    successors[neuron_id].clear();
+    predecessors[neuron_id].clear();
+
+    // Retirer un neurone ne casse pas l'ordre, seules les positions suivantes se décalent
+    topological_order.erase(topological_order.begin() + rank[neuron_id]);
+    for (size_t i = rank[neuron_id]; i < topological_order.size(); ++i) {
+        rank[topological_order[i]] = i;
+    }
+    rank[neuron_id] = -1;
+}
+
+const std::vector<int>& Genome::get_topological_order() const {
+    return topological_order;
+}
+
+const std::vector<int>& Genome::get_successors(int neuron_id) const {
+    static const std::vector<int> none;
+    return (neuron_id >= 0 && neuron_id < static_cast<int>(successors.size())) ? successors[neuron_id] : none;
+}
+
+const std::vector<int>& Genome::get_predecessors(int neuron_id) const {
+    static const std::vector<int> none;
+    return (neuron_id >= 0 && neuron_id < static_cast<int>(predecessors.size())) ? predecessors[neuron_id] : none;
+}
+
+void Genome::add_node(int neuron_id) {
+    if (neuron_id < 0)
+        throw std::out_of_range("ID de neurone négatif: " + std::to_string(neuron_id));
+
+    if (neuron_id >= static_cast<int>(rank.size())) {
+        rank.resize(neuron_id + 1, -1);
+        successors.resize(neuron_id + 1);
+        predecessors.resize(neuron_id + 1);
+    }
+
+    // Un neurone sans lien peut aller n'importe où : à la fin
+    if (rank[neuron_id] < 0) {
+        rank[neuron_id] = topological_order.size();
+        topological_order.push_back(neuron_id);
+    }
+}
+
+void Genome::add_edge(int input_id, int output_id) {
+    add_node(input_id);
+    add_node(output_id);
+
+    const int lower = rank[output_id];
+    const int upper = rank[input_id];
+    if (lower <= upper) {
+        if (input_id == output_id)
+            throw std::runtime_error("Le lien " + std::to_string(input_id) + " -> " + std::to_string(output_id) + " crée un cycle");
+
+        // Pearce-Kelly : seuls les neurones placés entre output_id et input_id sont parcourus.
+        // Ceux atteints depuis output_id sont replacés après ceux qui mènent à input_id.
+        std::vector<int> forward{output_id};
+        std::unordered_set<int> visited{output_id};
+        for (size_t i = 0; i < forward.size(); ++i) {
+            for (int next : successors[forward[i]]) {
+                if (next == input_id)
+                    throw std::runtime_error("Le lien " + std::to_string(input_id) + " -> " + std::to_string(output_id) + " crée un cycle");
+                if (rank[next] < upper && visited.insert(next).second) {
+                    forward.push_back(next);
+                }
+            }
+        }
+
+        std::vector<int> backward{input_id};
+        visited = {input_id};
+        for (size_t i = 0; i < backward.size(); ++i) {
+            for (int previous : predecessors[backward[i]]) {
+                if (rank[previous] > lower && visited.insert(previous).second) {
+                    backward.push_back(previous);
+                }
+            }
+        }
+
+        auto by_rank = [this](int a, int b) { return rank[a] < rank[b]; };
+        std::sort(forward.begin(), forward.end(), by_rank);
+        std::sort(backward.begin(), backward.end(), by_rank);
+
+        // Les positions libérées, dans l'ordre, reçoivent backward puis forward
+        std::vector<int> positions;
+        positions.reserve(forward.size() + backward.size());
+        for (int id : backward) positions.push_back(rank[id]);
+        for (int id : forward) positions.push_back(rank[id]);
+        std::sort(positions.begin(), positions.end());
+
+        size_t next_position = 0;
+        for (int id : backward) {
+            rank[id] = positions[next_position++];
+            topological_order[rank[id]] = id;
+        }
+        for (int id : forward) {
+            rank[id] = positions[next_position++];
+            topological_order[rank[id]] = id;
+        }
+    }
+
+    successors[input_id].push_back(output_id);
+    predecessors[output_id].push_back(input_id);
+}
+
+void Genome::remove_edge(int input_id, int output_id) {
+    auto &outgoing = successors[input_id];
+    outgoing.erase(std::find(outgoing.begin(), outgoing.end(), output_id));
+    auto &incoming = predecessors[output_id];
+    incoming.erase(std::find(incoming.begin(), incoming.end(), input_id));
+}
+
+void Genome::clear_genes() {
+    neurons.clear();
+    links.clear();
+    topological_order.clear();
+    rank.clear();
+    successors.clear();
+    predecessors.clear();
 }
 
 // Recherche un neurone dans le génome par ID
 std::optional<neat::NeuronGene> Genome::find_neuron(int neuron_id) const {
-    for (const auto &neuron : neurons) {
-        if (neuron.neuron_id == neuron_id) {
-            return neuron;  // Retourne le neurone s'il est trouvé
-        }
+    auto it = std::lower_bound(neurons.begin(), neurons.end(), neuron_id,
+        [](const neat::NeuronGene &neuron, int id) { return neuron.neuron_id < id; });
+    if (it != neurons.end() && it->neuron_id == neuron_id) {
+        return *it;  // Retourne le neurone s'il est trouvé
     }
     return std::nullopt;  // Retourne un optional vide si non trouvé
 }
 
 // Recherche un lien dans le génome par ID de lien
 std::optional<neat::LinkGene> Genome::find_link(neat::LinkId link_id) const {
-    for (const auto &link : links) {
-        if (link.link_id.input_id == link_id.input_id && link.link_id.output_id == link_id.output_id) {
-            return link;  // Retourne le lien s'il est trouvé
-        }
+    const int innovation = InnovationTracker::get_innovation(link_id);
+    auto it = std::lower_bound(links.begin(), links.end(), innovation,
+        [](const neat::LinkGene &link, int value) { return link.innovation_number < value; });
+    if (it != links.end() && it->link_id == link_id) {
+        return *it;  // Retourne le lien s'il est trouvé
     }
     return std::nullopt;  // Retourne un optional vide si non trouvé
 }
@@ -522,13 +722,15 @@ void to_json(json& json, const Genome& genome)
 
 void from_json(const json& json, Genome& genome)
 {
-    genome.neurons.clear();
-    genome.links.clear();
+    genome.clear_genes();
 
     genome.num_inputs = json["num_inputs"];
     genome.num_outputs = json["num_outputs"];
     genome.genome_id = json["genome_id"];
 
-    json["neurons"].get_to(genome.neurons);
-    json["links"].get_to(genome.links);
+    // Les anciennes sauvegardes n'ont ni l'ordre ni les numéros d'innovation : add_* les rétablissent
+    for (const neat::NeuronGene &neuron : json["neurons"].get<std::vector<neat::NeuronGene>>())
+        genome.add_neuron(neuron);
+    for (const neat::LinkGene &link : json["links"].get<std::vector<neat::LinkGene>>())
+        genome.add_link(link);
 }
@@ -35,6 +35,12 @@ public:
 
     static int last_id;
 
+    /**
+     * @brief Vrai si le lien input_id -> output_id fermerait un cycle (lien vers soi-même compris).
+     *
+     * Si input_id précède output_id dans l'ordre topologique, la réponse est immédiate. Sinon seuls les neurones
+     * placés entre les deux dans l'ordre sont parcourus.
+     */
     bool would_create_cycle(int input_id, int output_id) const;
 
     bool operator==(const Genome &other) const;
@@ -57,8 +63,20 @@ public:
 
 
 
+    /**
+     * @brief Distance de compatibilité NEAT : gènes en excès, gènes disjoints et écart moyen des poids des gènes communs.
+     *
+     * Un seul parcours des deux listes de liens, triées par numéro d'innovation.
+     */
     double compute_distance(const Genome &other, const NeatConfig &config) const;
 
+    /**
+     * @brief Distance de compatibilité, arrêtée dès qu'elle atteint limit.
+     *
+     * @return La distance si elle est inférieure à limit, sinon une valeur >= limit.
+     */
+    double compute_distance(const Genome &other, const NeatConfig &config, double limit) const;
+
     /**
      * @brief Obtenir le nombre d’entrées dans le génome.
      *
@@ -85,26 +103,63 @@ public:
     int get_genome_id() const;
 
     /**
-     * @brief Récupère les neurones du génome.
+     * @brief Récupère les neurones du génome, triés par ID.
      *
      * @return std::vector<neat::NeuronGene> Les neurones du génome.
      */
-    std::vector<neat::NeuronGene> get_neurons() const;
+    const std::vector<neat::NeuronGene>& get_neurons() const;
 
     /**
-     * @brief Récupère les liens du génome.
+     * @brief Récupère les liens du génome, triés par numéro d'innovation.
      *
      * @return std::vector<neat::LinkGene> Les liens du génome.
      */
-    std::vector<neat::LinkGene> get_links() const;
+    const std::vector<neat::LinkGene>& get_links() const;
+
+    /**
+     * @brief Modifient un gène sans toucher à son ID, indiqué par sa position dans get_neurons() / get_links().
+     * Les ajouts et retraits passent par add_neuron / add_link / remove_neuron / remove_link, qui maintiennent
+     * le tri et l'ordre topologique.
+     *
+     * @throws std::out_of_range si l'indice ne désigne aucun gène.
+     */
+    void set_bias(size_t neuron_index, double bias);
+    void set_activation(size_t neuron_index, Activation activation);
+    void set_weight(size_t link_index, double weight);
+    void set_enabled(size_t link_index, bool enabled);
 
-    std::vector<neat::NeuronGene>& get_neurons();
-    std::vector<neat::LinkGene>& get_links();
+    /**
+     * @brief Réserve la place des gènes, pour construire un génome sans réallocation.
+     */
+    void reserve(size_t neuron_count, size_t link_count);
+
+    /**
+     * @brief ID des neurones dans un ordre topologique : chaque lien (désactivé compris) va d'un neurone vers un
+     * neurone placé après lui. Maintenu à chaque ajout ou retrait de gène.
+     */
+    const std::vector<int>& get_topological_order() const;
+
+    /**
+     * @brief Neurones atteints par les liens partant de neuron_id / arrivant à neuron_id (désactivés compris).
+     */
+    const std::vector<int>& get_successors(int neuron_id) const;
+    const std::vector<int>& get_predecessors(int neuron_id) const;
+
+    /**
+     * @brief Retire le lien s'il existe.
+     */
+    void remove_link(neat::LinkId link_id);
+
+    /**
+     * @brief Retire le neurone et tous ses liens.
+     */
+    void remove_neuron(int neuron_id);
 
     /**
      * @brief Ajoute un neurone au génome.
      *
-     * Cette fonction ajoute un gène de neurone donné à la liste des neurones du génome.
+     * Cette fonction ajoute un gène de neurone donné à la liste des neurones du génome, à sa place dans l'ordre des ID.
+     * Ajouter les neurones par ID croissant ne coûte qu'un push_back.
      *
      * @param neuron Le gène neurone à ajouter.
      */
@@ -113,7 +168,11 @@ public:
     /**
      * @brief Ajoute un lien donné à la liste des liens dans le génome.
      *
-     * TCette fonction ajoute un gène de lien donné à la liste des liens du génome.
+     * Cette fonction ajoute un gène de lien donné à la liste des liens du génome, à sa place dans l'ordre des numéros
+     * d'innovation. Le numéro d'innovation du lien est recalculé à partir de link_id (voir InnovationTracker).
+     * Ajouter les liens par numéro d'innovation croissant ne coûte qu'un push_back.
+     *
+     * @throws std::runtime_error si le lien fermerait un cycle (voir would_create_cycle).
      *
      * @param link Le gène de lien à ajouter.
      */
@@ -176,6 +235,17 @@ private:
     // Vecteurs de neurones et de liens dans le génome
     std::vector<neat::NeuronGene> neurons;
     std::vector<neat::LinkGene> links;
+
+    // Graphe des liens indexé par ID de neurone, tenu en ordre topologique à chaque ajout de lien (Pearce-Kelly)
+    std::vector<int> topological_order;
+    std::vector<int> rank;                          // Position de chaque ID dans topological_order, -1 si absent
+    std::vector<std::vector<int>> successors;
+    std::vector<std::vector<int>> predecessors;
+
+    void add_node(int neuron_id);
+    void add_edge(int input_id, int output_id);
+    void remove_edge(int input_id, int output_id);
+    void clear_genes();
 };
 
 namespace std {
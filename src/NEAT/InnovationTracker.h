@@ -1,16 +1,33 @@
+#ifndef INNOVATIONTRACKER_H
+#define INNOVATIONTRACKER_H
+
 #include "Neat.h"
-#include <unordered_map>
+#include <stdexcept>
+#include <string>
 
 
 class InnovationTracker {
 public:
-    static int next_innovation_number; 
+    // Plus grand ID de neurone dont les connexions ont un numéro d'innovation représentable par un int
+    static constexpr int MAX_NEURON_ID = 46339;
+
+    /**
+     * @brief Numéro d'innovation de la connexion input_id -> output_id.
+     *
+     * Le numéro ne dépend que des deux neurones (couplage de Szudzik) : deux génomes qui ont la même connexion ont
+     * le même numéro, sans compteur partagé entre les threads de reproduction ni à sauvegarder dans les checkpoints.
+     * Les connexions touchant les neurones les plus récents (ID les plus grands) ont les numéros les plus grands.
+     *
+     * @throw std::out_of_range si un ID est négatif ou dépasse MAX_NEURON_ID.
+     */
+    static int get_innovation(const neat::LinkId &link_id) {
+        const int a = link_id.input_id;
+        const int b = link_id.output_id;
+        if (a < 0 || b < 0 || a > MAX_NEURON_ID || b > MAX_NEURON_ID)
+            throw std::out_of_range("Pas de numéro d'innovation pour le lien " + std::to_string(a) + " -> " + std::to_string(b));
 
-    static int get_new_innovation() {
-        return next_innovation_number++;
+        return a >= b ? a * a + a + b : b * b + a;
     }
 };
 
-
-int InnovationTracker::next_innovation_number = 0;
-
+#endif // INNOVATIONTRACKER_H
@@ -13,7 +13,7 @@ void Mutator::mutate(Genome &genome, const NeatConfig &config, RNG &rng) {
     // Probabilité d'une mutation structurelle
     if (rng.next_double() < config.probability_structure_mutation) {
         // Liste des mutations structurelles possibles et de leurs probabilités relatives
-        std::vector<std::pair<std::function<void(Genome&)>, double>> structure_mutations = {
+        const std::pair<void (*)(Genome&, RNG&), double> structure_mutations[] = {
             {mutate_add_link_fix, config.probability_add_link},
             {mutate_remove_link_fix, config.probability_remove_link},
             {mutate_add_neuron_fix, config.probability_add_neuron},
@@ -33,7 +33,7 @@ void Mutator::mutate(Genome &genome, const NeatConfig &config, RNG &rng) {
         for (const auto& mutation : structure_mutations) {
             cumulative_probability += mutation.second;
             if (mutation_choice < cumulative_probability) {
-                mutation.first(genome); // Appliquer la mutation structurelle
+                mutation.first(genome, rng); // Appliquer la mutation structurelle
                 break;
             }
         }
@@ -50,9 +50,9 @@ void Mutator::mutate(Genome &genome, const NeatConfig &config, RNG &rng) {
 }
 
 
-void Mutator::mutate_add_link(Genome &genome) { 
-    int input_id = choose_random_input_or_hidden_neuron(genome.get_neurons());  
-    int output_id = choose_random_output_or_hidden_neuron(genome.get_neurons());
+void Mutator::mutate_add_link(Genome &genome, RNG &rng) { 
+    int input_id = choose_random_input_or_hidden_neuron(genome.get_neurons(), rng);  
+    int output_id = choose_random_output_or_hidden_neuron(genome.get_neurons(), rng);
 
     if (input_id == -1 || output_id == -1) {
         return;
@@ -68,21 +68,21 @@ void Mutator::mutate_add_link(Genome &genome) {
         return;
     }
 
-    if (would_create_cycle(genome.get_links(), input_id, output_id)) {
+    if (genome.would_create_cycle(input_id, output_id)) {
         return;
     }
 
-    neat::LinkMutator link_mutator;
+    neat::LinkMutator link_mutator(rng);
     neat::LinkGene new_link = link_mutator.new_value(input_id, output_id);
     genome.add_link(new_link);
 
 }
 
-void Mutator::mutate_add_link_fix(Genome &genome) {
+void Mutator::mutate_add_link_fix(Genome &genome, RNG &rng) {
     constexpr int MAX_ATTEMPTS = 10; // Évite de boucler indéfiniment si peu d'options
     for (int attempt = 0; attempt < MAX_ATTEMPTS; ++attempt) {
-        int input_id = choose_random_input_or_hidden_neuron(genome.get_neurons());
-        int output_id = choose_random_output_or_hidden_neuron(genome.get_neurons());
+        int input_id = choose_random_input_or_hidden_neuron(genome.get_neurons(), rng);
+        int output_id = choose_random_output_or_hidden_neuron(genome.get_neurons(), rng);
 
         if (input_id == -1 || output_id == -1 || input_id == output_id) {
             continue; // Recommence avec un autre choix
@@ -100,12 +100,12 @@ void Mutator::mutate_add_link_fix(Genome &genome) {
         }
 
         // Vérifie si cela crée un cycle **seulement si la connexion est nouvelle**
-        if (would_create_cycle(genome.get_links(), input_id, output_id)) {
+        if (genome.would_create_cycle(input_id, output_id)) {
             continue; // Essaie un autre lien
         }
 
         // Création d'une nouvelle connexion
-        neat::LinkMutator link_mutator;
+        neat::LinkMutator link_mutator(rng);
         neat::LinkGene new_link = link_mutator.new_value(input_id, output_id);
         genome.add_link(new_link);
 
@@ -114,8 +114,7 @@ void Mutator::mutate_add_link_fix(Genome &genome) {
 }
 
 
-void Mutator::mutate_remove_link(Genome &genome) {
-    RNG rng;
+void Mutator::mutate_remove_link(Genome &genome, RNG &rng) {
     NeatConfig config;
 
     if (genome.get_links().empty()) {
@@ -163,11 +162,10 @@ void Mutator::mutate_remove_link(Genome &genome) {
     }
 
     auto to_remove = rng.choose_random(removable_links);
-    genome.get_links().erase(std::remove(genome.get_links().begin(), genome.get_links().end(), to_remove), genome.get_links().end());
+    genome.remove_link(to_remove.link_id);
 }
 
-void Mutator::mutate_remove_link_fix(Genome &genome) {
-    RNG rng;
+void Mutator::mutate_remove_link_fix(Genome &genome, RNG &rng) {
     NeatConfig config;
 
     if (genome.get_links().empty()) {
@@ -216,14 +214,7 @@ void Mutator::mutate_remove_link_fix(Genome &genome) {
     auto to_remove = rng.choose_random(removable_links);
 
     // Supprimer le lien choisi
-    genome.get_links().erase(
-        std::remove_if(
-            genome.get_links().begin(),
-            genome.get_links().end(),
-            [&to_remove](const neat::LinkGene& link) {
-                return link.link_id == to_remove.link_id;
-            }),
-        genome.get_links().end());
+    genome.remove_link(to_remove.link_id);
 
     
 
@@ -232,8 +223,7 @@ void Mutator::mutate_remove_link_fix(Genome &genome) {
 }
 
 
-void Mutator::mutate_add_neuron(Genome &genome) {
-    RNG rng;
+void Mutator::mutate_add_neuron(Genome &genome, RNG &rng) {
 
     if (genome.get_links().empty()) {
         return;
@@ -242,12 +232,9 @@ void Mutator::mutate_add_neuron(Genome &genome) {
     neat::LinkGene link_to_split = rng.choose_random(genome.get_links());
     link_to_split.is_enabled = false;
 
-    genome.get_links().erase(std::remove_if(genome.get_links().begin(), genome.get_links().end(),
-        [&link_to_split](const neat::LinkGene &link) {
-            return link.link_id == link_to_split.link_id;
-        }), genome.get_links().end());
+    genome.remove_link(link_to_split.link_id);
 
-    neat::NeuronMutator neuron_mutator;
+    neat::NeuronMutator neuron_mutator(rng);
     neat::NeuronGene new_neuron = neuron_mutator.new_neuron();
     new_neuron.neuron_id = genome.generate_next_neuron_id();
     genome.add_neuron(new_neuron);
@@ -260,8 +247,7 @@ void Mutator::mutate_add_neuron(Genome &genome) {
 
 }
 
-void Mutator::mutate_add_neuron_fix(Genome &genome) {
-    RNG rng;
+void Mutator::mutate_add_neuron_fix(Genome &genome, RNG &rng) {
 
     if (genome.get_links().empty()) {
         return;
@@ -277,7 +263,7 @@ void Mutator::mutate_add_neuron_fix(Genome &genome) {
     link_to_split.is_enabled = false;
 
     // Création d'un nouveau neurone unique
-    neat::NeuronMutator neuron_mutator;
+    neat::NeuronMutator neuron_mutator(rng);
     neat::NeuronGene new_neuron = neuron_mutator.new_neuron();
     new_neuron.neuron_id = genome.generate_next_neuron_id();
     genome.add_neuron(new_neuron);
@@ -292,7 +278,7 @@ void Mutator::mutate_add_neuron_fix(Genome &genome) {
 
 
 
-void Mutator::mutate_remove_neuron(Genome &genome) {
+void Mutator::mutate_remove_neuron(Genome &genome, RNG &rng) {
     int hidden_neuron_count = std::count_if(genome.get_neurons().begin(), genome.get_neurons().end(), 
         [](const neat::NeuronGene &neuron) { 
             NeatConfig config;
@@ -303,17 +289,10 @@ void Mutator::mutate_remove_neuron(Genome &genome) {
         return;
     }
 
-    RNG rng;
-    auto neuron_it = choose_random_hidden(genome.get_neurons());
+    auto neuron_it = choose_random_hidden(genome.get_neurons(), rng);
 
-    genome.get_links().erase(std::remove_if(genome.get_links().begin(), genome.get_links().end(), 
-        [neuron_it](const neat::LinkGene &link) {
-            return link.has_neuron(*neuron_it);
-        }),
-        genome.get_links().end());
-
-
-    genome.get_neurons().erase(neuron_it);
+    // Retire le neurone et ses liens
+    genome.remove_neuron(neuron_it->neuron_id);
 }
 
 void Mutator::mutate_link_weight(Genome &genome, const NeatConfig &config, RNG &rng) {
@@ -324,15 +303,15 @@ void Mutator::mutate_link_weight(Genome &genome, const NeatConfig &config, RNG &
 
     // Choisir un lien aléatoire
     int link_index = rng.next_int(0, genome.get_links().size() - 1);
-    auto &link = genome.get_links()[link_index];
+    const double weight = genome.get_links()[link_index].weight;
 
     // Appliquer la mutation si la probabilité le permet
     if (rng.next_double() < config.probability_mutate_link_weight) {
-        link.weight = mutate_delta(link.weight);  // Muter le poids du lien
+        genome.set_weight(link_index, mutate_delta(weight, rng));  // Muter le poids du lien
     }
 }
 
-void Mutator::mutate_remove_neuron_fix(Genome &genome) {
+void Mutator::mutate_remove_neuron_fix(Genome &genome, RNG &rng) {
     // Compte les neurones cachés
     int hidden_neuron_count = std::count_if(genome.get_neurons().begin(), genome.get_neurons().end(), 
         [](const neat::NeuronGene &neuron) { 
@@ -346,8 +325,8 @@ void Mutator::mutate_remove_neuron_fix(Genome &genome) {
     }
 
     // Sélectionne un neurone caché aléatoire
-    std::vector<neat::NeuronGene>& neurons = genome.get_neurons();
-    auto hidden_neurons = std::vector<std::vector<neat::NeuronGene>::iterator>();
+    const std::vector<neat::NeuronGene>& neurons = genome.get_neurons();
+    auto hidden_neurons = std::vector<std::vector<neat::NeuronGene>::const_iterator>();
 
     NeatConfig config;
     for (auto it = neurons.begin(); it != neurons.end(); ++it) {
@@ -361,20 +340,10 @@ void Mutator::mutate_remove_neuron_fix(Genome &genome) {
         return; // Sécurité supplémentaire
     }
 
-    RNG rng;
-    auto neuron_it = hidden_neurons[rng.uniform(0, hidden_neurons.size() - 1)];
-
-    // Supprime les liens associés au neurone
-    auto& links = genome.get_links();
-    links.erase(std::remove_if(links.begin(), links.end(), 
-        [neuron_it](const neat::LinkGene &link) {
-            return link.has_neuron(*neuron_it);
-        }),
-        links.end());
-
+    auto neuron_it = hidden_neurons[rng.next_int(0, hidden_neurons.size() - 1)];
 
-    // Supprime le neurone sélectionné
-    neurons.erase(neuron_it);
+    // Supprime le neurone sélectionné et les liens associés
+    genome.remove_neuron(neuron_it->neuron_id);
 }
 
 
@@ -386,11 +355,11 @@ void Mutator::mutate_neuron_bias(Genome &genome, const NeatConfig &config, RNG &
 
     // Choisir un neurone aléatoire
     int neuron_index = rng.next_int(0, genome.get_neurons().size() - 1);
-    auto &neuron = genome.get_neurons()[neuron_index];
+    const double bias = genome.get_neurons()[neuron_index].bias;
 
     // Appliquer la mutation si la probabilité le permet
     if (rng.next_double() < config.probability_mutate_neuron_bias) {
-        neuron.bias = mutate_delta(neuron.bias);  // Muter le biais du neurone
+        genome.set_bias(neuron_index, mutate_delta(bias, rng));  // Muter le biais du neurone
     }
 }
 
@@ -434,7 +403,7 @@ void Mutator::validate_connectivity(const Genome &genome) {
 
 
 
- int choose_random_input_or_hidden_neuron(const std::vector<neat::NeuronGene>& neurons) {
+ int choose_random_input_or_hidden_neuron(const std::vector<neat::NeuronGene>& neurons, RNG &rng) {
     std::vector<int> valid_neurons;
     NeatConfig config;
 
@@ -449,11 +418,11 @@ void Mutator::validate_connectivity(const Genome &genome) {
         return -1;
     }
 
-    int random_index = std::rand() % valid_neurons.size();
+    int random_index = rng.next_int(0, valid_neurons.size() - 1);
     return valid_neurons[random_index];
 }
 
-int choose_random_output_or_hidden_neuron(const std::vector<neat::NeuronGene>& neurons) {
+int choose_random_output_or_hidden_neuron(const std::vector<neat::NeuronGene>& neurons, RNG &rng) {
     std::vector<int> valid_neurons;
     NeatConfig config;
 
@@ -466,11 +435,11 @@ int choose_random_output_or_hidden_neuron(const std::vector<neat::NeuronGene>& n
     if (valid_neurons.empty()) {
         return -1;
     }
-    int random_index = std::rand() % valid_neurons.size();
+    int random_index = rng.next_int(0, valid_neurons.size() - 1);
     return valid_neurons[random_index];
 }
 
-std::vector<neat::NeuronGene>::const_iterator choose_random_hidden(std::vector<neat::NeuronGene>& neurons) {
+std::vector<neat::NeuronGene>::const_iterator choose_random_hidden(const std::vector<neat::NeuronGene>& neurons, RNG &rng) {
     std::vector<std::vector<neat::NeuronGene>::const_iterator> hidden_neurons;
     NeatConfig config;
 
@@ -484,45 +453,17 @@ std::vector<neat::NeuronGene>::const_iterator choose_random_hidden(std::vector<n
         throw std::out_of_range("No hidden neurons available.");
     }
 
-    RNG rng;
     return rng.choose_random(hidden_neurons);
 }
 
 
 
-bool would_create_cycle(const std::vector<neat::LinkGene>& links, int input_id, int output_id) {
-    std::unordered_set<int> visited;
-
-    std::function<bool(int)> dfs = [&](int current_id) {
-        if (visited.find(current_id) != visited.end()) {
-            return true;
-        }
-        visited.insert(current_id);
-
-        for (const auto& link : links) {
-            if (link.link_id.input_id == current_id) {
-                if (link.link_id.output_id == input_id) {
-                    return true;
-                }
-                if (dfs(link.link_id.output_id)) {
-                    return true;
-                }
-            }
-        }
-        return false;
-    };
-
-    return dfs(output_id);
-}
-
-double new_value(){
-    RNG rng;
+double new_value(RNG &rng){
     neat::DoubleConfig config;
     return neat::clamp(rng.next_gaussian(config.init_mean, config.init_stdev));
 }
 
-double mutate_delta(double value){
-    RNG rng;
+double mutate_delta(double value, RNG &rng){
     neat::DoubleConfig config;
     double delta = neat::clamp( rng.next_gaussian(0, config.mutate_power));
     return neat::clamp (value + delta);
@@ -70,9 +70,9 @@ public:
      * - Si le lien n’existe pas, il vérifie si l’ajout du lien créerait un cycle.
      * - Si l’ajout du lien ne crée pas de cycle, il crée et ajoute le nouveau lien au génome.
      */
-    static void mutate_add_link(Genome &genome);
+    static void mutate_add_link(Genome &genome, RNG &rng);
 
-    static void mutate_add_link_fix(Genome &genome);
+    static void mutate_add_link_fix(Genome &genome, RNG &rng);
 
     /**
      * @brief Modifie le génome donné en supprimant un lien non essentiel.
@@ -84,9 +84,9 @@ public:
      *
      * @param genome Le génome à muter.
      */
-    static void mutate_remove_link(Genome &genome);
+    static void mutate_remove_link(Genome &genome, RNG &rng);
 
-    static void mutate_remove_link_fix(Genome &genome);
+    static void mutate_remove_link_fix(Genome &genome, RNG &rng);
 
     /**
      * @brief Modifie le génome donné en ajoutant un nouveau neurone.
@@ -103,9 +103,9 @@ public:
      *
      * @param genome Le génome à muter en ajoutant un nouveau neurone.
      */
-    static void mutate_add_neuron(Genome &genome);
+    static void mutate_add_neuron(Genome &genome, RNG &rng);
 
-    static void mutate_add_neuron_fix(Genome &genome);
+    static void mutate_add_neuron_fix(Genome &genome, RNG &rng);
 
     /**
      * @brief Modifie le génome donné en supprimant un neurone caché.
@@ -116,9 +116,9 @@ public:
      *
      * @param genome Le génome à muter.
      */
-    static void mutate_remove_neuron(Genome &genome);
+    static void mutate_remove_neuron(Genome &genome, RNG &rng);
 
-    static void mutate_remove_neuron_fix(Genome &genome);
+    static void mutate_remove_neuron_fix(Genome &genome, RNG &rng);
 
     static void validate_connectivity(const Genome &genome);
 };
@@ -136,7 +136,7 @@ public:
  * @return L’identifiant d’un neurone caché ou d’une entrée choisie au hasard. Si aucun neurone valide n’est trouvé,
  *   renvoie -1.
  */
- int choose_random_input_or_hidden_neuron(const std::vector<neat::NeuronGene> &neurons);
+ int choose_random_input_or_hidden_neuron(const std::vector<neat::NeuronGene> &neurons, RNG &rng);
 
 /**
  * @brief Sélectionne une sortie aléatoire ou un neurone caché dans une liste de neurones.
@@ -148,7 +148,7 @@ public:
  * @param neurons Un vecteur d’objets NeuronGene représentant les neurones à choisir.
  * @return L’identifiant d’un neurone valide choisi au hasard, ou -1 si aucun neurone valide n’est trouvé.
  */
- int choose_random_output_or_hidden_neuron(const std::vector<neat::NeuronGene> &neurons);
+ int choose_random_output_or_hidden_neuron(const std::vector<neat::NeuronGene> &neurons, RNG &rng);
 
 // Méthodes pour choisir des neurones cachés aléatoires
 
@@ -164,23 +164,8 @@ public:
  * @return Un itérateur à un neurone caché choisi au hasard.
  * @throws std::out_of_range Si aucun neurone caché n’est disponible dans la liste.
  */
-std::vector<neat::NeuronGene>::const_iterator choose_random_hidden(std::vector<neat::NeuronGene> &neurons);
+std::vector<neat::NeuronGene>::const_iterator choose_random_hidden(const std::vector<neat::NeuronGene> &neurons, RNG &rng);
 
-// Méthode pour vérifier si un cycle serait créé par l'ajout d'un lien
-
-/**
- * @brief Vérifie si l’ajout d’un lien entre deux neurones créerait un cycle dans le réseau.
- *
- * Cette fonction utilise un algorithme de recherche en profondeur pour déterminer si un cycle serait créé.
- * en ajoutant un lien entre le neurone avec l’identifiant `input_id` et le neurone avec l'«output_id`. Il traverse la
- * réseau à partir du neurone `output_id`et vérifie s’il peut atteindre le neurone `input_id`.
- *
- * @param links Un vecteur de `neat::LinkGene` représentant les liens existants dans le réseau.
- * @param input_id L’ID du neurone d’entrée du lien à ajouter.
- * @param output_id L’ID du neurone de sortie du lien à ajouter.
- * @return true si l’ajout du lien créerait un cycle, false sinon.
- */
-bool would_create_cycle(const std::vector<neat::LinkGene> &links, int input_id, int output_id);
 
 /**
  * @brief Génère une nouvelle valeur basée sur une distribution gaussienne.
@@ -191,7 +176,7 @@ bool would_create_cycle(const std::vector<neat::LinkGene> &links, int input_id,
  *
  * @return Un double représentant la nouvelle valeur clampée générée à partir de la distribution gaussienne.
  */
-double new_value();
+double new_value(RNG &rng);
 
 /**
  * @brief Fait muter une valeur donnée en ajoutant un delta généré à partir d'une distribution gaussienne.
@@ -203,6 +188,6 @@ double new_value();
  * @param value La valeur initiale à faire muter.
  * @return La valeur mutée après ajout du delta limité.
  */
-double mutate_delta(double value);
+double mutate_delta(double value, RNG &rng);
 
 #endif // MUTATOR_H
@@ -9,6 +9,7 @@
 #include "Activation.h"
 #include "GenomeIndexer.h"
 #include "NeatConfig.h"
+#include "rng.h"
 #include <memory>
 #include "../external/json.hpp"
 
@@ -123,25 +124,27 @@ namespace neat
          *
          * @param a Le premier parent NeuronGene.
          * @param b Le deuxième parent NeuronGene.
+         * @param rng Flux du croisement.
          * @return Un nouveau NeuronGene résultant du croisement des NeuronGènes d’entrée.
          * @throws std::assert si le neuron_id de l’entrée NeuronGènes n’est pas le même.
          */
-        NeuronGene crossover_neuron(const NeuronGene &a, const NeuronGene &b);
+        NeuronGene crossover_neuron(const NeuronGene &a, const NeuronGene &b, RNG &rng);
 
         /**
          * @brief Effectue un croisement entre deux objets LinkGene.
          *
          * Cette fonction prend deux objets LinkGene, ‘a’, et ‘b’, et effectue une opération de croisement.
          * pour produire un nouveau LinkGene. Le croisement se fait en choisissant au hasard le poids et
-         * statut activé à partir de l’un ou de l’autre.
+         * statut activé à partir de l’un ou de l’autre. Le numéro d'innovation est celui des deux parents.
          *
          * @param a Le premier parent LinkGene.
          * @param b Le deuxième parent LinkGene.
+         * @param rng Flux du croisement.
          * @return Un nouveau LinkGene résultant de la jonction des deux.
          *
          * @pre L’identifiant d’entrée et l’identifiant de sortie de « a » et de « b » doivent être les mêmes.
          */
-        LinkGene crossover_link(const LinkGene &a, const LinkGene &b);
+        LinkGene crossover_link(const LinkGene &a, const LinkGene &b, RNG &rng);
 
         /**
          * @brief Effectue un croisement entre deux individus pour produire un génome de progéniture.
@@ -153,15 +156,22 @@ namespace neat
          * @param dominant Le parent dominant dont le génome contribuera principalement à la descendance.
          * @param recessive Le parent récessif dont le génome contribuera de façon secondaire à la descendance.
          * @param child_genome_id L’identifiant unique du génome de la progéniture.
+         * @param rng Flux du croisement, propre à l'enfant pour que le résultat ne dépende pas de l'ordre de production.
          * @return Genome Le génome de la descendance après un croisement.
          */
-        Genome crossover(const Individual &dominant, const Individual &recessive, int child_genome_id);
+        Genome crossover(const Individual &dominant, const Individual &recessive, int child_genome_id, RNG &rng);
 
         Genome alt_crossover(const std::shared_ptr<Genome>& dominant, 
                        const std::shared_ptr<Genome>& recessive, 
-                       int child_genome_id);
+                       int child_genome_id, RNG &rng);
 
     private:
+        /**
+         * @brief Croisement par un seul parcours des gènes des deux parents, triés par ID de neurone et par
+         * numéro d'innovation (voir Genome::add_link) : linéaire en nombre de gènes.
+         */
+        Genome merge(const Genome &dominant, const Genome &recessive, int child_genome_id, RNG &rng);
+
         GenomeIndexer m_genome_indexer;
     };
 
@@ -1,6 +1,8 @@
 #ifndef NEATCONFIG_H
 #define NEATCONFIG_H
 
+#include <cstdint>
+
 struct NeatConfig {
     int population_size = 200;        // Taille de la population
     int num_inputs = 19;               // Nombre d'entrées
@@ -30,6 +32,8 @@ struct NeatConfig {
 
     double interspecies_mating = 0.00;  // Probabilité de croisement inter-espèces
 
+    uint64_t seed = 0;  // Graine des flux aléatoires de la population, 0 pour la graine du run (RNG::run_seed)
+
 };
 
 #endif // NEATCONFIG_H
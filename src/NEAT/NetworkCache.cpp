@@ -0,0 +1,138 @@
+#include "NetworkCache.h"
+#include <cstring>
+#include <iterator>
+
+NetworkCache::NetworkCache(std::size_t capacity) : m_capacity(capacity) {}
+
+NetworkCache::Key NetworkCache::make_key(const Genome &genome)
+{
+    const std::vector<neat::NeuronGene> &neurons = genome.get_neurons();
+    const std::vector<neat::LinkGene> &links = genome.get_links();
+
+    Key key;
+    key.structure.reserve(3 + 2 * neurons.size() + 3 * links.size());
+    key.values.reserve(neurons.size() + links.size());
+
+    key.structure.push_back(genome.get_num_inputs());
+    key.structure.push_back(genome.get_num_outputs());
+    key.structure.push_back(static_cast<int>(neurons.size()));
+
+    auto to_bits = [](double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    };
+
+    // Les gènes sont triés : deux génomes de même contenu ont la même clé
+    for (const neat::NeuronGene &neuron : neurons)
+    {
+        key.structure.push_back(neuron.neuron_id);
+        key.structure.push_back(static_cast<int>(neuron.activation.get_type()));
+        key.values.push_back(to_bits(neuron.bias));
+    }
+
+    for (const neat::LinkGene &link : links)
+    {
+        key.structure.push_back(link.link_id.input_id);
+        key.structure.push_back(link.link_id.output_id);
+        key.structure.push_back(link.is_enabled);
+        key.values.push_back(to_bits(link.weight));
+    }
+
+    std::size_t seed = key.structure.size();
+    for (int value : key.structure)
+        seed ^= static_cast<std::size_t>(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    key.hash = seed;
+
+    return key;
+}
+
+FeedForwardNeuralNetwork NetworkCache::get(const Genome &genome)
+{
+    Key key = make_key(genome);
+    std::shared_ptr<const Topology> topology;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto range = m_index.equal_range(key.hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            // Les entrées de même structure partagent leur plan : une seule comparaison complète suffit
+            const Entry &entry = *it->second;
+            if (!(topology && entry.topology == topology) && entry.key.structure != key.structure)
+                continue;
+
+            if (entry.key.values == key.values)
+            {
+                m_entries.splice(m_entries.begin(), m_entries, it->second);
+                ++m_exact_hits;
+                return FeedForwardNeuralNetwork(entry.topology, entry.parameters);
+            }
+
+            topology = entry.topology;
+        }
+    }
+
+    if (topology)
+    {
+        ++m_topology_hits;
+        std::shared_ptr<const Parameters> parameters = FeedForwardNeuralNetwork::read_parameters(*topology, genome);
+        FeedForwardNeuralNetwork network(topology, parameters);
+        insert(std::move(key), std::move(topology), std::move(parameters));
+        return network;
+    }
+
+    ++m_misses;
+    FeedForwardNeuralNetwork network = FeedForwardNeuralNetwork::create_from_genome(genome);
+    insert(std::move(key), network.m_topology, network.m_parameters);
+    return network;
+}
+
+void NetworkCache::insert(Key key, std::shared_ptr<const Topology> topology, std::shared_ptr<const Parameters> parameters)
+{
+    if (m_capacity == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::size_t hash = key.hash;
+    m_entries.push_front(Entry{std::move(key), std::move(topology), std::move(parameters)});
+    m_index.emplace(hash, m_entries.begin());
+
+    while (m_entries.size() > m_capacity)
+    {
+        const auto oldest = std::prev(m_entries.end());
+        auto range = m_index.equal_range(oldest->key.hash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            if (it->second == oldest)
+            {
+                m_index.erase(it);
+                break;
+            }
+        }
+        m_entries.pop_back();
+    }
+}
+
+void NetworkCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_index.clear();
+    m_exact_hits = 0;
+    m_topology_hits = 0;
+    m_misses = 0;
+}
+
+std::size_t NetworkCache::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+NetworkCache &NetworkCache::shared()
+{
+    static NetworkCache cache;
+    return cache;
+}
@@ -0,0 +1,93 @@
+#ifndef NETWORK_CACHE_H
+#define NETWORK_CACHE_H
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include "Genome.h"
+#include "NeuralNetwork.h"
+
+/**
+ * @brief Cache borné (LRU) des plans compilés par FeedForwardNeuralNetwork::create_from_genome.
+ *
+ * D'une génération à l'autre, la plupart des descendants n'ont que des poids ou des biais différents d'un
+ * génome déjà compilé ; les copies exactes (mutation sans effet, reprise d'un checkpoint) sont plus rares.
+ * Les génomes sont identifiés par le contenu de leur topologie (neurones, activations, liens), puis de
+ * leurs biais et poids :
+ * - même génome : le réseau partage le plan et les paramètres déjà compilés, en lecture seule ;
+ * - même topologie : le réseau partage le plan, seuls les paramètres sont relus dans le génome ;
+ * - sinon le génome est compilé normalement.
+ *
+ * Thread-safe : la compilation se fait hors du verrou.
+ */
+class NetworkCache
+{
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 512;
+
+    /**
+     * @param capacity Nombre maximal de génomes retenus.
+     */
+    explicit NetworkCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Réseau équivalent à FeedForwardNeuralNetwork::create_from_genome(genome).
+     *
+     * @throws std::runtime_error Si le génome contient un cycle.
+     */
+    FeedForwardNeuralNetwork get(const Genome &genome);
+
+    void clear();
+
+    std::size_t size() const;
+    std::size_t capacity() const { return m_capacity; }
+
+    std::size_t exact_hits() const { return m_exact_hits; }
+    std::size_t topology_hits() const { return m_topology_hits; }
+    std::size_t misses() const { return m_misses; }
+
+    /**
+     * @brief Cache partagé par les fourmis.
+     */
+    static NetworkCache &shared();
+
+private:
+    using Topology = FeedForwardNeuralNetwork::Topology;
+    using Parameters = FeedForwardNeuralNetwork::Parameters;
+
+    struct Key
+    {
+        std::vector<int> structure;     // Dimensions, (id, activation) des neurones, (entrée, sortie, activé) des liens
+        std::vector<uint64_t> values;   // Bits des biais puis des poids, dans l'ordre des gènes
+        std::size_t hash = 0;           // Hash de structure
+    };
+
+    struct Entry
+    {
+        Key key;
+        std::shared_ptr<const Topology> topology;
+        std::shared_ptr<const Parameters> parameters;
+    };
+
+    static Key make_key(const Genome &genome);
+
+    // Ajoute l'entrée comme la plus récente et retire les plus anciennes au-delà de la capacité
+    void insert(Key key, std::shared_ptr<const Topology> topology, std::shared_ptr<const Parameters> parameters);
+
+    std::size_t m_capacity;
+
+    mutable std::mutex m_mutex;
+    std::list<Entry> m_entries; // De la plus récente à la plus ancienne
+    std::unordered_multimap<std::size_t, std::list<Entry>::iterator> m_index;
+
+    std::atomic<std::size_t> m_exact_hits{0};
+    std::atomic<std::size_t> m_topology_hits{0};
+    std::atomic<std::size_t> m_misses{0};
+};
+
+#endif // NETWORK_CACHE_H
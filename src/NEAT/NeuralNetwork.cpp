@@ -1,130 +1,257 @@
 #include "NeuralNetwork.h"
-#include <unordered_set>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
 #include <iostream>
 
 /**
- * @brief Active le réseau de neurones avec un ensemble d'entrées.
+ * @brief Compile les neurones en un plan d'évaluation dense.
  */
-std::vector<double> FeedForwardNeuralNetwork::activate(const std::vector<double> &inputs)
+FeedForwardNeuralNetwork::FeedForwardNeuralNetwork(std::vector<int> input_ids, std::vector<int> output_ids, std::vector<Neuron> neurons)
 {
-    // Assurer que le nombre d'entrées correspond
-    assert(inputs.size() == m_input_ids.size());
+    auto topology = std::make_shared<Topology>();
+    auto parameters = std::make_shared<Parameters>();
+    Topology &plan = *topology;
+    plan.input_ids = std::move(input_ids);
+    plan.output_ids = std::move(output_ids);
 
-    // Map pour stocker les valeurs des neurones
-    std::unordered_map<int, double> values;
+    const int num_inputs = plan.input_ids.size();
 
-    // Initialisation des valeurs d'entrée
-    for (size_t i = 0; i < inputs.size(); i++)
+    // Les ID sont petits et positifs : les références sont rangées dans un tableau indexé par ID
+    int max_id = -1;
+    for (int id : plan.input_ids)
+        max_id = std::max(max_id, id);
+    for (int id : plan.output_ids)
+        max_id = std::max(max_id, id);
+    for (const Neuron &neuron : neurons)
     {
-        int input_id = m_input_ids[i];
-        values[input_id] = inputs[i];
+        max_id = std::max(max_id, neuron.neuron_id);
+        for (const NeuronInput &input : neuron.inputs)
+            max_id = std::max(max_id, input.input_id);
     }
 
-    // Initialiser les neurones cachés et leurs valeurs dans la map values
-    for (const auto& neuron : m_neurons)
+    // Référence d'un id : -(i + 1) pour l'entrée i, k pour le neurone calculé k
+    constexpr int UNKNOWN = std::numeric_limits<int>::min();
+    std::vector<int> refs(max_id + 1, UNKNOWN);
+    auto ref_of = [&](int id)
+    { return id < 0 ? UNKNOWN : refs[id]; };
+
+    for (int i = 0; i < num_inputs; i++)
     {
-        if (values.find(neuron.neuron_id) == values.end()) {
-            // Initialiser la valeur du neurone avec son biais si elle n'est pas présente
-            values[neuron.neuron_id] = neuron.bias;
+        if (plan.input_ids[i] < 0)
+            throw std::runtime_error("FeedForwardNeuralNetwork: negative neuron id.");
+        refs[plan.input_ids[i]] = -(i + 1);
+    }
+
+    std::vector<const Neuron *> computed;
+    computed.reserve(neurons.size());
+    for (const Neuron &neuron : neurons)
+    {
+        if (neuron.neuron_id < 0)
+            throw std::runtime_error("FeedForwardNeuralNetwork: negative neuron id.");
+        if (refs[neuron.neuron_id] == UNKNOWN)
+        {
+            refs[neuron.neuron_id] = computed.size();
+            computed.push_back(&neuron);
         }
     }
+    const int num_computed = computed.size();
 
-    // Initialiser les valeurs des neurones de sortie à 0 (ou une autre valeur de départ si nécessaire)
-    for (int output_id : m_output_ids)
+    // Sources au format CSR et profondeur en un seul passage dans l'ordre donné : les sources d'un neurone
+    // sont déjà calculées. Sa profondeur est 1 + la profondeur maximale de ses sources (0 pour les entrées).
+    std::vector<int> source_offsets(num_computed + 1, 0);
+    std::vector<int> sources;
+    std::vector<int> depth(num_computed, 1);
+    for (int k = 0; k < num_computed; k++)
     {
-        values[output_id] = 0.0;
+        for (const NeuronInput &input : computed[k]->inputs)
+        {
+            const int ref = ref_of(input.input_id);
+            if (ref == UNKNOWN)
+            {
+                std::cerr << "Error: input_id " << input.input_id << " of neuron " << computed[k]->neuron_id << " not found." << std::endl;
+                throw std::runtime_error("Invalid input_id during network compilation.");
+            }
+            if (ref >= k)
+                throw std::runtime_error("FeedForwardNeuralNetwork: neurons are not in topological order (cycle?).");
+
+            sources.push_back(ref);
+            if (ref >= 0)
+                depth[k] = std::max(depth[k], depth[ref] + 1);
+        }
+        source_offsets[k + 1] = sources.size();
     }
 
-    // Calculer les valeurs des neurones
-    for (const auto &neuron : m_neurons)
+    // L'ordre donné reste valide, il n'est réordonné que pour grouper les neurones de même profondeur
+    // et de même activation en une seule passe d'activation
+    std::vector<int> order(num_computed);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b)
+                     {
+                         if (depth[a] != depth[b])
+                             return depth[a] < depth[b];
+                         return computed[a]->activation.get_type() < computed[b]->activation.get_type(); });
+
+    std::vector<int> slots(num_computed);
+    for (int position = 0; position < num_computed; position++)
+        slots[order[position]] = num_inputs + position;
+
+    auto to_slot = [&](int ref)
+    { return ref < 0 ? -(ref + 1) : slots[ref]; };
+
+    parameters->bias.reserve(num_computed);
+    plan.bias_genes.reserve(num_computed);
+    plan.input_offsets.reserve(num_computed + 1);
+    plan.input_offsets.push_back(0);
+    for (int position = 0; position < num_computed; position++)
     {
-        double value = neuron.bias;
+        const int k = order[position];
+        const Neuron &neuron = *computed[k];
 
-        for (const NeuronInput &input : neuron.inputs) {
-            if (values.find(input.input_id) == values.end()) {
-                std::cerr << "Error: input_id " << input.input_id << " not found in values map." << std::endl;
-                throw std::runtime_error("Invalid input_id during activation.");
-            }
-            value += values[input.input_id] * input.weight;
+        parameters->bias.push_back(neuron.bias);
+        plan.bias_genes.push_back(neuron.neuron_gene);
+        for (size_t i = 0; i < neuron.inputs.size(); i++)
+        {
+            plan.sources.push_back(to_slot(sources[source_offsets[k] + i]));
+            plan.weight_genes.push_back(neuron.inputs[i].link_gene);
+            parameters->weights.push_back(neuron.inputs[i].weight);
         }
+        plan.input_offsets.push_back(plan.sources.size());
 
-        value = std::visit([&value](auto &&fn)
-                           { return fn(value); }, neuron.activation);
-        values[neuron.neuron_id] = value;
+        const Activation::Type type = neuron.activation.get_type();
+        if (plan.runs.empty() || plan.runs.back().type != type || depth[order[plan.runs.back().begin]] != depth[k])
+            plan.runs.push_back(ActivationRun{type, position, position + 1});
+        else
+            plan.runs.back().end = position + 1;
     }
 
-    // Collecter les sorties du réseau
-    std::vector<double> outputs;
-    for (int output_id : m_output_ids)
+    plan.output_slots.reserve(plan.output_ids.size());
+    for (int output_id : plan.output_ids)
     {
-        assert(values.find(output_id) != values.end());
-        outputs.push_back(values[output_id]);
+        const int ref = ref_of(output_id);
+        if (ref == UNKNOWN)
+        {
+            std::cerr << "Error: output_id " << output_id << " not found." << std::endl;
+            throw std::runtime_error("Invalid output_id during network compilation.");
+        }
+        plan.output_slots.push_back(to_slot(ref));
     }
-    return outputs;
+
+    m_topology = std::move(topology);
+    m_parameters = std::move(parameters);
+    m_values.assign(num_inputs + num_computed, 0.0);
 }
 
+FeedForwardNeuralNetwork::FeedForwardNeuralNetwork(std::shared_ptr<const Topology> topology, std::shared_ptr<const Parameters> parameters)
+    : m_topology(std::move(topology)), m_parameters(std::move(parameters))
+{
+    m_values.assign(m_topology->input_ids.size() + m_parameters->bias.size(), 0.0);
+}
+
+std::shared_ptr<const FeedForwardNeuralNetwork::Parameters> FeedForwardNeuralNetwork::read_parameters(const Topology &topology, const Genome &genome)
+{
+    const std::vector<neat::NeuronGene> &neuron_genes = genome.get_neurons();
+    const std::vector<neat::LinkGene> &links = genome.get_links();
+
+    auto parameters = std::make_shared<Parameters>();
+    parameters->bias.reserve(topology.bias_genes.size());
+    for (int gene : topology.bias_genes)
+        parameters->bias.push_back(neuron_genes.at(gene).bias);
+
+    parameters->weights.reserve(topology.weight_genes.size());
+    for (int gene : topology.weight_genes)
+        parameters->weights.push_back(links.at(gene).weight);
+
+    return parameters;
+}
+
+/**
+ * @brief Active le réseau de neurones avec un ensemble d'entrées.
+ */
+void FeedForwardNeuralNetwork::activate(const double *inputs, double *outputs)
+{
+    const Topology &plan = *m_topology;
+    double *values = m_values.data();
+    std::copy(inputs, inputs + plan.input_ids.size(), values);
+
+    // Les neurones calculés suivent les entrées dans le buffer
+    double *computed = values + plan.input_ids.size();
+    const int *offsets = plan.input_offsets.data();
+    const int *sources = plan.sources.data();
+    const double *bias = m_parameters->bias.data();
+    const double *weights = m_parameters->weights.data();
+
+    for (const ActivationRun &run : plan.runs)
+    {
+        for (int k = run.begin; k < run.end; k++)
+        {
+            double value = bias[k];
+            for (int c = offsets[k]; c < offsets[k + 1]; c++)
+                value += values[sources[c]] * weights[c];
+            computed[k] = value;
+        }
+        Activation::apply(run.type, computed + run.begin, run.end - run.begin);
+    }
+
+    for (size_t i = 0; i < plan.output_slots.size(); i++)
+        outputs[i] = values[plan.output_slots[i]];
+}
+
+std::vector<double> FeedForwardNeuralNetwork::activate(const std::vector<double> &inputs)
+{
+    // Assurer que le nombre d'entrées correspond
+    assert(inputs.size() == input_count());
+
+    std::vector<double> outputs(output_count());
+    activate(inputs.data(), outputs.data());
+    return outputs;
+}
 
 /**
  * @brief Crée un réseau neuronal à partir d'un génome.
+ *
+ * Les entrées de chaque neurone sont regroupées en un seul passage sur les liens, puis les neurones
+ * sont donnés dans l'ordre topologique du génome : O(neurones + liens).
  */
 FeedForwardNeuralNetwork FeedForwardNeuralNetwork::create_from_genome(const Genome &genome)
 {
     std::vector<int> inputs = genome.make_input_ids();
     std::vector<int> outputs = genome.make_output_ids();
+    const std::vector<neat::NeuronGene> &neuron_genes = genome.get_neurons();
+    const std::vector<neat::LinkGene> &links = genome.get_links();
 
     assert(!inputs.empty() && "Inputs cannot be empty.");
     assert(!outputs.empty() && "Outputs cannot be empty.");
-    assert(!genome.get_links().empty() && "Links cannot be empty.");
+    assert(!links.empty() && "Links cannot be empty.");
 
-    LayerManager layer_manager;
-    std::vector<std::vector<int>> layers = layer_manager.organize_layers(inputs, outputs, genome.get_links());
+    // Position de chaque neurone dans neuron_genes, par ID (les neurones sont triés par ID)
+    const int max_id = neuron_genes.empty() ? -1 : neuron_genes.back().neuron_id;
+    std::vector<int> gene_index(max_id + 1, -1);
+    for (size_t i = 0; i < neuron_genes.size(); i++)
+        gene_index[neuron_genes[i].neuron_id] = i;
 
-    std::vector<Neuron> neurons;
-    for (const auto &layer : layers)
+    std::vector<std::vector<NeuronInput>> neuron_inputs(neuron_genes.size());
+    for (size_t l = 0; l < links.size(); l++)
     {
-        std::vector<int> sorted_layer = layer_manager.sort_by_layer(layer, genome.get_links());
+        const auto &link = links[l];
+        if (!link.is_enabled) continue; // Ignorer les liens désactivés
 
-        for (int neuron_id : sorted_layer)
-        {
-            std::vector<NeuronInput> neuron_inputs;
-
-            for (const auto &link : genome.get_links())
-{
-    if (!link.is_enabled) continue; // Ignorer les liens désactivés
-    if (neuron_id == link.link_id.output_id)
-    {
-        neuron_inputs.emplace_back(NeuronInput{link.link_id.input_id, link.weight});
+        const int output_id = link.link_id.output_id;
+        if (output_id <= max_id && gene_index[output_id] >= 0)
+            neuron_inputs[gene_index[output_id]].push_back(NeuronInput{link.link_id.input_id, link.weight, static_cast<int>(l)});
     }
-}
-
 
-            auto neuron_gene_opt = genome.find_neuron(neuron_id);
-            // Vérification : assure qu'un neurone est trouvé dans le génome
-            if (!neuron_gene_opt.has_value())
-            {
-                std::cerr << "Neuron ID " << neuron_id << " not found in genome." << std::endl;
-                throw std::runtime_error("Neuron not found.");
-            }
-            const neat::NeuronGene &neuron_gene = *neuron_gene_opt;
+    std::vector<Neuron> neurons;
+    neurons.reserve(neuron_genes.size());
+    for (int neuron_id : genome.get_topological_order())
+    {
+        if (neuron_id > max_id || gene_index[neuron_id] < 0)
+            continue; // Extrémité d'un lien sans gène de neurone
 
-            neurons.emplace_back(Neuron{neuron_gene.neuron_id, convert_activation(neuron_gene.activation), neuron_gene.bias, std::move(neuron_inputs)});
-        }
+        const neat::NeuronGene &neuron_gene = neuron_genes[gene_index[neuron_id]];
+        neurons.emplace_back(Neuron{neuron_gene.neuron_id, neuron_gene.activation, neuron_gene.bias, std::move(neuron_inputs[gene_index[neuron_id]]), gene_index[neuron_id]});
     }
 
     return FeedForwardNeuralNetwork{std::move(inputs), std::move(outputs), std::move(neurons)};
 }
-
-ActivationFn convert_activation(const Activation &activation)
-{
-    switch (activation.get_type())
-    {
-    case Activation::Type::Sigmoid:
-        return Sigmoid{};
-    case Activation::Type::Tanh:
-        return Tanh{};
-    case Activation::Type::ReLU:
-        return ReLU{};
-    default:
-        throw std::invalid_argument("Unknown activation type");
-    }
-}
@@ -2,54 +2,83 @@
 #define NEURALNETWORK_H
 
 #include <vector>
-#include <unordered_map>
 #include <cassert>
-#include <optional>
-#include <variant>
+#include <cstddef>
+#include <memory>
 #include "Genome.h"
-#include "ActivationFn.h"
-#include "LayerManager.h"
+#include "Activation.h"
 
 struct NeuronInput
 {
     int input_id;
     double weight;
+    int link_gene = -1; // Indice du lien dans Genome::get_links(), -1 si le neurone ne vient pas d'un génome
 };
 
 struct Neuron
 {
     int neuron_id;
-    ActivationFn activation;
+    Activation activation;
     double bias;
     std::vector<NeuronInput> inputs;
+    int neuron_gene = -1; // Indice du neurone dans Genome::get_neurons(), -1 s'il ne vient pas d'un génome
 };
 
+/**
+ * @brief Réseau de neurones feedforward compilé.
+ *
+ * À la construction, la liste de neurones est compilée en un plan dense :
+ * les identifiants sont remplacés par des indices dans un buffer de valeurs contigu
+ * (les entrées occupent les premiers emplacements), les connexions sont stockées
+ * au format CSR et les neurones d'une même profondeur sont regroupés par type
+ * d'activation. L'évaluation ne fait alors plus aucune allocation ni recherche.
+ *
+ * Le plan est partagé en lecture seule : les copies d'un réseau, et les réseaux obtenus d'un même génome par
+ * NetworkCache, n'ont en propre que leur buffer de valeurs.
+ */
 class FeedForwardNeuralNetwork
 {
 public:
     /**
-     * @brief Constructeur par défaut pour la classe FeedForwardNeuralNetwork.
+     * @brief Construit et compile un réseau à partir de ses neurones.
+     *
+     * Les neurones sont fournis dans un ordre topologique (celui de Genome::get_topological_order) :
+     * leur profondeur est calculée en un seul passage. Les neurones dont l'id est une entrée
+     * sont ignorés, leur valeur est celle fournie à activate().
+     *
+     * @param input_ids Les identifiants des neurones d'entrée.
+     * @param output_ids Les identifiants des neurones de sortie.
+     * @param neurons Les neurones calculés et leurs connexions entrantes, chaque neurone après ses sources.
      *
-     * Initialise un objet FeedForwardNeuralNetwork avec des vecteurs vides pour les identifiants d'entrée et de sortie, ainsi qu'une liste vide de neurones.
+     * @throws std::runtime_error Si une connexion référence un neurone inconnu, si une sortie
+     * n'est pas calculable ou si un neurone précède l'une de ses sources (ordre non topologique ou cycle).
      */
-    FeedForwardNeuralNetwork(std::vector<int> input_ids, std::vector<int> output_ids, std::vector<Neuron> neurons)
-        : m_input_ids(std::move(input_ids)), m_output_ids(std::move(output_ids)), m_neurons(std::move(neurons)) {}
+    FeedForwardNeuralNetwork(std::vector<int> input_ids, std::vector<int> output_ids, std::vector<Neuron> neurons);
 
     /**
      * @brief Active le réseau de neurones avec un ensemble d'entrées.
      *
-     * Cette méthode active le réseau de neurones avec un ensemble d'entrées spécifié.
-     * Les valeurs d'entrée sont propagées à travers le réseau, et les valeurs de sortie
-     * sont calculées en conséquence.
+     * Aucune allocation n'est faite : les valeurs intermédiaires sont calculées dans
+     * le buffer interne du réseau et les sorties sont écrites dans le buffer de l'appelant.
+     *
+     * @param inputs Les input_count() valeurs d'entrée.
+     * @param outputs Le buffer recevant les output_count() valeurs de sortie.
+     */
+    void activate(const double *inputs, double *outputs);
+
+    /**
+     * @brief Active le réseau de neurones avec un ensemble d'entrées.
+     *
+     * Version pratique de activate(const double*, double*) qui alloue le vecteur de sortie.
      *
      * @param inputs Un vecteur d'entrées à fournir au réseau de neurones.
      * @return Un vecteur de valeurs de sortie calculées par le réseau de neurones.
-     *
-     * @throws std::runtime_error Si l'id d'un neurone n'est pas trouvé dans le vecteur de valeurs.
-     * @throws std::logic_error Si la taille des entrées ne correspond pas à la taille des neurones d'entrée.
      */
     std::vector<double> activate(const std::vector<double> &inputs);
 
+    std::size_t input_count() const { return m_topology->input_ids.size(); }
+    std::size_t output_count() const { return m_topology->output_ids.size(); }
+
     /**
      * @brief Crée un feedforward neural network à partir d'un génome.
      *
@@ -63,16 +92,51 @@ public:
     static FeedForwardNeuralNetwork create_from_genome(const Genome &genome);
 
 private:
-    std::vector<int> m_input_ids;
-    std::vector<int> m_output_ids;
-    std::vector<Neuron> m_neurons;
-};
+    friend class BatchEvaluator;
+    friend class NetworkCache;
 
-/**
- * @brief Convertir un Activation en ActivationFn
- * @param activation Activation à convertir
- * @return ActivationFn correspondant à l'Activation
- */
-ActivationFn convert_activation(const Activation &activation);
+    // Suite de neurones consécutifs du plan partageant la même activation
+    struct ActivationRun
+    {
+        Activation::Type type;
+        int begin;
+        int end;
+    };
+
+    // Structure du plan compilé : le neurone calculé k occupe l'emplacement input_ids.size() + k
+    struct Topology
+    {
+        std::vector<int> input_ids;
+        std::vector<int> output_ids;
+        std::vector<int> input_offsets; // Connexions du neurone k : [input_offsets[k], input_offsets[k + 1])
+        std::vector<int> sources;       // Emplacement source de chaque connexion
+        std::vector<ActivationRun> runs;
+        std::vector<int> output_slots;
+
+        // Gène d'où vient le biais de chaque neurone calculé et le poids de chaque connexion (-1 hors génome)
+        std::vector<int> bias_genes;
+        std::vector<int> weight_genes;
+    };
+
+    // Paramètres du plan compilé
+    struct Parameters
+    {
+        std::vector<double> bias;
+        std::vector<double> weights;
+    };
+
+    FeedForwardNeuralNetwork(std::shared_ptr<const Topology> topology, std::shared_ptr<const Parameters> parameters);
+
+    /**
+     * @brief Lit les paramètres d'un génome de même structure que celui dont topology a été compilée
+     * (mêmes neurones, activations et liens, dans le même ordre) : le plan n'est pas recompilé.
+     */
+    static std::shared_ptr<const Parameters> read_parameters(const Topology &topology, const Genome &genome);
+
+    std::shared_ptr<const Topology> m_topology;
+    std::shared_ptr<const Parameters> m_parameters;
+
+    std::vector<double> m_values;
+};
 
 #endif // NEURALNETWORK_H
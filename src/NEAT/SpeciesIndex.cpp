@@ -0,0 +1,165 @@
+#include "SpeciesIndex.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    constexpr double MISSING = std::numeric_limits<double>::quiet_NaN();
+
+    // Nombre de numéros d'innovation de sorted compris dans [lo, hi]
+    size_t count_in_range(const std::vector<int> &sorted, int lo, int hi)
+    {
+        return std::upper_bound(sorted.begin(), sorted.end(), hi) - std::lower_bound(sorted.begin(), sorted.end(), lo);
+    }
+}
+
+void FitnessTable::set(int genome_id, double fitness)
+{
+    if (values.empty())
+        base = genome_id;
+
+    if (genome_id < base)
+    {
+        values.insert(values.begin(), base - genome_id, MISSING);
+        base = genome_id;
+    }
+
+    const size_t index = genome_id - base;
+    if (index >= values.size())
+        values.resize(index + 1, MISSING);
+    values[index] = fitness;
+}
+
+bool FitnessTable::contains(int genome_id) const
+{
+    return genome_id >= base && static_cast<size_t>(genome_id - base) < values.size() && !std::isnan(values[genome_id - base]);
+}
+
+double FitnessTable::at(int genome_id) const
+{
+    if (!contains(genome_id))
+        throw std::out_of_range("Pas de fitness pour le génome " + std::to_string(genome_id));
+    return values[genome_id - base];
+}
+
+void FitnessTable::clear()
+{
+    values.clear();
+    base = 0;
+}
+
+SpeciesIndex::SpeciesIndex(const NeatConfig &config) : config(config) {}
+
+SpeciesIndex::Signature SpeciesIndex::make_signature(const Genome &genome)
+{
+    // Les liens sont triés par numéro d'innovation
+    Signature signature;
+    const std::vector<neat::LinkGene> &links = genome.get_links();
+    signature.innovations.reserve(links.size());
+    for (const neat::LinkGene &link : links)
+        signature.innovations.push_back(link.innovation_number);
+    return signature;
+}
+
+bool SpeciesIndex::too_far(const Signature &a, const Signature &b) const
+{
+    const size_t na = a.innovations.size();
+    const size_t nb = b.innovations.size();
+    const size_t max_genes = std::max(na, nb);
+    if (max_genes == 0)
+        return false;
+
+    // Deux liens ne se correspondent que s'ils ont le même numéro d'innovation : un lien hors de l'intervalle
+    // des numéros de l'autre génome est disjoint ou en excès
+    size_t matching = 0;
+    if (na > 0 && nb > 0)
+    {
+        matching = std::min(count_in_range(a.innovations, b.innovations.front(), b.innovations.back()),
+                            count_in_range(b.innovations, a.innovations.front(), a.innovations.back()));
+    }
+
+    const double non_matching = static_cast<double>(na + nb - 2 * matching);
+    const double coefficient = std::min(config.compatibility_coefficient_excess, config.compatibility_coefficient_disjoint);
+    const double bound = coefficient * non_matching / max_genes;
+
+    // Marge pour les arrondis : le minorant n'est pas calculé dans le même ordre que la distance
+    return bound > config.compatibility_threshold * (1.0 + 1e-9) + 1e-12;
+}
+
+bool SpeciesIndex::compatible(const Genome &genome, const Signature &signature, const Species &species, const Signature &representative)
+{
+    if (too_far(signature, representative))
+    {
+        ++skipped;
+        return false;
+    }
+
+    ++computed;
+    const double threshold = config.compatibility_threshold;
+    return species.representative.compute_distance(genome, config, threshold) < threshold;
+}
+
+void SpeciesIndex::speciate(std::vector<Species> &species, const std::vector<std::shared_ptr<Genome>> &genomes,
+                            simu::ThreadPool &pool, const std::function<int()> &new_species_id)
+{
+    for (Species &s : species)
+        s.clear_members();
+
+    skipped = 0;
+    computed = 0;
+
+    const size_t existing = species.size();
+    representatives.resize(existing);
+    signatures.resize(genomes.size());
+    assignment.assign(genomes.size(), -1);
+
+    pool.parallelFor(existing, 8, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t s = begin; s < end; ++s)
+            representatives[s] = make_signature(species[s].representative);
+    });
+
+    // Espèces existantes : chaque génome est indépendant
+    pool.parallelFor(genomes.size(), 16, [&](size_t begin, size_t end, unsigned int) {
+        for (size_t g = begin; g < end; ++g)
+        {
+            signatures[g] = make_signature(*genomes[g]);
+            for (size_t s = 0; s < existing; ++s)
+            {
+                if (compatible(*genomes[g], signatures[g], species[s], representatives[s]))
+                {
+                    assignment[g] = static_cast<int>(s);
+                    break;
+                }
+            }
+        }
+    });
+
+    // Espèces créées pendant ce passage, dans l'ordre des génomes comme le parcours séquentiel
+    for (size_t g = 0; g < genomes.size(); ++g)
+    {
+        if (assignment[g] < 0)
+        {
+            for (size_t s = existing; s < species.size(); ++s)
+            {
+                if (compatible(*genomes[g], signatures[g], species[s], representatives[s]))
+                {
+                    assignment[g] = static_cast<int>(s);
+                    break;
+                }
+            }
+        }
+
+        if (assignment[g] < 0)
+        {
+            // Le génome fondateur n'est que le représentant de la nouvelle espèce
+            species.emplace_back(new_species_id(), *genomes[g]);
+            representatives.push_back(signatures[g]);
+            continue;
+        }
+
+        species[assignment[g]].add_member(genomes[g]);
+    }
+}
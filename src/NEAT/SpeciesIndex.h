@@ -0,0 +1,94 @@
+#ifndef SPECIES_INDEX_H
+#define SPECIES_INDEX_H
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <atomic>
+#include "Genome.h"
+#include "NeatConfig.h"
+#include "species.h"
+#include "../engine/threadpool.h"
+
+/**
+ * @brief Fitness des génomes d'une génération, rangées par ID de génome.
+ *
+ * Les ID d'une génération sont consécutifs : un tableau décalé du plus petit ID remplace
+ * une table de hachage dont les clés seraient des copies des génomes.
+ */
+class FitnessTable
+{
+public:
+    void set(int genome_id, double fitness);
+
+    bool contains(int genome_id) const;
+
+    /**
+     * @throws std::out_of_range Si le génome n'a pas de fitness.
+     */
+    double at(int genome_id) const;
+
+    void clear();
+
+private:
+    int base = 0;
+    std::vector<double> values; // NaN pour les ID sans fitness
+};
+
+/**
+ * @brief Range les génomes d'une génération dans les espèces.
+ *
+ * Chaque génome rejoint la première espèce dont le représentant est à une distance inférieure à
+ * config.compatibility_threshold, ou crée une nouvelle espèce : même résultat que le parcours séquentiel
+ * de toutes les paires génome/représentant avec Genome::compute_distance, mais
+ * - la plupart des paires sont écartées sans parcourir les liens, par un minorant de la distance
+ *   tiré du nombre de liens et de l'intervalle des numéros d'innovation de chacun ;
+ * - la distance des paires restantes s'arrête dès qu'elle dépasse le seuil ;
+ * - les génomes sont comparés aux espèces existantes en parallèle, seuls ceux qui n'y trouvent pas
+ *   de place sont ensuite comparés, dans l'ordre, aux espèces créées pendant le passage.
+ */
+class SpeciesIndex
+{
+public:
+    explicit SpeciesIndex(const NeatConfig &config);
+
+    /**
+     * @brief Vide les membres des espèces puis y range les génomes.
+     *
+     * @param species Les espèces, les nouvelles sont ajoutées à la fin.
+     * @param genomes Les génomes de la génération, partagés avec les espèces (pas de copie).
+     * @param new_species_id Fournit l'ID de chaque nouvelle espèce.
+     */
+    void speciate(std::vector<Species> &species, const std::vector<std::shared_ptr<Genome>> &genomes,
+                  simu::ThreadPool &pool, const std::function<int()> &new_species_id);
+
+    /**
+     * @brief Nombre de paires écartées par le minorant et de distances calculées lors du dernier speciate().
+     */
+    size_t get_skipped() const { return skipped; }
+    size_t get_computed() const { return computed; }
+
+private:
+    // Résumé d'un génome pour le minorant : numéros d'innovation triés
+    struct Signature
+    {
+        std::vector<int> innovations;
+    };
+
+    static Signature make_signature(const Genome &genome);
+
+    // Vrai si la distance entre les deux génomes est certainement >= au seuil
+    bool too_far(const Signature &a, const Signature &b) const;
+
+    // Vrai si le génome peut rejoindre l'espèce
+    bool compatible(const Genome &genome, const Signature &signature, const Species &species, const Signature &representative);
+
+    NeatConfig config;
+    std::vector<Signature> representatives;
+    std::vector<Signature> signatures;
+    std::vector<int> assignment;
+    std::atomic<size_t> skipped{0};
+    std::atomic<size_t> computed{0};
+};
+
+#endif // SPECIES_INDEX_H
@@ -12,10 +12,9 @@
 
 namespace neat {
 
-NeuronGene Neat::crossover_neuron(const NeuronGene &a, const NeuronGene &b) {
+NeuronGene Neat::crossover_neuron(const NeuronGene &a, const NeuronGene &b, RNG &rng) {
     assert(a.neuron_id == b.neuron_id);
 
-    RNG rng;  
 
     int neuron_id = a.neuron_id;
     double bias = rng.choose(0.5, a.bias, b.bias);  // Choix aléatoire du biais
@@ -25,75 +24,66 @@ NeuronGene Neat::crossover_neuron(const NeuronGene &a, const NeuronGene &b) {
 }
 
 
-LinkGene Neat::crossover_link(const LinkGene &a, const LinkGene &b) {
+LinkGene Neat::crossover_link(const LinkGene &a, const LinkGene &b, RNG &rng) {
     assert(a.link_id.input_id == b.link_id.input_id);
     assert(a.link_id.output_id == b.link_id.output_id);
+    assert(a.innovation_number == b.innovation_number);
 
-    RNG rng;
 
     LinkId link_id = a.link_id;
     double weight = rng.choose(0.5, a.weight, b.weight);  // Choix aléatoire du poids
     bool is_enabled = rng.choose(0.5, a.is_enabled, b.is_enabled);  // Choix aléatoire de l'activation
-    int innovation_number = rng.choose(0.5, a.innovation_number, b.innovation_number);
 
-    return LinkGene{link_id, weight, is_enabled,innovation_number};
+    return LinkGene{link_id, weight, is_enabled, a.innovation_number};
 }
 
-Genome Neat::crossover(const Individual &dominant, const Individual &recessive, int child_genome_id) {
-    Genome offspring{child_genome_id, dominant.genome->get_num_inputs(), dominant.genome->get_num_outputs()};
-
+Genome Neat::crossover(const Individual &dominant, const Individual &recessive, int child_genome_id, RNG &rng) {
     std::cout << "Crossover " << std::endl;
 
-    for (const auto &dominant_neuron : dominant.genome->get_neurons()) {
-        int neuron_id = dominant_neuron.neuron_id;
-        std::optional<neat::NeuronGene> recessive_neuron = recessive.genome->find_neuron(neuron_id);
-        if (!recessive_neuron) {
-            offspring.add_neuron(dominant_neuron);
-        } else {
-            offspring.add_neuron(crossover_neuron(dominant_neuron, *recessive_neuron));
-        }
-    }
-
-
-    for (const auto &dominant_link : dominant.genome->get_links()) {
-        LinkId link_id = dominant_link.link_id;
-        std::optional<neat::LinkGene> recessive_link = recessive.genome->find_link(link_id);
-        if (!recessive_link) {
-            offspring.add_link(dominant_link);
-        } else {
-            offspring.add_link(crossover_link(dominant_link, *recessive_link));
-        }
-    }
-
-    return offspring;
+    return merge(*dominant.genome, *recessive.genome, child_genome_id, rng);
 }
 
 Genome Neat::alt_crossover(const std::shared_ptr<Genome>& dominant, 
                        const std::shared_ptr<Genome>& recessive, 
-                       int child_genome_id) {
-    Genome offspring{child_genome_id, dominant->get_num_inputs(), dominant->get_num_outputs()};
+                       int child_genome_id, RNG &rng) {
+    return merge(*dominant, *recessive, child_genome_id, rng);
+}
 
-    //std::cout << "Crossover with shared_ptr" << std::endl;
+Genome Neat::merge(const Genome &dominant, const Genome &recessive, int child_genome_id, RNG &rng) {
+    const std::vector<NeuronGene> &dominant_neurons = dominant.get_neurons();
+    const std::vector<NeuronGene> &recessive_neurons = recessive.get_neurons();
+    const std::vector<LinkGene> &dominant_links = dominant.get_links();
+    const std::vector<LinkGene> &recessive_links = recessive.get_links();
+
+    // L'enfant a exactement les gènes du dominant
+    Genome offspring{child_genome_id, dominant.get_num_inputs(), dominant.get_num_outputs()};
+    offspring.reserve(dominant_neurons.size(), dominant_links.size());
+
+    // Crossover des neurones, les deux listes sont triées par ID
+    auto recessive_neuron = recessive_neurons.begin();
+    for (const auto &dominant_neuron : dominant_neurons) {
+        while (recessive_neuron != recessive_neurons.end() && recessive_neuron->neuron_id < dominant_neuron.neuron_id) {
+            ++recessive_neuron;
+        }
 
-    // Crossover des neurones
-    for (const auto& dominant_neuron : dominant->get_neurons()) {
-        int neuron_id = dominant_neuron.neuron_id;
-        std::optional<neat::NeuronGene> recessive_neuron = recessive->find_neuron(neuron_id);
-        if (!recessive_neuron) {
+        if (recessive_neuron == recessive_neurons.end() || recessive_neuron->neuron_id != dominant_neuron.neuron_id) {
             offspring.add_neuron(dominant_neuron);
         } else {
-            offspring.add_neuron(crossover_neuron(dominant_neuron, *recessive_neuron));
+            offspring.add_neuron(crossover_neuron(dominant_neuron, *recessive_neuron, rng));
         }
     }
 
-    // Crossover des liens
-    for (const auto& dominant_link : dominant->get_links()) {
-        LinkId link_id = dominant_link.link_id;
-        std::optional<neat::LinkGene> recessive_link = recessive->find_link(link_id);
-        if (!recessive_link) {
+    // Crossover des liens, les deux listes sont triées par numéro d'innovation
+    auto recessive_link = recessive_links.begin();
+    for (const auto &dominant_link : dominant_links) {
+        while (recessive_link != recessive_links.end() && recessive_link->innovation_number < dominant_link.innovation_number) {
+            ++recessive_link;
+        }
+
+        if (recessive_link == recessive_links.end() || recessive_link->innovation_number != dominant_link.innovation_number) {
             offspring.add_link(dominant_link);
         } else {
-            offspring.add_link(crossover_link(dominant_link, *recessive_link));
+            offspring.add_link(crossover_link(dominant_link, *recessive_link, rng));
         }
     }
 
@@ -19,10 +19,10 @@ namespace neat
          * des ID uniques et en utilisant un générateur de nombres aléatoires pour les opérations de mutation.
          *
          * @constructor
-         * Initialise le NeuronMutator avec un ID de neurone de départ à 0 et un générateur
-         * de nombres aléatoires par défaut.
+         * Initialise le NeuronMutator avec un ID de neurone de départ à 0 et le flux
+         * de nombres aléatoires de l'appelant.
          */
-        NeuronMutator() : next_neuron_id(0), rng() {}
+        explicit NeuronMutator(RNG &rng) : next_neuron_id(0), rng(rng) {}
 
         /**
          * @brief Crée un nouveau neurone avec un ID unique et un biais aléatoire.
@@ -44,23 +44,19 @@ namespace neat
 
     private:
         int next_neuron_id;
-        RNG rng;
+        RNG &rng;
 
         /**
          * @brief Génère une valeur de biais aléatoire.
          *
          * Cette fonction génère une valeur de biais aléatoire entre -1.0 et 1.0 en utilisant une
-         * distribution uniforme réelle. Elle utilise le random_device pour initialiser le
-         * générateur de nombres aléatoires Mersenne Twister.
+         * distribution uniforme réelle tirée du flux rng.
          *
          * @return Un double représentant la valeur de biais aléatoire générée.
          */
         double generate_random_bias()
         {
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_real_distribution<> dis(-1.0, 1.0);
-            return dis(gen);
+            return rng.uniform(-1.0, 1.0);
         }
     };
 
@@ -10,10 +10,17 @@
 
 
 Population::Population(NeatConfig config, RNG &rng) 
-    : config{config}, rng{rng}, next_genome_id{0} {
+    : config{config}, rng{rng}, next_genome_id{0}, seed{config.seed ? config.seed : RNG::run_seed()} {
+    create_initial_individuals();
+}
+
+void Population::create_initial_individuals() {
+    individuals.clear();
     for (int i = 0; i < config.population_size; ++i) {
-        int num_hidden_neurons = rng.next_int(1, 4);  // Random hidden neurons
-std::shared_ptr<Genome> genome = std::make_shared<Genome>(Genome::create_genome(generate_next_genome_id(), config.num_inputs, config.num_outputs, num_hidden_neurons, rng));
+        const int genome_id = generate_next_genome_id();
+        RNG init(seed, 0, genome_id, RngPurpose::INIT);
+        int num_hidden_neurons = init.next_int(1, 4);  // Random hidden neurons
+std::shared_ptr<Genome> genome = std::make_shared<Genome>(Genome::create_genome(genome_id, config.num_inputs, config.num_outputs, num_hidden_neurons, init));
 individuals.emplace_back(genome);
 
     }
@@ -36,7 +43,23 @@ int Population::generate_genome_id() {
 
 
 void Population::mutate(Genome &genome) {
-    Mutator::mutate(genome, config, rng);
+    RNG mutation(seed, generation, genome.get_genome_id(), RngPurpose::MUTATION);
+    Mutator::mutate(genome, config, mutation);
+}
+
+RNG Population::begin_generation() {
+    ++generation;
+    return RNG(seed, generation, 0, RngPurpose::SELECTION);
+}
+
+std::shared_ptr<Genome> Population::breed(const std::shared_ptr<Genome>& dominant, const std::shared_ptr<Genome>& recessive) {
+    const int child_id = generate_next_genome_id();
+    RNG crossover(seed, generation, child_id, RngPurpose::CROSSOVER);
+
+    neat::Neat neat_instance;
+    std::shared_ptr<Genome> offspring = std::make_shared<Genome>(neat_instance.alt_crossover(dominant, recessive, child_id, crossover));
+    mutate(*offspring); // Flux (graine, génération, child_id, MUTATION)
+    return offspring;
 }
 
 std::vector<neat::Individual> Population::reproduce() {
@@ -46,22 +69,18 @@ std::vector<neat::Individual> Population::reproduce() {
 
     std::cout << "Reproducing..." << std::endl;
 
+    RNG selection = begin_generation();
     while (new_generation.size() < config.population_size) {
-        neat::Individual& p1 = rng.choose_random(old_members, reproduction_cutoff);
-        neat::Individual& p2 = rng.choose_random(old_members, reproduction_cutoff);
+        neat::Individual& p1 = selection.choose_random(old_members, reproduction_cutoff);
+        neat::Individual& p2 = selection.choose_random(old_members, reproduction_cutoff);
 
         std::cout << "Crossover between " << p1.genome->get_genome_id() << " and " << p2.genome->get_genome_id() << std::endl;
 
-        neat::Neat neat_instance;
-        Genome offspring = neat_instance.crossover(p1.genome, p2.genome, generate_next_genome_id());
-
-        std::cout << "Offspring genome ID: " << offspring.get_genome_id() << std::endl;
-
-        mutate(offspring);
+        std::shared_ptr<Genome> offspring = breed(p1.genome, p2.genome);
 
-        
+        std::cout << "Offspring genome ID: " << offspring->get_genome_id() << std::endl;
 
-        new_generation.push_back(neat::Individual(std::make_shared<Genome>(offspring)));
+        new_generation.push_back(neat::Individual(offspring));
 
     }
 
@@ -93,19 +112,17 @@ std::vector<neat::Individual> Population::reproduce_from_genomes(const std::vect
     std::cout << "Reproducing from custom genome list..." << std::endl;
 
     // Boucle pour créer la nouvelle génération
+    RNG selection = begin_generation();
     while (new_generation.size() < config.population_size) {
-        const std::shared_ptr<Genome>& p1 = rng.choose_random(sorted_genomes, reproduction_cutoff);
-        const std::shared_ptr<Genome>& p2 = rng.choose_random(sorted_genomes, reproduction_cutoff);
+        const std::shared_ptr<Genome>& p1 = selection.choose_random(sorted_genomes, reproduction_cutoff);
+        const std::shared_ptr<Genome>& p2 = selection.choose_random(sorted_genomes, reproduction_cutoff);
 
         std::cout << "Crossover between " << p1->get_genome_id() << " and " << p2->get_genome_id() << std::endl;
 
-        neat::Neat neat_instance;
-        Genome offspring_genome = neat_instance.alt_crossover(p1, p2, generate_next_genome_id());
-        std::shared_ptr<Genome> offspring = std::make_shared<Genome>(offspring_genome);
+        std::shared_ptr<Genome> offspring = breed(p1, p2);
 
         std::cout << "Offspring genome ID: " << offspring->get_genome_id() << std::endl;
 
-        mutate(*offspring);
 
         new_generation.push_back(neat::Individual(offspring));
     }
@@ -148,20 +165,16 @@ std::vector<neat::Individual> Population::reproduce_from_genomes_with_fitness(
     std::cout << "Reproducing from sorted genome list with fitness..." << std::endl;
 
     // Boucle pour créer la nouvelle génération
+    RNG selection = begin_generation();
     while (new_generation.size() < config.population_size) {
         // Sélectionner deux parents parmi les meilleurs génomes (selon le seuil de survie)
-        const std::shared_ptr<Genome>& p1 = rng.choose_random(sorted_genomes, reproduction_cutoff);
-        const std::shared_ptr<Genome>& p2 = rng.choose_random(sorted_genomes, reproduction_cutoff);
+        const std::shared_ptr<Genome>& p1 = selection.choose_random(sorted_genomes, reproduction_cutoff);
+        const std::shared_ptr<Genome>& p2 = selection.choose_random(sorted_genomes, reproduction_cutoff);
 
         std::cout << "Crossover between " << p1->get_genome_id() << " and " << p2->get_genome_id() << std::endl;
 
-        // Crossover
-        neat::Neat neat_instance;
-        Genome offspring_genome = neat_instance.alt_crossover(p1, p2, generate_next_genome_id());
-        std::shared_ptr<Genome> offspring = std::make_shared<Genome>(offspring_genome);
+        std::shared_ptr<Genome> offspring = breed(p1, p2);
 
-        // Mutation
-        mutate(*offspring);
 
         // Ajouter à la nouvelle génération
         new_generation.push_back(neat::Individual(offspring));
@@ -182,18 +195,14 @@ std::vector<neat::Individual> Population::reproduce_from_genome_roulette(
 
     std::vector<neat::Individual> new_generation;
 
+    RNG selection = begin_generation();
     while (new_generation.size() < config.population_size) {
         // Sélection des parents par roulette
-        const auto& p1 = rng.roulette_selection(genomes, fitnesses);
-        const auto& p2 = rng.roulette_selection(genomes, fitnesses);
+        const auto& p1 = selection.roulette_selection(genomes, fitnesses);
+        const auto& p2 = selection.roulette_selection(genomes, fitnesses);
 
-        // Crossover
-        neat::Neat neat_instance;
-        Genome offspring_genome = neat_instance.alt_crossover(p1, p2, generate_next_genome_id());
-        std::shared_ptr<Genome> offspring = std::make_shared<Genome>(offspring_genome);
+        std::shared_ptr<Genome> offspring = breed(p1, p2);
 
-        // Mutation
-        mutate(*offspring);
 
         // Ajouter à la nouvelle génération
         new_generation.push_back(neat::Individual(offspring));
@@ -223,18 +232,14 @@ std::vector<neat::Individual> Population::reproduce_from_genome_roulette_negativ
     // Étape 2 : Création de la nouvelle génération
     std::vector<neat::Individual> new_generation;
 
+    RNG selection = begin_generation();
     while (new_generation.size() < config.population_size) {
         // Sélection des parents par roulette biaisée sur les fitness ajustées
-        const auto& p1 = rng.roulette_selection(genomes, adjusted_fitnesses);
-        const auto& p2 = rng.roulette_selection(genomes, adjusted_fitnesses);
+        const auto& p1 = selection.roulette_selection(genomes, adjusted_fitnesses);
+        const auto& p2 = selection.roulette_selection(genomes, adjusted_fitnesses);
 
-        // Crossover
-        neat::Neat neat_instance;
-        Genome offspring_genome = neat_instance.alt_crossover(p1, p2, generate_next_genome_id());
-        std::shared_ptr<Genome> offspring = std::make_shared<Genome>(offspring_genome);
+        std::shared_ptr<Genome> offspring = breed(p1, p2);
 
-        // Mutation
-        mutate(*offspring);
 
         // Ajouter à la nouvelle génération
         new_generation.push_back(neat::Individual(offspring));
@@ -245,12 +250,13 @@ std::vector<neat::Individual> Population::reproduce_from_genome_roulette_negativ
 
 std::vector<neat::Individual> Population::reproduce_with_speciation(
     const std::vector<Species>& species_list,
-    const std::unordered_map<Genome, double>& fitness_map
+    const FitnessTable& fitnesses
 ) {
     std::vector<neat::Individual> new_generation;
 
     double interspecies_mating_rate = config.interspecies_mating; // Probabilité de croisement inter-espèces
 
+    RNG selection = begin_generation();
     for (const auto &species : species_list) {
         // Ajuster les fitness de l'espèce
         std::vector<double> adjusted_fitnesses;
@@ -259,12 +265,12 @@ std::vector<neat::Individual> Population::reproduce_with_speciation(
         for (const auto &genome : species.members) {
            // std::cerr << "Traitement du génome ID: " << genome->get_genome_id() << std::endl;
 
-            if (fitness_map.find(*genome) == fitness_map.end()) {
-                std::cerr << "Erreur: Génome ID " << genome->get_genome_id() << " absent de fitness_map !" << std::endl;
+            if (!fitnesses.contains(genome->get_genome_id())) {
+                std::cerr << "Erreur: Génome ID " << genome->get_genome_id() << " sans fitness !" << std::endl;
                 continue;
             }
 
-            double adjusted_fitness = fitness_map.at(*genome) / species.members.size();
+            double adjusted_fitness = fitnesses.at(genome->get_genome_id()) / species.members.size();
             adjusted_fitnesses.push_back(adjusted_fitness);
 
             //std::cerr << "Taille de species.members: " << species.members.size() << std::endl;
@@ -286,17 +292,14 @@ std::vector<neat::Individual> Population::reproduce_with_speciation(
         }
 
         while (new_generation.size() < config.population_size) {
-            bool interspecies_mating = (rng.next_double() < interspecies_mating_rate);
+            bool interspecies_mating = (selection.next_double() < interspecies_mating_rate);
 
-            const auto &p1 = rng.roulette_selection(species.members, adjusted_fitnesses);
-            const auto &p2 = interspecies_mating ? rng.choose_random(species_list).members.front() 
-                                                 : rng.roulette_selection(species.members, adjusted_fitnesses);
+            const auto &p1 = selection.roulette_selection(species.members, adjusted_fitnesses);
+            const auto &p2 = interspecies_mating ? selection.choose_random(species_list).members.front() 
+                                                 : selection.roulette_selection(species.members, adjusted_fitnesses);
 
-            neat::Neat neat_instance;
-            Genome offspring_genome = neat_instance.alt_crossover(p1, p2, generate_next_genome_id());
-            std::shared_ptr<Genome> offspring = std::make_shared<Genome>(offspring_genome);
+            std::shared_ptr<Genome> offspring = breed(p1, p2);
 
-            mutate(*offspring);
             new_generation.push_back(neat::Individual(offspring));
         }
     }
@@ -363,7 +366,8 @@ void Population::update_species_representatives() {
     for (auto &species : species_list) {
         if (species.members.empty()) continue;
         // Option 1: Prendre un représentant aléatoire parmi les survivants
-        int random_index = rand() % species.members.size();
+        RNG representative(seed, generation, species.id, RngPurpose::REPRESENTATIVE);
+        int random_index = representative.next_int(0, species.members.size() - 1);
         species.representative = *species.members[random_index];
         // Option 2: Prendre le génome médian
         // std::sort(species.members.begin(), species.members.end(),
@@ -375,6 +379,22 @@ void Population::update_species_representatives() {
     }
 }
 
+void Population::speciate(const std::vector<std::shared_ptr<Genome>> &genomes, simu::ThreadPool &pool) {
+    SpeciesIndex index(config);
+    index.speciate(species_list, genomes, pool, [this]() { return generate_next_species_id(); });
+}
+
+std::vector<neat::Individual> Population::next_generation(const std::vector<std::shared_ptr<Genome>> &genomes,
+                                                          const FitnessTable &fitnesses, simu::ThreadPool &pool) {
+    const size_t kept_species = species_list.size();
+    speciate(genomes, pool);
+    std::cerr << "Nombre total d'especes: " << species_list.size() << std::endl;
+
+    std::vector<neat::Individual> new_generation = reproduce_with_speciation(species_list, fitnesses);
+    species_list.erase(species_list.begin() + kept_species, species_list.end());
+    return new_generation;
+}
+
 std::vector<Species> &Population::get_species_list()
 {return species_list;
 }
@@ -385,3 +405,23 @@ int Population::species_id_counter = 0;
 int Population::generate_next_species_id() {
     return species_id_counter ++;
 }
+
+void Population::reseed() {
+    seed = config.seed ? config.seed : RNG::run_seed();
+    if (generation == 0) {
+        next_genome_id = 0;
+        create_initial_individuals();
+    }
+}
+
+Population::State Population::get_state() const {
+    return State{seed, generation, next_genome_id, species_id_counter};
+}
+
+void Population::restore(const State& state, std::vector<Species> species) {
+    seed = state.seed;
+    generation = state.generation;
+    next_genome_id = state.next_genome_id;
+    species_id_counter = state.next_species_id;
+    species_list = std::move(species);
+}
@@ -7,6 +7,7 @@
 #include "Genome.h"
 #include "NeatConfig.h"
 #include "species.h"
+#include "SpeciesIndex.h"
 #include <vector>
 #include <algorithm>
 #include <cmath>
@@ -15,6 +16,18 @@ class Population
 {
 public:
 
+   /**
+    * @brief Compteurs dont dépendent les générations suivantes : clé des flux aléatoires et prochains identifiants.
+    * Avec les génomes et les espèces, ils suffisent à reprendre un entraînement (voir simu::CheckpointWriter).
+    */
+   struct State
+   {
+      uint64_t seed;
+      uint64_t generation;
+      int next_genome_id;
+      int next_species_id;
+   };
+
    
    /**
     * @brief Constructeur de la classe Population.
@@ -58,6 +71,8 @@ public:
     * - Faire muter le poids d'un lien aléatoire avec la probabilité définie par `config.probability_mutate_link_weight`.
     * - Faire muter le biais d'un neurone aléatoire avec la probabilité définie par `config.probability_mutate_neuron_bias`.
     *
+    * Les tirages viennent du flux (graine, génération, ID du génome, MUTATION).
+    *
     * @param genome Le génome à muter.
     */
    void mutate(Genome &genome);
@@ -90,11 +105,15 @@ public:
        const std::vector<double>& fitnesses
    );
 
- std::vector<neat::Individual> reproduce_with_speciation(
-    const std::vector<Species>& species_list,
-    const std::unordered_map<Genome, double>& fitness_map
-
-);
+   /**
+    * @brief Reproduit chaque espèce selon la fitness ajustée de ses membres.
+    *
+    * @param fitnesses Fitness des membres, par ID de génome.
+    */
+   std::vector<neat::Individual> reproduce_with_speciation(
+      const std::vector<Species>& species_list,
+      const FitnessTable& fitnesses
+   );
 
 
    /**
@@ -146,13 +165,59 @@ public:
 
     void update_species_representatives();
 
+    /**
+     * @brief Range les génomes dans les espèces de la population (voir SpeciesIndex).
+     * Les nouvelles espèces prennent leur ID de generate_next_species_id().
+     */
+    void speciate(const std::vector<std::shared_ptr<Genome>> &genomes, simu::ThreadPool &pool);
+
+    /**
+     * @brief Range à nouveau les génomes évalués parmi les représentants mis à jour, puis reproduit les espèces.
+     * Les espèces créées par ce passage ne servent qu'à la reproduction et ne sont pas gardées.
+     *
+     * @param fitnesses Fitness des génomes, par ID de génome.
+     */
+    std::vector<neat::Individual> next_generation(const std::vector<std::shared_ptr<Genome>> &genomes,
+                                                  const FitnessTable &fitnesses, simu::ThreadPool &pool);
+
+    /**
+     * @brief Reprend la graine du run (RNG::run_seed) si config.seed ne fixe pas celle de la population.
+     * Avant la première reproduction, la population initiale est recréée avec la nouvelle graine.
+     */
+    void reseed();
+
+    State get_state() const;
+
+    /**
+     * @brief Restaure les compteurs et les espèces d'une génération sauvegardée.
+     */
+    void restore(const State& state, std::vector<Species> species);
+
     
 
    
 private:
+   /**
+    * @brief Passe à la génération suivante et renvoie le flux de sélection des parents.
+    */
+   RNG begin_generation();
+
+   /**
+    * @brief Remplace les individus par config.population_size génomes initiaux tirés des flux INIT.
+    */
+   void create_initial_individuals();
+
+   /**
+    * @brief Croise dominant et recessive puis mute l'enfant. Le croisement et la mutation tirent dans des flux
+    * dérivés de (graine, génération, ID de l'enfant) : l'enfant ne dépend pas de l'ordre de production.
+    */
+   std::shared_ptr<Genome> breed(const std::shared_ptr<Genome>& dominant, const std::shared_ptr<Genome>& recessive);
+
    NeatConfig config;
    RNG &rng;
    int next_genome_id;
+   uint64_t seed;            // Graine des flux de la population
+   uint64_t generation = 0;  // Génération courante, fait partie de la clé des flux
    static int species_id_counter;
    std::vector<neat::Individual> individuals;
    neat::Individual best_individual;
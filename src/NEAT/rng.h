@@ -1,48 +1,112 @@
 #ifndef RNG_H
 #define RNG_H
 
-#include <random>
 #include <vector>
 #include <stdexcept>
+#include <cstdint>
+#include <cmath>
+#include <numeric>
+#include <atomic>
+#include <initializer_list>
+
+
+/**
+ * @brief Rôle d'un flux aléatoire, fait partie de sa clé : deux rôles d'un même génome ne partagent jamais de tirages.
+ */
+enum class RngPurpose : uint64_t {
+    DEFAULT,        // Instances construites par défaut
+    INIT,           // Création des génomes de la population initiale
+    SELECTION,      // Choix des parents d'une génération
+    CROSSOVER,      // Croisement produisant un enfant
+    MUTATION,       // Mutation d'un enfant
+    EVALUATION,     // Évaluation d'un génome
+    ENTITY,         // Comportement d'une entité du monde
+    WORLD,          // Tirages partagés du monde (simu::gRng)
+    REPRESENTATIVE, // Choix du représentant d'une espèce
+};
 
-
+/**
+ * @brief Générateur à compteur : le n-ième tirage d'un flux est mix(clé ^ mix(n)).
+ *
+ * La clé est dérivée de (graine du run, génération, ID du génome, rôle). Un flux n'a pas d'autre état que
+ * son compteur, deux flux de clés différentes sont indépendants : chaque enfant d'une génération peut être
+ * produit sur n'importe quel thread, dans n'importe quel ordre, avec exactement les mêmes tirages.
+ * Construire un flux ne coûte que quelques multiplications (pas de random_device ni d'état Mersenne Twister).
+ */
 class RNG {
 public:
-    RNG() : gen(rd()) {}  // Initialisation du générateur
+    using result_type = uint64_t;
+
+    // Flux distinct pour chaque instance construite par défaut, dans l'ordre de construction
+    RNG() : key(stream_key(run_seed(), 0, default_streams().fetch_add(1, std::memory_order_relaxed), RngPurpose::DEFAULT)) {}
+
+    explicit RNG(uint64_t key) : key(key) {}
+
+    RNG(uint64_t seed, uint64_t generation, uint64_t id, RngPurpose purpose)
+        : key(stream_key(seed, generation, id, purpose)) {}
+
+    // Reprend un flux là où il s'était arrêté (voir get_key et get_counter)
+    RNG(uint64_t key, uint64_t counter) : key(key), counter(counter) {}
+
+    uint64_t get_key() const { return key; }
+    uint64_t get_counter() const { return counter; }
+
+    // Finaliseur de SplitMix64 : bijection qui disperse chaque bit d'entrée sur tous les bits de sortie
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t stream_key(uint64_t seed, uint64_t generation, uint64_t id, RngPurpose purpose) {
+        uint64_t k = mix(seed + 0x9E3779B97F4A7C15ULL);
+        k = mix(k ^ (generation + 0xD1B54A32D192ED03ULL));
+        k = mix(k ^ (id + 0xABC98388FB8FAC03ULL));
+        return mix(k ^ (static_cast<uint64_t>(purpose) + 0x8CB92BA72F3D8DD7ULL));
+    }
+
+    /** @brief Graine du run, lue à la construction des flux. Fixe par défaut pour que deux runs
+     *  soient identiques, le monde la remplace par la sienne.
+     */
+    static uint64_t run_seed() { return run_seed_storage().load(std::memory_order_relaxed); }
+    static void set_run_seed(uint64_t seed) { run_seed_storage().store(seed, std::memory_order_relaxed); }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() { return mix(key ^ mix(++counter)); }
 
     bool next_bool() {
-        std::uniform_int_distribution<> dis(0, 1);  // Génère un entier 0 ou 1
-        return dis(gen);  // Retourne un booléen aléatoire
+        return (*this)() >> 63;
     }
 
     // Génère un entier aléatoire entre min et max (inclus)
     int next_int(int min, int max) {
-        std::uniform_int_distribution<int> dist(min, max);
-        return dist(gen);
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+        return static_cast<int>(min + static_cast<int64_t>((*this)() % range));
     }
 
     // Génère un nombre réel aléatoire entre min et max
     double uniform(double min, double max) {
-        std::uniform_real_distribution<double> dist(min, max);
-        return dist(gen);
+        return min + (max - min) * next_double();
     }
 
-    // Génère un nombre selon une distribution gaussienne
+    // Génère un nombre selon une distribution gaussienne (Box-Muller, deux tirages par appel)
     double gaussian(double mean, double stddev) {
-        std::normal_distribution<double> dist(mean, stddev);
-        return dist(gen);
+        const double u1 = 1.0 - next_double(); // Dans ]0, 1] pour le logarithme
+        const double u2 = next_double();
+        return mean + stddev * std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
     }
 
-    // Génère un nombre réel aléatoire entre 0 et 1
+    // Génère un nombre réel aléatoire entre 0 et 1 (exclu)
     double next_double() {
-        return uniform(0.0, 1.0);
+        return ((*this)() >> 11) * 0x1.0p-53;
     }
 
     // Méthode pour choisir entre deux valeurs avec une probabilité
     template <typename T>
     T choose(double probability, const T& a, const T& b) {
-        std::uniform_real_distribution<> dis(0, 1);  // Génère un nombre entre 0 et 1
-        return (dis(gen) < probability) ? a : b;     // Retourne a si la probabilité est respectée, sinon b
+        return (next_double() < probability) ? a : b;     // Retourne a si la probabilité est respectée, sinon b
     }
 
     // Méthode pour choisir un élément aléatoire dans un vecteur
@@ -51,15 +115,13 @@ public:
         if (vec.empty()) {
             throw std::out_of_range("Cannot choose from an empty vector.");
         }
-        std::uniform_int_distribution<> dis(0, vec.size() - 1);  // Distribution pour choisir un indice aléatoire
-        return vec[dis(gen)];  // Retourner l'élément choisi aléatoirement
+        return vec[index(vec.size())];  // Retourner l'élément choisi aléatoirement
     }
 
         // Méthode pour choisir aléatoirement entre deux valeurs
     template <typename T>
     T choose(const T& a, const T& b) {
-        std::uniform_int_distribution<> dis(0, 1);  // Génère un entier 0 ou 1
-        return dis(gen) ? a : b;  // Retourne l'une des deux valeurs
+        return next_bool() ? a : b;  // Retourne l'une des deux valeurs
     }
 
     // Méthode pour choisir un élément aléatoire parmi plusieurs options
@@ -68,13 +130,11 @@ public:
         if (options.size() == 0) {
             throw std::out_of_range("Cannot choose from an empty list.");
         }
-        std::uniform_int_distribution<> dis(0, options.size() - 1);
-        return *(std::begin(options) + dis(gen));  // Retourner un élément aléatoire
+        return *(std::begin(options) + index(options.size()));  // Retourner un élément aléatoire
     }
 
     double next_gaussian(double mean, double stddev) {
-    std::normal_distribution<double> dist(mean, stddev);
-    return dist(gen);  // Utilise le générateur de nombres aléatoires défini dans RNG
+    return gaussian(mean, stddev);
 }
 
     
@@ -87,8 +147,7 @@ T& choose_random(const std::vector<T>& vec, int limit) {
     if (static_cast<size_t>(limit) > vec.size()) {  // Correction de la comparaison
         throw std::out_of_range("Limit is larger than the vector size.");
     }
-    std::uniform_int_distribution<> dis(0, limit - 1);  // Distribution pour choisir un indice aléatoire entre 0 et limit-1
-    return const_cast<T&>(vec[dis(gen)]);  // Retourner l'élément choisi aléatoirement
+    return const_cast<T&>(vec[index(limit)]);  // Retourner l'élément choisi aléatoirement parmi les limit premiers
 }
 
 
@@ -99,8 +158,7 @@ T& roulette_selection(const std::vector<T>& items, const std::vector<double>& fi
     }
 
     double total_fitness = std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0);
-    std::uniform_real_distribution<double> dist(0.0, total_fitness);
-    double random_value = dist(gen);
+    double random_value = uniform(0.0, total_fitness);
 
     double cumulative_fitness = 0.0;
     for (size_t i = 0; i < items.size(); ++i) {
@@ -115,8 +173,55 @@ T& roulette_selection(const std::vector<T>& items, const std::vector<double>& fi
 
 
 private:
-    std::random_device rd;  // Source d'entropie pour la génération aléatoire
-    std::mt19937 gen;       // Générateur de nombres aléatoires basé sur Mersenne Twister
+    // Indice dans [0, size)
+    size_t index(size_t size) {
+        return static_cast<size_t>((*this)() % size);
+    }
+
+    static std::atomic<uint64_t>& run_seed_storage() {
+        static std::atomic<uint64_t> seed{0x5EED5EED5EED5EEDULL};
+        return seed;
+    }
+
+    static std::atomic<uint64_t>& default_streams() {
+        static std::atomic<uint64_t> count{0};
+        return count;
+    }
+
+    uint64_t key;          // Clé du flux
+    uint64_t counter = 0;  // Nombre de tirages déjà faits
+};
+
+// Générateur SplitMix64 : 8 octets d'état, aucun appel système, pour donner un flux à chaque entité
+class FastRNG {
+public:
+    explicit FastRNG(uint64_t seed = 0) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Génère un nombre réel aléatoire entre 0 et 1 (exclu)
+    double next_double() {
+        return (next() >> 11) * 0x1.0p-53;
+    }
+
+    // Génère un nombre réel aléatoire entre min et max
+    double uniform(double min, double max) {
+        return min + (max - min) * next_double();
+    }
+
+    // Génère un entier aléatoire entre min et max (inclus)
+    int next_int(int min, int max) {
+        const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(max) - min) + 1;
+        return static_cast<int>(min + static_cast<int64_t>(next() % range));
+    }
+
+private:
+    uint64_t state;
 };
 
 #endif // RNG_H
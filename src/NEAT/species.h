@@ -1,4 +1,8 @@
+#ifndef SPECIES_H
+#define SPECIES_H
+
 #include <vector>
+#include <memory>
 
 #include "Genome.h"
 
@@ -10,12 +14,20 @@ public:
     std::vector<std::shared_ptr<Genome>> members;
 
     Species(int id, const Genome &rep) : id(id), representative(rep) {}
+    Species(int id, Genome &&rep) : id(id), representative(std::move(rep)) {}
 
     void add_member(const Genome &genome) {
         members.push_back(std::make_shared<Genome>(genome));
     }
 
+    // Partage le génome au lieu de le copier
+    void add_member(const std::shared_ptr<Genome> &genome) {
+        members.push_back(genome);
+    }
+
     void clear_members() {
         members.clear();
     }
 };
+
+#endif // SPECIES_H
@@ -4,18 +4,30 @@
 #include "raymath.h"
 
 #include "world.h"
+#include "checkpoint.h"
+#include "../NEAT/NetworkCache.h"
 
 
-#include <random> 
+#include <array>
+#include <algorithm>
+#include <cmath>
 
 using namespace simu;
 
-Ant::Ant(const long id) : Entity(id) {}
-Ant::Ant(const long id, const Ant& ant) : Entity(id, ant), m_life(ant.m_life), 
+namespace
+{
+    uint64_t streamSeed(long id)
+    {
+        return RNG::stream_key(getWorld().getSeed(), 0, static_cast<uint64_t>(id), RngPurpose::ENTITY);
+    }
+}
+
+Ant::Ant(const long id) : Entity(id), m_rng(streamSeed(id)) {}
+Ant::Ant(const long id, const Ant& ant) : Entity(id, ant), m_rng(streamSeed(id)), m_life(ant.m_life), 
 m_carried_object(ant.m_carried_object)
 {
 }
-Ant::Ant(const long id, Vec2f pos) : Entity(id, pos) {}
+Ant::Ant(const long id, Vec2f pos) : Entity(id, pos), m_rng(streamSeed(id)) {}
 
 void Ant::update() {}
 
@@ -43,6 +55,20 @@ void Ant::load(const json &json)
     json.at("carried_object").get_to(m_carried_object.type);
 }
 
+void Ant::save(Serializer& s) const
+{
+    Entity::save(s);
+    s.write(m_life);
+    s.write(m_carried_object.type);
+}
+
+void Ant::load(Serializer& s)
+{
+    Entity::load(s);
+    m_life = s.read<float>();
+    m_carried_object.type = s.read<Type>();
+}
+
 void Ant::rotate(float angle)
 {
     m_velocity = Vector2Rotate((Vector2) {1.0, 0.0}, angle);
@@ -91,11 +117,41 @@ void Ant::pheromone()
     }
 }
 
+void Ant::trail(PheromoneChannel channel, float amount)
+{
+    Grid& grid = getWorld().getGrid();
+    const Vec2i pos = grid.toTileCoord(m_pos);
+    grid.depositPheromone(channel, pos.x, pos.y, amount);
+}
+
+Vec2f Ant::senseTrail(PheromoneChannel channel) const
+{
+    const Grid& grid = getWorld().getGrid();
+    const Vec2i pos = grid.toTileCoord(m_pos);
+    return grid.getPheromones().gradient(channel, pos.x, pos.y);
+}
+
 void Ant::beat()
 {
-    // Prendre l'entité la plus proche
+    // Prendre l'entité la plus proche, à moins d'une tuile
+    World& world = getWorld();
+    std::vector<unsigned long> nearest;
+    world.getSpatialIndex().nearest(m_pos, 1, nearest, world.getGrid().getTileSize(), getId());
+    if(nearest.empty())
+        return;
+
+    auto target = world.getEntity<Ant>(nearest[0]);
+    Ant* ant = target.lock();
+    if(!ant)
+        return;
+
     // Vérifier si elle est en face
+    const Vec2f toTarget = ant->getPos() - m_pos;
+    if(toTarget.x * m_velocity.x + toTarget.y * m_velocity.y <= 0.f)
+        return;
+
     // Retirer de la vie
+    ant->m_life = std::max(0.f, ant->m_life - 10.f);
 }
 
 void Ant::take()
@@ -147,10 +203,18 @@ DemoAnt::DemoAnt(const long id, Vector2f position) : Ant(id, position) {}
 
 void DemoAnt::update()
 {
+    // Chargée, elle remonte la piste du nid, sinon celle de la nourriture
+    const PheromoneChannel follow = isCarrying() ? PheromoneChannel::HOME : PheromoneChannel::FOOD;
+
     if(m_rotateCd-- <= 0)
     {
-        m_rotateCd = GetRandomValue(30, 100);
-        m_angle += GetRandomValue(-100, 100) * 0.01f * PI / 4; // Rotation de +- 45°
+        m_rotateCd = m_rng.next_int(30, 100);
+
+        const Vec2f gradient = senseTrail(follow);
+        if(gradient.x != 0.f || gradient.y != 0.f)
+            m_angle = std::atan2(gradient.y, gradient.x) + m_rng.uniform(-1.0, 1.0) * PI / 8;
+        else
+            m_angle += m_rng.uniform(-1.0, 1.0) * PI / 4; // Rotation de +- 45°
         rotate(m_angle);
     }
     
@@ -160,15 +224,16 @@ void DemoAnt::update()
 
     if(isCarrying())
     {
-        if(GetRandomValue(0, 100) == 0)
+        if(m_rng.next_int(0, 100) == 0)
             put();
     }else if(getTileFacing().flags.carriable)
     {
-        if(GetRandomValue(0, 100) == 0)
+        if(m_rng.next_int(0, 100) == 0)
             take();
     }
 
     pheromone(); 
+    trail(isCarrying() ? PheromoneChannel::FOOD : PheromoneChannel::HOME);
 }
 
 void DemoAnt::save(json &json) const
@@ -183,6 +248,18 @@ void DemoAnt::load(const json &json)
     json.at("rotateCd").get_to(m_rotateCd);
 }
 
+void DemoAnt::save(Serializer& s) const
+{
+    Ant::save(s);
+    s.write(static_cast<int32_t>(m_rotateCd));
+}
+
+void DemoAnt::load(Serializer& s)
+{
+    Ant::load(s);
+    m_rotateCd = s.read<int32_t>();
+}
+
 DemoAnt& DemoAnt::operator=(const DemoAnt& ant)
 {
     Ant::operator=(ant);
@@ -191,15 +268,21 @@ DemoAnt& DemoAnt::operator=(const DemoAnt& ant)
 }
 
 // ==================[ANT IA]==================
-RNG gRng;
+RNG simu::gRng;
+
+namespace
+{
+    // Directions dans le sens horaire (l'axe y est vers le bas), en commençant par l'angle 0
+    constexpr SensorDirection CLOCKWISE[4] = {SENSOR_RIGHT, SENSOR_DOWN, SENSOR_LEFT, SENSOR_UP};
+}
 
 AntIA::AntIA(const long id, const AntIA& ant) : Ant(id, ant), m_genome(ant.m_genome), m_network(ant.m_network) {}
-AntIA::AntIA(const long id, Vec2i position): Ant(id),  m_genome(Genome::create_minimal_genome(19, 4, gRng)), m_network(FeedForwardNeuralNetwork::create_from_genome(m_genome)), m_gridPos(position)
+AntIA::AntIA(const long id, Vec2i position): Ant(id),  m_genome(Genome::create_minimal_genome(19, 4, gRng)), m_network(NetworkCache::shared().get(m_genome)), m_gridPos(position)
 {
     m_pos = getWorld().gridToWorld(position);
 }
 
-AntIA::AntIA(const long id, const Genome genome, Vec2i pos) : Ant(id), m_genome(genome), m_network(FeedForwardNeuralNetwork::create_from_genome(genome)), m_gridPos(pos) 
+AntIA::AntIA(const long id, const Genome genome, Vec2i pos) : Ant(id), m_genome(genome), m_network(NetworkCache::shared().get(genome)), m_gridPos(pos) 
 {
     m_pos = getWorld().gridToWorld(pos);
 }
@@ -223,63 +306,63 @@ bool AntIA::move(Vec2i dir)
     return false;
 }
 
-void AntIA::update()
+void AntIA::sense(double* inputs)
 {
     m_pos = getWorld().gridToWorld(m_gridPos);
 
+    const Grid& grid = getWorld().getGrid();
+    const bool valid = grid.isValid(m_gridPos.x, m_gridPos.y);
+    const TileSensors sensors = valid ? grid.sensors()[m_gridPos.y * grid.getGridWidth() + m_gridPos.x] : TileSensors{};
+    const uint8_t around = getSolidAround();
+
     // Variables de décisions
-    const std::vector<double> inputs = {
-    //static_cast<double>(getAngle()), 
-    static_cast<double>(getTileFacing().flags.solid),
-    static_cast<double>(getTileLeft().flags.solid),
-    static_cast<double>(getTileRight().flags.solid),
-    static_cast<double>(getTileBack().flags.solid),
-    static_cast<double>(m_gridPos.x),
-    static_cast<double>(m_gridPos.y),
-    static_cast<double>(isStuck()),
-    static_cast<double>(isIdle()),
-    static_cast<double>(isCurrentPositionVisited()),
-    static_cast<double>(getVisitedPositionsSize()),
-    static_cast<double>(getDistanceToWall(UP)),
-    static_cast<double>(getDistanceToWall(DOWN)),
-    static_cast<double>(getDistanceToWall(LEFT)),
-    static_cast<double>(getDistanceToWall(RIGHT)),
-    static_cast<double>(getLastAction()),
-    static_cast<double>(getDirectionChanges()),
-    static_cast<double>(getRepeatCount()),
-    static_cast<double>(getWallHit()),
-    static_cast<double>(getGoodWallAvoidanceMoves()),
-    };
-/*
-    std::cout << "Inputs: ";
-for (double input : inputs) {
-    std::cout << input << " ";
+    //inputs[] = static_cast<double>(getAngle());
+    inputs[0] = static_cast<double>(around & 1);        // Devant
+    inputs[1] = static_cast<double>((around >> 1) & 1); // Gauche
+    inputs[2] = static_cast<double>((around >> 2) & 1); // Droite
+    inputs[3] = static_cast<double>((around >> 3) & 1); // Derrière
+    inputs[4] = static_cast<double>(m_gridPos.x);
+    inputs[5] = static_cast<double>(m_gridPos.y);
+    inputs[6] = static_cast<double>(isStuck());
+    inputs[7] = static_cast<double>(isIdle());
+    inputs[8] = static_cast<double>(isCurrentPositionVisited());
+    inputs[9] = static_cast<double>(getVisitedPositionsSize());
+    inputs[10] = static_cast<double>(sensors.wallDistance[SENSOR_UP]);
+    inputs[11] = static_cast<double>(sensors.wallDistance[SENSOR_DOWN]);
+    inputs[12] = static_cast<double>(sensors.wallDistance[SENSOR_LEFT]);
+    inputs[13] = static_cast<double>(sensors.wallDistance[SENSOR_RIGHT]);
+    inputs[14] = static_cast<double>(getLastAction());
+    inputs[15] = static_cast<double>(getDirectionChanges());
+    inputs[16] = static_cast<double>(getRepeatCount());
+    inputs[17] = static_cast<double>(getWallHit());
+    inputs[18] = static_cast<double>(getGoodWallAvoidanceMoves());
 }
-std::cout << std::endl;
-*/
 
-    std::vector<double> actions;
-    try
-    {
-       actions = m_network.activate(inputs);
-    }
-    catch(const std::exception& e)
+void AntIA::setActions(const double* outputs)
+{
+    std::copy(outputs, outputs + outputCount(), m_actions.begin());
+    m_hasActions = true;
+}
+
+void AntIA::update()
+{
+    // Sans évaluation groupée par le monde, la fourmi évalue son réseau elle-même
+    if(!m_hasActions)
     {
-        std::cerr << e.what() << '\n';
-      //  save(m_genome);
-   //     exit(-1);
+        std::array<double, inputCount()> inputs;
+        sense(inputs.data());
+        m_network.activate(inputs.data(), m_actions.data());
     }
+    m_hasActions = false;
+
+    std::array<double, outputCount()> actions = m_actions;
     
     // Activation des sorties
 
-    // Ajouter du bruit aléatoire aux actions
-    std::random_device rd;  // Générateur aléatoire
-    std::mt19937 gen(rd()); // Mersenne Twister
-    std::uniform_real_distribution<> dis(-0.1, 0.1); // Bruit entre -0.1 et 0.1
-
+    // Ajouter du bruit aléatoire aux actions, entre -0.1 et 0.1
     for (double &action : actions)
     {
-        action += dis(gen); // Ajouter un bruit aléatoire
+        action += m_rng.uniform(-0.1, 0.1);
     }
 
 
@@ -295,17 +378,19 @@ std::cout << std::endl;
 
     //std::cout << "Ant " << getId() << " action: " << direction << std::endl;
 
-    if(getTileFacing().flags.solid || getTileLeft().flags.solid|| getTileRight().flags.solid|| getTileBack().flags.solid)
+    const int wallProximityBefore = getWallProximityBeforeMove();
+    if(wallProximityBefore > 0)
     {
         wallHit++;
     }
 
-    if(getTileOn().type == Type::CHECKPOINT)
+    const Type tileOn = getTileOn().type;
+    if(tileOn == Type::CHECKPOINT)
     {
         numberOfCheckpoints++;
     }
 
-    if (getTileOn().type == Type::FOOD)
+    if (tileOn == Type::FOOD)
     {
         end = true;
     }
@@ -321,9 +406,7 @@ std::cout << std::endl;
     lastAction = direction;
 
     // Ajouter la position actuelle à l'ensemble
-    visitedPositions.insert({static_cast<int>(m_gridPos.x), static_cast<int>(m_gridPos.y)});
-
-    int wallProximityBefore = getWallProximityBeforeMove();
+    visitedPositions.insert(m_gridPos.x, m_gridPos.y, getWorld().getGrid().getGridWidth());
 
     Vec2i lastGridPos = m_gridPos;
 
@@ -337,7 +420,9 @@ std::cout << std::endl;
         default: break;
     }
 
-    int wallProximityAfter = getWallProximityBeforeMove();
+    // L'échantillon d'après est lu sur la case de départ, comme le faisaient getTileFacing et
+    // consorts sur m_pos, qui n'est recalculé qu'au tick suivant.
+    int wallProximityAfter = getWallProximityAt(lastGridPos);
 
     if (wallProximityAfter < wallProximityBefore) {
     goodWallAvoidanceMoves++;
@@ -370,31 +455,57 @@ bool simu::AntIA::isIdle()
 
 bool simu::AntIA::isCurrentPositionVisited()
 {
-    if (visitedPositions.find({static_cast<int>(m_gridPos.x), static_cast<int>(m_gridPos.y)}) != visitedPositions.end()) {
-        return true;
-    }
-    return false;
+    return visitedPositions.contains(m_gridPos.x, m_gridPos.y);
 }
 
 int simu::AntIA::getWallProximityBeforeMove()
 {
-    return getTileFacing().flags.solid + 
-                          getTileLeft().flags.solid + 
-                          getTileRight().flags.solid+ 
-                          getTileBack().flags.solid;
+    return getWallProximityAt(m_gridPos);
 }
 
-double simu::AntIA::getDistanceToWall(Vec2i dir)
+int simu::AntIA::getWallProximityAt(Vec2i tile) const
 {
-    int distance = 0;
-    Vec2i pos = m_gridPos;
+    const uint8_t around = getSolidAround(tile);
+    return (around & 1) + ((around >> 1) & 1) + ((around >> 2) & 1) + ((around >> 3) & 1);
+}
 
-    while (!getWorld().getGrid().getTile(pos).flags.solid) {
-       
-        pos += dir;
-    }
+uint8_t simu::AntIA::getSolidAround() const
+{
+    return getSolidAround(m_gridPos);
+}
 
-    return pos.manhattan(pos);
+uint8_t simu::AntIA::getSolidAround(Vec2i tile) const
+{
+    const Grid& grid = getWorld().getGrid();
+    if(!grid.isValid(tile.x, tile.y))
+        return 0b1111; // Hors de la grille tout est bordure
+
+    // Les voisines suivent l'angle de la fourmi arrondi au quart de tour, comme getTileFacing
+    const int quarter = static_cast<int>(std::lround(m_angle / (PI / 2))) & 3;
+    const uint8_t solid = grid.sensors()[tile.y * grid.getGridWidth() + tile.x].solidNeighbours;
+
+    return ((solid >> CLOCKWISE[quarter]) & 1) |                // Devant
+           (((solid >> CLOCKWISE[(quarter + 3) & 3]) & 1) << 1) | // Gauche
+           (((solid >> CLOCKWISE[(quarter + 1) & 3]) & 1) << 2) | // Droite
+           (((solid >> CLOCKWISE[(quarter + 2) & 3]) & 1) << 3);  // Derrière
+}
+
+double simu::AntIA::getDistanceToWall(Vec2i dir)
+{
+    const Grid& grid = getWorld().getGrid();
+    if(!grid.isValid(m_gridPos.x, m_gridPos.y))
+        return 0.0;
+
+    const TileSensors& sensors = grid.sensors()[m_gridPos.y * grid.getGridWidth() + m_gridPos.x];
+    if(dir == UP)
+        return sensors.wallDistance[SENSOR_UP];
+    if(dir == DOWN)
+        return sensors.wallDistance[SENSOR_DOWN];
+    if(dir == LEFT)
+        return sensors.wallDistance[SENSOR_LEFT];
+    if(dir == RIGHT)
+        return sensors.wallDistance[SENSOR_RIGHT];
+    return 0.0;
 }
 
 
@@ -406,6 +517,38 @@ void AntIA::load(const json &json)
     // TODO: Load genome
 }
 
+/* Le génome est de taille variable : l'enregistrement de la fourmi ne garde que son indice
+ * dans la section des génomes, ce qui laisse les enregistrements de taille fixe. */
+void AntIA::save(Serializer& s) const
+{
+    Ant::save(s);
+
+    s.write(static_cast<int32_t>(m_gridPos.x));
+    s.write(static_cast<int32_t>(m_gridPos.y));
+
+    Serializer& genomes = s.genomes();
+    s.write(genomes.beginRecord());
+    saveGenome(genomes, m_genome);
+    genomes.endRecord();
+}
+
+void AntIA::load(Serializer& s)
+{
+    Ant::load(s);
+
+    // m_pos n'est synchronisée qu'au prochain sense() : la position sur la grille fait foi
+    m_gridPos.x = s.read<int32_t>();
+    m_gridPos.y = s.read<int32_t>();
+
+    Serializer record = s.genomes().record(s.read<uint32_t>());
+    Genome genome = loadGenome(record);
+    if(genome.get_num_inputs() != inputCount() || genome.get_num_outputs() != outputCount())
+        throw std::runtime_error("Impossible de charger la fourmi: génome incompatible");
+
+    m_genome = std::move(genome);
+    m_network = NetworkCache::shared().get(m_genome);
+}
+
 AntIA& AntIA::operator=(const AntIA& ant)
 {
     Ant::operator=(ant);
@@ -2,12 +2,13 @@
 #define __ANT_H__
 
 #include <map>
+#include <array>
 #include <string>
-#include <unordered_set>
 
 #include "types.h"
 #include "entity.h"
 #include "tiles.h"
+#include "visitedTiles.h"
 #include "../NEAT/Utils.h"
 
 #include "../NEAT/Genome.h"
@@ -15,13 +16,8 @@
 
 namespace simu
 {
-
-    struct pair_hash {
-    template <class T1, class T2>
-    std::size_t operator()(const std::pair<T1, T2>& pair) const {
-        return std::hash<T1>()(pair.first) ^ std::hash<T2>()(pair.second);
-    }
-};
+    // Tirages partagés : génomes des fourmis par défaut, populations des niveaux. World::setSeed le recrée.
+    extern RNG gRng;
 
     class Ant : public Entity
     {
@@ -38,25 +34,34 @@ namespace simu
 
             void save(json& json) const override;
             void load(const json& json) override;
+            void save(Serializer& s) const override;
+            void load(Serializer& s) override;
 
             bool isCarrying() const { return m_carried_object.type != Type::AIR; };
             Tile getCarriedObject() const { return m_carried_object; };
 
             float getLife() const { return m_life; };
 
+            // Gradient du canal sur sa tuile, orienté vers la plus forte concentration
+            Vec2f senseTrail(PheromoneChannel channel) const;
+
             // ------ ACTIONS IA -------
             void move(Direction dir);
             void rotate(float angle);  // Définie la direction et le sens de la fourmis en radian
             bool moveForward();        // Se déplace devant elle (en fonction de son angle), renvoie vrai si aucun obstacle ne l'empeche de faire l'action
             void eat();                // Mange sur sa position (si il y a quelque chose)
             void pheromone();          // Pose un phéromone sur sa position
-            void beat();               // Mord l'entité devant elle
+            void trail(PheromoneChannel channel, float amount = 1.f); // Dépose sur le champ continu de phéromones à sa position
+            void beat();               // Mord la fourmis devant elle, modifie une autre entité : pas dans une update parallèle
 
             void take();               // Porte un objet sur elle (nourriture/mur)
             void put();                // Déposer l'objet qu'elle porte
 
             Ant& operator=(const Ant& en);
 
+        protected:
+            FastRNG m_rng; // Flux propre à la fourmi, tiré de la graine du monde et de l'ID : sûr en mise à jour parallèle
+
         private:
             float m_life = 100.0;
             Tile m_carried_object = AIR; 
@@ -78,6 +83,8 @@ namespace simu
             void update() override;
             void save(json& json) const override;
             void load(const json& json) override;
+            void save(Serializer& s) const override;
+            void load(Serializer& s) override;
 
             DemoAnt& operator=(const DemoAnt& en);
 
@@ -99,7 +106,8 @@ namespace simu
 
             const char* getType() const override { return "antIA"; };
             const Genome& getGenome() { return m_genome; };
-            const FeedForwardNeuralNetwork& getNetwork() { return m_network; };
+            const FeedForwardNeuralNetwork& getNetwork() const { return m_network; };
+            FeedForwardNeuralNetwork& getNetwork() { return m_network; };
 
             const Vec2i getGridPos() { return m_gridPos; };
             const int getLastAction() { return lastAction; };
@@ -110,14 +118,14 @@ namespace simu
             const int getNumberOfCheckpoints() { return numberOfCheckpoints; };
             const bool isEnd() { return end; };
 
-            const std::unordered_set<std::pair<int, int>, pair_hash>& getVisitedPositions() { return visitedPositions; };
+            const VisitedTiles& getVisitedPositions() { return visitedPositions; };
             const int getVisitedPositionsSize() { return visitedPositions.size(); };
 
             bool isStuck() ;
             bool isIdle();
             bool isCurrentPositionVisited();
             int getWallProximityBeforeMove();
-            double getDistanceToWall(Vec2i dir);
+            double getDistanceToWall(Vec2i dir); // Nombre de pas jusqu'au premier mur, lu dans Grid::sensors
 
             double getFitness() { return fitness; };
             double setFitness(double fit) { fitness = fit; return fitness; };
@@ -128,15 +136,37 @@ namespace simu
             bool move(Vec2i dir);
             void setPos(Vec2i pos) { m_gridPos = pos; };
 
+            /**
+             * @brief Remplit les inputCount() entrées du réseau à partir de l'état courant de la fourmis.
+             * Les murs sont lus dans les capteurs précalculés de la grille, sans allocation.
+             */
+            void sense(double* inputs);
+
+            /**
+             * @brief Fournit les outputCount() sorties du réseau déjà évaluées (évaluation groupée).
+             * Le prochain update() les utilise au lieu d'activer le réseau.
+             */
+            void setActions(const double* outputs);
+
             void update() override;
+            bool isThreadSafe() const override { return true; };
             void save(json& json) const override;
             void load(const json& json) override;
+            void save(Serializer& s) const override;
+            void load(Serializer& s) override;
 
             AntIA& operator=(const AntIA& en);
 
         private:
+            // Solidité des cases devant, à gauche, à droite et derrière, dans cet ordre (bits 0 à 3)
+            uint8_t getSolidAround() const;
+            uint8_t getSolidAround(Vec2i tile) const;
+            int getWallProximityAt(Vec2i tile) const;
+
             Genome m_genome;
             FeedForwardNeuralNetwork m_network;
+            std::array<double, 4> m_actions = {}; // outputCount() sorties
+            bool m_hasActions = false;
             double fitness = 0.0;
             Vec2i m_dir;
             Vec2i m_gridPos;
@@ -152,7 +182,7 @@ namespace simu
             bool end = false;
             
 
-            std::unordered_set<std::pair<int, int>, simu::pair_hash> visitedPositions;
+            VisitedTiles visitedPositions;
 
     };
 
@@ -0,0 +1,360 @@
+#include "checkpoint.h"
+
+#include <filesystem>
+#include <iostream>
+#include <unordered_map>
+
+using namespace simu;
+
+void simu::saveGenome(Serializer& s, const Genome& genome)
+{
+    const auto& neurons = genome.get_neurons();
+    const auto& links = genome.get_links();
+
+    s.write(static_cast<int32_t>(genome.get_genome_id()));
+    s.write(static_cast<int32_t>(genome.get_num_inputs()));
+    s.write(static_cast<int32_t>(genome.get_num_outputs()));
+    s.write(static_cast<uint32_t>(neurons.size()));
+    s.write(static_cast<uint32_t>(links.size()));
+
+    for(const neat::NeuronGene& neuron : neurons)
+    {
+        s.write(static_cast<int32_t>(neuron.neuron_id));
+        s.write(neuron.bias);
+        s.write(static_cast<uint8_t>(neuron.activation.get_type()));
+    }
+
+    for(const neat::LinkGene& link : links)
+    {
+        s.write(static_cast<int32_t>(link.link_id.input_id));
+        s.write(static_cast<int32_t>(link.link_id.output_id));
+        s.write(link.weight);
+        s.write(static_cast<uint8_t>(link.is_enabled));
+        s.write(static_cast<int32_t>(link.innovation_number));
+    }
+}
+
+Genome simu::loadGenome(Serializer& s)
+{
+    const int id = s.read<int32_t>();
+    const int inputs = s.read<int32_t>();
+    const int outputs = s.read<int32_t>();
+    const uint32_t neuronCount = s.read<uint32_t>();
+    const uint32_t linkCount = s.read<uint32_t>();
+
+    Genome genome(id, inputs, outputs);
+    for(uint32_t i = 0; i < neuronCount; i++)
+    {
+        neat::NeuronGene neuron;
+        neuron.neuron_id = s.read<int32_t>();
+        neuron.bias = s.read<double>();
+
+        const uint8_t activation = s.read<uint8_t>();
+        if(activation > static_cast<uint8_t>(Activation::Type::ReLU))
+            throw std::runtime_error("Impossible de charger le génome: activation inconnue");
+        neuron.activation = Activation(static_cast<Activation::Type>(activation));
+        genome.add_neuron(neuron);
+    }
+
+    for(uint32_t i = 0; i < linkCount; i++)
+    {
+        neat::LinkGene link;
+        link.link_id.input_id = s.read<int32_t>();
+        link.link_id.output_id = s.read<int32_t>();
+        link.weight = s.read<double>();
+        link.is_enabled = s.read<uint8_t>() != 0;
+        link.innovation_number = s.read<int32_t>();
+        genome.add_link(link);
+    }
+
+    return genome;
+}
+
+namespace
+{
+    void writeStats(Serializer& s, const GenerationStats& stats)
+    {
+        s.beginSection(Serializer::STATS);
+        s.write(stats.generation);
+        s.write(stats.average);
+        s.write(stats.max);
+        s.write(stats.min);
+        s.endSection();
+    }
+
+    GenerationStats readStats(Serializer& s)
+    {
+        GenerationStats stats;
+        stats.generation = s.read<uint64_t>();
+        stats.average = s.read<double>();
+        stats.max = s.read<double>();
+        stats.min = s.read<double>();
+        return stats;
+    }
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& file, int compactEvery) : m_file(file), m_compactEvery(compactEvery)
+{
+    size_t valid = 0;
+    if(std::filesystem::exists(m_file))
+    {
+        MappedFile mapped(m_file);
+        valid = Serializer::completeSize(mapped.data(), mapped.size());
+        if(valid == 0 && mapped.size() > 0)
+            throw std::runtime_error("Impossible d'ouvrir le journal " + m_file + ": ce n'est pas un snapshot");
+
+        // Reprend ce que le prochain compactage doit conserver
+        if(valid > 0)
+        {
+            Serializer s(mapped.data(), valid);
+            for(Serializer& stats : s.sections(Serializer::STATS))
+                m_stats.push_back(readStats(stats));
+
+            std::vector<Serializer> checkpoints = s.sections(Serializer::CHECKPOINT);
+            if(!checkpoints.empty())
+            {
+                const size_t size = checkpoints.back().remaining();
+                const uint8_t* data = checkpoints.back().readBytes(size);
+                m_latest.assign(data, data + size);
+            }
+        }
+    }
+
+    if(valid > 0)
+    {
+        // Coupe la génération interrompue par un crash, les sections suivantes commencent sur 8 octets
+        std::filesystem::resize_file(m_file, (valid + 7) & ~size_t(7));
+        open();
+    }
+    else
+        compact(); // Journal vide : en-tête seul
+
+    m_thread = std::thread(&CheckpointWriter::run, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+}
+
+void CheckpointWriter::push(const CheckpointView& checkpoint, const GenerationStats& stats)
+{
+    Serializer s(Serializer::VERSION);
+    s.write(checkpoint.generation);
+    s.write(checkpoint.runSeed);
+    s.write(checkpoint.population.seed);
+    s.write(checkpoint.population.generation);
+    s.write(static_cast<int32_t>(checkpoint.population.next_genome_id));
+    s.write(static_cast<int32_t>(checkpoint.population.next_species_id));
+    s.write(checkpoint.rngKey);
+    s.write(checkpoint.rngCounter);
+
+    s.write(static_cast<uint32_t>(checkpoint.individuals.size()));
+    for(const CheckpointView::Individual& individual : checkpoint.individuals)
+    {
+        s.write(individual.fitness);
+        s.write(static_cast<uint8_t>(individual.fitness_computed));
+        saveGenome(s, *individual.genome);
+    }
+
+    // Les membres d'une espèce sont des individus : seul leur identifiant est écrit
+    const uint32_t speciesCount = checkpoint.species ? checkpoint.species->size() : 0;
+    s.write(speciesCount);
+    for(uint32_t i = 0; i < speciesCount; i++)
+    {
+        const Species& species = (*checkpoint.species)[i];
+        s.write(static_cast<int32_t>(species.id));
+        saveGenome(s, species.representative);
+        s.write(static_cast<uint32_t>(species.members.size()));
+        for(const std::shared_ptr<Genome>& member : species.members)
+            s.write(static_cast<int32_t>(member->get_genome_id()));
+    }
+
+    Entry entry;
+    entry.checkpoint.assign(s.getBuffer().begin() + Serializer::HEADER_SIZE, s.getBuffer().end());
+    entry.stats = stats;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(std::move(entry));
+    }
+    m_wake.notify_one();
+}
+
+void CheckpointWriter::push(const TrainingCheckpoint& checkpoint, const GenerationStats& stats)
+{
+    CheckpointView view;
+    view.generation = checkpoint.generation;
+    view.runSeed = checkpoint.runSeed;
+    view.population = checkpoint.population;
+    view.rngKey = checkpoint.rngKey;
+    view.rngCounter = checkpoint.rngCounter;
+    view.species = &checkpoint.species;
+
+    view.individuals.reserve(checkpoint.individuals.size());
+    for(const neat::Individual& individual : checkpoint.individuals)
+        view.individuals.push_back({individual.genome.get(), individual.fitness, individual.fitness_computed});
+
+    push(view, stats);
+}
+
+void CheckpointWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_queue.empty() && !m_busy; });
+}
+
+void CheckpointWriter::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while(true)
+    {
+        m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+        if(m_queue.empty()) // m_stop et plus rien à écrire
+            break;
+
+        Entry entry = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_busy = true;
+        lock.unlock();
+
+        try
+        {
+            append(entry);
+        } catch(const std::runtime_error& e)
+        {
+            std::cerr << "Checkpoint de la génération " << entry.stats.generation << " perdu: " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        m_busy = false;
+        if(m_queue.empty())
+            m_idle.notify_all();
+    }
+}
+
+void CheckpointWriter::append(const Entry& entry)
+{
+    m_latest = entry.checkpoint;
+    m_stats.push_back(entry.stats);
+
+    if(++m_sinceCompaction >= m_compactEvery)
+    {
+        compact();
+        return;
+    }
+
+    Serializer s(Serializer::VERSION);
+    s.beginSection(Serializer::CHECKPOINT);
+    s.writeBytes(m_latest.data(), m_latest.size());
+    s.endSection();
+    writeStats(s, entry.stats);
+
+    const std::vector<uint8_t>& buffer = s.getBuffer();
+    m_out.write(reinterpret_cast<const char*>(buffer.data()) + Serializer::HEADER_SIZE, buffer.size() - Serializer::HEADER_SIZE);
+    m_out.flush();
+    if(!m_out)
+        throw std::runtime_error("Impossible d'écrire dans " + m_file);
+}
+
+void CheckpointWriter::compact()
+{
+    Serializer s(Serializer::VERSION);
+    for(const GenerationStats& stats : m_stats)
+        writeStats(s, stats);
+
+    if(!m_latest.empty())
+    {
+        s.beginSection(Serializer::CHECKPOINT);
+        s.writeBytes(m_latest.data(), m_latest.size());
+        s.endSection();
+    }
+
+    m_out.close();
+    s.writeFile(m_file);
+    m_sinceCompaction = 0;
+    open();
+}
+
+void CheckpointWriter::open()
+{
+    m_out.close();
+    m_out.clear();
+    m_out.open(m_file, std::ios_base::out | std::ios_base::binary | std::ios_base::app);
+    if(!m_out)
+        throw std::runtime_error("Impossible d'ouvrir le journal " + m_file);
+}
+
+bool simu::loadCheckpoint(const std::string& file, TrainingCheckpoint& checkpoint)
+{
+    if(!std::filesystem::exists(file))
+    {
+        // Compactage interrompu avant le renommage du fichier temporaire
+        if(std::filesystem::exists(file + ".tmp"))
+            return loadCheckpoint(file + ".tmp", checkpoint);
+        return false;
+    }
+
+    MappedFile mapped(file);
+    if(mapped.size() == 0)
+        return false;
+
+    const size_t valid = Serializer::completeSize(mapped.data(), mapped.size());
+    if(valid == 0)
+        throw std::runtime_error("Impossible de charger le journal " + file + ": ce n'est pas un snapshot");
+
+    Serializer journal(mapped.data(), valid);
+    std::vector<Serializer> checkpoints = journal.sections(Serializer::CHECKPOINT);
+    if(checkpoints.empty())
+        return false;
+
+    Serializer& s = checkpoints.back();
+    TrainingCheckpoint loaded;
+    loaded.generation = s.read<uint64_t>();
+    loaded.runSeed = s.read<uint64_t>();
+    loaded.population.seed = s.read<uint64_t>();
+    loaded.population.generation = s.read<uint64_t>();
+    loaded.population.next_genome_id = s.read<int32_t>();
+    loaded.population.next_species_id = s.read<int32_t>();
+    loaded.rngKey = s.read<uint64_t>();
+    loaded.rngCounter = s.read<uint64_t>();
+
+    std::unordered_map<int, std::shared_ptr<Genome>> genomes;
+    const uint32_t individuals = s.read<uint32_t>();
+    for(uint32_t i = 0; i < individuals; i++)
+    {
+        neat::Individual individual;
+        individual.fitness = s.read<double>();
+        individual.fitness_computed = s.read<uint8_t>() != 0;
+        individual.genome = std::make_shared<Genome>(loadGenome(s));
+        genomes[individual.genome->get_genome_id()] = individual.genome;
+        loaded.individuals.push_back(std::move(individual));
+    }
+
+    const uint32_t species = s.read<uint32_t>();
+    for(uint32_t i = 0; i < species; i++)
+    {
+        const int id = s.read<int32_t>();
+        loaded.species.emplace_back(id, loadGenome(s));
+
+        const uint32_t members = s.read<uint32_t>();
+        for(uint32_t m = 0; m < members; m++)
+        {
+            auto it = genomes.find(s.read<int32_t>());
+            if(it == genomes.end())
+                throw std::runtime_error("Impossible de charger le journal " + file + ": membre d'espèce inconnu");
+            loaded.species.back().add_member(it->second); // Partagé avec l'individu, comme SpeciesIndex
+        }
+    }
+
+    for(Serializer& stats : journal.sections(Serializer::STATS))
+        loaded.history.push_back(readStats(stats));
+
+    checkpoint = std::move(loaded);
+    return true;
+}
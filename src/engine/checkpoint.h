@@ -0,0 +1,149 @@
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+
+#include "serializer.h"
+#include "../NEAT/population.h"
+
+namespace simu
+{
+    /**
+     * @brief Enregistrement binaire d'un génome : identifiant, entrées, sorties, neurones puis liens.
+     */
+    void saveGenome(Serializer& s, const Genome& genome);
+
+    /**
+     * @throw std::runtime_error si l'enregistrement est tronqué ou corrompu.
+     */
+    Genome loadGenome(Serializer& s);
+
+    struct GenerationStats
+    {
+        uint64_t generation;
+        double average;
+        double max;
+        double min;
+    };
+
+    /**
+     * @brief État d'un entraînement NEAT à la fin d'une génération évaluée, avant la reproduction.
+     * La reproduction ne dépend que de cet état : reprendre depuis un checkpoint redonne la même génération suivante.
+     */
+    struct TrainingCheckpoint
+    {
+        uint64_t generation = 0;                    // Génération du niveau
+        uint64_t runSeed = 0;                       // Graine du monde
+        Population::State population = {};
+        uint64_t rngKey = 0;                        // Flux partagé du niveau (voir RNG::get_key)
+        uint64_t rngCounter = 0;
+        std::vector<neat::Individual> individuals;  // Génomes évalués et leur fitness
+        std::vector<Species> species;
+        std::vector<GenerationStats> history;       // Toutes les générations du journal, rempli par loadCheckpoint
+    };
+
+    /**
+     * @brief Génération à journaliser sans copie : génomes et espèces restent ceux du niveau, CheckpointWriter::push
+     * les sérialise sur le thread appelant avant de rendre la main.
+     */
+    struct CheckpointView
+    {
+        struct Individual
+        {
+            const Genome* genome;
+            double fitness;
+            bool fitness_computed;
+        };
+
+        uint64_t generation = 0;
+        uint64_t runSeed = 0;
+        Population::State population = {};
+        uint64_t rngKey = 0;
+        uint64_t rngCounter = 0;
+        std::vector<Individual> individuals;
+        const std::vector<Species>* species = nullptr;
+    };
+
+    /**
+     * @brief Journal des générations d'un entraînement, écrit par un thread dédié.
+     *
+     * Chaque génération est ajoutée à la fin du fichier (une section CHECKPOINT et une section STATS d'un snapshot,
+     * voir Serializer) : la boucle de simulation ne fait que sérialiser la génération, l'écriture se fait en arrière-plan.
+     * Un crash en cours d'écriture ne coûte que la dernière génération. Toutes les compactEvery générations, le journal
+     * est réécrit en un snapshot complet ne gardant que la dernière génération et les statistiques de toutes les autres.
+     */
+    class CheckpointWriter
+    {
+        public:
+            /**
+             * @param file Journal, créé s'il n'existe pas. Sinon les générations sont ajoutées à la suite et une fin
+             * tronquée par un crash est coupée.
+             * @param compactEvery Nombre de générations ajoutées entre deux compactages.
+             * @throw std::runtime_error si le fichier existe mais n'est pas un journal valide.
+             */
+            CheckpointWriter(const std::string& file, int compactEvery = 50);
+
+            /**
+             * @brief Termine les écritures en attente.
+             */
+            ~CheckpointWriter();
+
+            CheckpointWriter(const CheckpointWriter&) = delete;
+            CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+            /**
+             * @brief Sérialise la génération et la met en file d'écriture, ne bloque pas sur le disque.
+             */
+            void push(const CheckpointView& checkpoint, const GenerationStats& stats);
+            void push(const TrainingCheckpoint& checkpoint, const GenerationStats& stats);
+
+            /**
+             * @brief Attend que toutes les générations en file soient écrites.
+             */
+            void flush();
+
+        private:
+            struct Entry
+            {
+                std::vector<uint8_t> checkpoint;    // Contenu de la section CHECKPOINT
+                GenerationStats stats;
+            };
+
+            void run();
+            void append(const Entry& entry);
+            void compact();
+            void open();
+
+            const std::string m_file;
+            const int m_compactEvery;
+
+            // Utilisés par le thread d'écriture seulement
+            std::ofstream m_out;
+            std::vector<uint8_t> m_latest;
+            std::vector<GenerationStats> m_stats;
+            int m_sinceCompaction = 0;
+
+            std::thread m_thread;
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::condition_variable m_idle;
+            std::deque<Entry> m_queue;
+            bool m_busy = false;
+            bool m_stop = false;
+    };
+
+    /**
+     * @brief Charge la dernière génération complète d'un journal écrit par CheckpointWriter.
+     * @return false si le fichier n'existe pas ou ne contient encore aucune génération.
+     * @throw std::runtime_error si le fichier n'est pas un journal valide.
+     */
+    bool loadCheckpoint(const std::string& file, TrainingCheckpoint& checkpoint);
+}
+
+#endif
@@ -1,11 +1,13 @@
 #include "engine.h"
 #include "utils.h"
 
+#ifndef SIMU_HEADLESS
 #define RAYGUI_IMPLEMENTATION
 #include "raygui.h"
 
 #include "../external/ui/imgui.h"
 #include "../external/ui/rlImGui.h"
+#endif
 #include <chrono>
 
 #define MIN(a, b) a > b ? b : a
@@ -17,6 +19,7 @@ Engine::Engine() : m_tickPeriod(1.0/100.0), m_framePeriod(1.0/60.0)
     m_camera.zoom = 1.f;
 }
 
+#ifndef SIMU_HEADLESS
 int Engine::run(int screenWidth, int screenHeight, std::string title)
 {
     double lastUpdateTime = 0;
@@ -150,6 +153,45 @@ int Engine::run(int screenWidth, int screenHeight, std::string title)
     CloseWindow();
     return 0;
 }
+#else
+int Engine::run(int screenWidth, int screenHeight, std::string title)
+{
+    init();
+    return runHeadless([]() { return false; });
+}
+
+int Engine::runHeadless(const std::function<bool()>& shouldStop)
+{
+    using clock = std::chrono::steady_clock;
+    constexpr std::chrono::seconds reportPeriod(5);
+
+    auto lastReport = clock::now();
+    long tickCounter = 0;
+
+    while(!shouldStop())
+    {
+        m_profiler.begin("tick");
+        updateTick();
+        m_profiler.end();
+
+        tickCounter++;
+
+        auto now = clock::now();
+        if(now - lastReport >= reportPeriod)
+        {
+            double elapsed = std::chrono::duration<double>(now - lastReport).count();
+            TraceLog(LOG_INFO, "TPS: %d | Tick: %.3lf ms", static_cast<int>(tickCounter / elapsed), 
+                m_profiler["tick"]->calculAverage().count() * 1000.0);
+
+            lastReport = now;
+            tickCounter = 0;
+        }
+    }
+
+    unload();
+    return 0;
+}
+#endif
 
 void Engine::setFPS(float fps)
 {
@@ -173,6 +215,7 @@ void Engine::setTPS(float tps)
     this->m_tickPeriod = 1.0 / static_cast<double>(tps);
 }
 
+#ifndef SIMU_HEADLESS
 void Engine::drawAll()
 {
     BeginTextureMode(m_renderer);
@@ -186,6 +229,8 @@ void Engine::drawAll()
     EndTextureMode();
 }
 
+#endif
+
 void Engine::updateTick()
 {
 }
@@ -203,6 +248,7 @@ void Engine::drawUI()
 {
 }
 
+#ifndef SIMU_HEADLESS
 void Engine::updateUI()
 {
     if(IsWindowResized())
@@ -268,3 +314,4 @@ void Engine::updateUI()
 
     EndTextureMode();
 }
+#endif
@@ -5,6 +5,7 @@
 
 #include "raylib.h"
 #include <string>
+#include <functional>
 
 #include "profiling.h"
 
@@ -19,6 +20,15 @@ namespace simu
             
             int run(int screenWidth, int screenHeight, std::string title);
 
+#ifdef SIMU_HEADLESS
+            /**
+             * @brief Exécute la simulation sans fenêtre ni rendu, aussi vite que le CPU le permet.
+             * init() doit avoir été appelé au préalable, unload() est appelé à la fin.
+             * @param shouldStop Évalué avant chaque tick, la boucle s'arrête quand il renvoie vrai.
+             */
+            int runHeadless(const std::function<bool()>& shouldStop);
+#endif
+
             void setTPS(float tps);
             void setFPS(float fps);
 
@@ -120,6 +120,24 @@ void Entity::load(const json &j)
     j.at("angle").get_to(m_angle);
 }
 
+void Entity::save(Serializer& s) const
+{
+    s.write(m_pos.x);
+    s.write(m_pos.y);
+    s.write(m_velocity.x);
+    s.write(m_velocity.y);
+    s.write(m_angle);
+}
+
+void Entity::load(Serializer& s)
+{
+    m_pos.x = s.read<float>();
+    m_pos.y = s.read<float>();
+    m_velocity.x = s.read<float>();
+    m_velocity.y = s.read<float>();
+    m_angle = s.read<float>();
+}
+
 std::ostream& simu::operator<<(std::ostream& os, Entity& entity)
 {
     os << entity.toString();
@@ -10,13 +10,14 @@
 #include "raylib.h"
 #include "tiles.h"
 #include "types.h"
+#include "serializer.h"
 #include "variant"
 
 using json = nlohmann::json;
 
 namespace simu
 {
-    class Entity
+    class Entity : public Serializable
     {
         public:
             friend class World;
@@ -30,8 +31,21 @@ namespace simu
             virtual void update() {};
             virtual void draw() {};
 
+            /**
+             * @brief Indique si update() peut être exécuté en parallèle des autres entités.
+             * Un tel update ne doit que lire la grille et modifier l'état de son entité : ses setTile sont différés
+             * et il ne doit ni ajouter ni supprimer d'entité ni utiliser de générateur aléatoire partagé.
+             */
+            virtual bool isThreadSafe() const { return false; };
+
             virtual void save(json& json) const;
             virtual void load(const json& json);
+
+            /** @brief Enregistrement binaire de taille fixe par type (voir World::save) :
+             *  une classe qui redéfinit la paire json redéfinit aussi celle-ci.
+             */
+            void save(Serializer& s) const override;
+            void load(Serializer& s) override;
         
             friend void to_json(json& j, const Entity& p) { p.save(j); };
             friend void from_json(const json& j, Entity& p) { p.load(j); };
@@ -64,7 +78,7 @@ namespace simu
             Entity& operator=(const Entity& en);
 
         private:
-            const unsigned long m_id;
+            unsigned long m_id; // Non const : les pools reconstruisent les entités en place
         protected:
             Vec2f m_pos = Vector2{0.f, 0.f};
             Vec2f m_velocity = Vector2{0.f, 0.f};
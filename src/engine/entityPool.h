@@ -0,0 +1,344 @@
+#ifndef __ENTITY_POOL_H__
+#define __ENTITY_POOL_H__
+
+#include <vector>
+#include <memory>
+#include <new>
+#include <cstdint>
+#include <type_traits>
+
+#include "entity.h"
+
+namespace simu
+{
+    class EntityPoolBase;
+
+    /**
+     * @brief Référence faible vers une entité d'un pool, remplace std::weak_ptr.
+     * Le handle expire quand l'entité est supprimée : son emplacement change de génération.
+     * lock() renvoie un pointeur brut, valide jusqu'au prochain ajout ou suppression d'entité.
+     */
+    template<class T>
+    class EntityHandle
+    {
+        public:
+            EntityHandle() = default;
+            EntityHandle(EntityPoolBase* pool, uint32_t slot, uint32_t generation) :
+                m_pool(pool), m_slot(slot), m_generation(generation) {};
+
+            // Conversion vers un handle d'une classe mère (EntityHandle<AntIA> vers EntityHandle<Entity>)
+            template<class U, class = std::enable_if_t<std::is_base_of<T, U>::value>>
+            EntityHandle(const EntityHandle<U>& handle) :
+                m_pool(handle.m_pool), m_slot(handle.m_slot), m_generation(handle.m_generation) {};
+
+            inline T* lock() const;
+
+            bool expired() const { return lock() == nullptr; };
+            void reset() { m_pool = nullptr; };
+
+            EntityPoolBase* getPool() const { return m_pool; };
+
+            /** @brief Convertit un handle vers une classe mère en handle vers T, sans vérification :
+             *  l'entité désignée doit être un T.
+             */
+            template<class U>
+            static EntityHandle<T> staticCast(const EntityHandle<U>& handle)
+            {
+                return EntityHandle<T>(handle.m_pool, handle.m_slot, handle.m_generation);
+            }
+
+        private:
+            template<class U> friend class EntityHandle;
+            friend class EntityPoolBase;
+
+            EntityPoolBase* m_pool = nullptr;
+            uint32_t m_slot = 0;
+            uint32_t m_generation = 0;
+    };
+
+    /**
+     * @brief Partie commune aux pools : table des emplacements (slot map) et accès virtuels par pool,
+     * jamais par entité.
+     */
+    class EntityPoolBase
+    {
+        public:
+            virtual ~EntityPoolBase() {};
+
+            // Nombre d'entités du pool (hors ajouts différés)
+            virtual size_t size() const = 0;
+            virtual Entity& at(size_t index) = 0;
+
+            // Met à jour les entités [begin, end) par appel statique
+            virtual void update(size_t begin, size_t end) = 0;
+            virtual void draw() = 0;
+
+            // Vrai si le type du pool peut être mis à jour en parallèle (voir Entity::isThreadSafe)
+            virtual bool isThreadSafe() const = 0;
+
+            /** @brief Supprime l'entité à l'indice index (< size()) en déplaçant la dernière à sa place.
+             *  Les ajouts différés gardent leur emplacement.
+             */
+            virtual void remove(size_t index) = 0;
+
+            /** @brief Supprime en une fois les entités des emplacements slots (voir erase).
+             *  Au delà d'un quart du pool, le tableau est compacté en une seule passe qui garde l'ordre
+             *  des survivants, sinon chaque entité est remplacée par la dernière.
+             *  Les emplacements libres ou d'ajouts encore différés sont ignorés.
+             */
+            virtual void removeSlots(const std::vector<uint32_t>& slots) = 0;
+            virtual void clear() = 0;
+
+            /** @brief Supprime l'entité désignée par handle.
+             *  @return Faux si le handle a expiré, désigne un autre pool ou un ajout encore différé.
+             */
+            template<class T>
+            bool erase(const EntityHandle<T>& handle)
+            {
+                if(handle.m_pool != this || get(handle.m_slot, handle.m_generation) == nullptr ||
+                   m_slots[handle.m_slot].index >= size())
+                    return false;
+
+                remove(m_slots[handle.m_slot].index);
+                return true;
+            }
+
+            // Emplacement désigné par handle, UINT32_MAX dans les mêmes cas qu'erase
+            template<class T>
+            uint32_t slotOf(const EntityHandle<T>& handle)
+            {
+                if(handle.m_pool != this || get(handle.m_slot, handle.m_generation) == nullptr ||
+                   m_slots[handle.m_slot].index >= size())
+                    return FREE;
+                return handle.m_slot;
+            }
+
+            /** @brief Intègre au pool les entités ajoutées pendant la mise à jour.
+             *  @return Vrai si des entités ont été intégrées.
+             */
+            virtual bool flush() = 0;
+
+            // Entité désignée par un handle, nullptr si elle n'existe plus
+            Entity* get(uint32_t slot, uint32_t generation)
+            {
+                if(slot >= m_slots.size() || m_slots[slot].generation != generation || m_slots[slot].index == FREE)
+                    return nullptr;
+                return &entityAt(m_slots[slot].index);
+            }
+
+            // Handle vers l'entité à l'indice index
+            template<class T>
+            EntityHandle<T> handle(size_t index)
+            {
+                const uint32_t slot = m_indexSlots[index];
+                return EntityHandle<T>(this, slot, m_slots[slot].generation);
+            }
+
+        protected:
+            static constexpr uint32_t FREE = UINT32_MAX;
+
+            struct Slot
+            {
+                uint32_t index;         // Indice de l'entité dans le pool, FREE si l'emplacement est libre
+                uint32_t generation;    // Incrémentée à chaque libération, invalide les anciens handles
+            };
+
+            // Entité à l'indice index, ajouts différés compris
+            virtual Entity& entityAt(size_t index) = 0;
+
+            uint32_t acquireSlot(uint32_t index)
+            {
+                uint32_t slot;
+                if(m_freeSlots.empty())
+                {
+                    slot = m_slots.size();
+                    m_slots.push_back(Slot{index, 0});
+                }
+                else
+                {
+                    slot = m_freeSlots.back();
+                    m_freeSlots.pop_back();
+                    m_slots[slot].index = index;
+                }
+                m_indexSlots.push_back(slot);
+                return slot;
+            }
+
+            void releaseSlot(uint32_t slot)
+            {
+                m_slots[slot].index = FREE;
+                m_slots[slot].generation++;
+                m_freeSlots.push_back(slot);
+            }
+
+            std::vector<Slot> m_slots;
+            std::vector<uint32_t> m_freeSlots;
+            std::vector<uint32_t> m_indexSlots; // Emplacement de chaque entité, indexé comme le pool
+    };
+
+    /**
+     * @brief Stockage contigu des entités d'un seul type concret T.
+     * Les entités sont mises à jour et dessinées sans appel virtuel, la suppression déplace la dernière
+     * entité dans le trou (swap and pop). Les ajouts faits pendant une mise à jour sont différés
+     * jusqu'à flush() pour ne pas réallouer le tableau sous l'entité en cours d'update.
+     */
+    template<class T>
+    class EntityPool : public EntityPoolBase
+    {
+        public:
+            /** @brief Construit une entité T(args...) dans le pool.
+             *  @param deferred Ajoute l'entité à la file des ajouts différés.
+             */
+            template<class... Args>
+            EntityHandle<T> emplace(bool deferred, Args&&... args)
+            {
+                const uint32_t index = m_items.size() + m_pending.size();
+                if(deferred || !m_pending.empty())
+                    m_pending.emplace_back(std::forward<Args>(args)...);
+                else
+                    m_items.emplace_back(std::forward<Args>(args)...);
+
+                const uint32_t slot = acquireSlot(index);
+                return EntityHandle<T>(this, slot, m_slots[slot].generation);
+            }
+
+            void reserve(size_t count)
+            {
+                m_items.reserve(m_items.size() + count);
+                m_indexSlots.reserve(m_indexSlots.size() + count);
+            };
+
+            size_t size() const override { return m_items.size(); };
+            T& at(size_t index) override { return m_items[index]; };
+
+            std::vector<T>& getEntities() { return m_items; };
+
+            void update(size_t begin, size_t end) override
+            {
+                for(size_t i = begin; i < end; i++)
+                    m_items[i].T::update();
+            }
+
+            void draw() override
+            {
+                for(T& entity : m_items)
+                    entity.T::draw();
+            }
+
+            bool isThreadSafe() const override
+            {
+                return !m_items.empty() && m_items.front().T::isThreadSafe();
+            }
+
+            void remove(size_t index) override
+            {
+                releaseSlot(m_indexSlots[index]);
+
+                const size_t last = m_items.size() - 1;
+                if(index != last)
+                    relocate(last, index);
+
+                m_items.pop_back();
+                dropIndexSlots(last, 1);
+            }
+
+            void removeSlots(const std::vector<uint32_t>& slots) override
+            {
+                if(slots.size() * 4 < m_items.size())
+                {
+                    for(uint32_t slot : slots)
+                    {
+                        if(slot < m_slots.size() && m_slots[slot].index < m_items.size())
+                            remove(m_slots[slot].index);
+                    }
+                    return;
+                }
+
+                m_removed.assign(m_items.size(), false);
+                for(uint32_t slot : slots)
+                {
+                    if(slot < m_slots.size() && m_slots[slot].index < m_items.size())
+                    {
+                        m_removed[m_slots[slot].index] = true;
+                        releaseSlot(slot);
+                    }
+                }
+
+                size_t kept = 0;
+                for(size_t i = 0; i < m_items.size(); i++)
+                {
+                    if(m_removed[i])
+                        continue;
+                    if(kept != i)
+                        relocate(i, kept);
+                    kept++;
+                }
+
+                const size_t removed = m_items.size() - kept;
+                while(m_items.size() > kept)
+                    m_items.pop_back();
+                dropIndexSlots(kept, removed);
+            }
+
+            void clear() override
+            {
+                for(uint32_t slot : m_indexSlots)
+                    releaseSlot(slot);
+
+                m_items.clear();
+                m_pending.clear();
+                m_indexSlots.clear();
+            }
+
+            bool flush() override
+            {
+                if(m_pending.empty())
+                    return false;
+
+                m_items.reserve(m_items.size() + m_pending.size());
+                for(T& entity : m_pending)
+                    m_items.push_back(std::move(entity));
+                m_pending.clear();
+                return true;
+            }
+
+        protected:
+            Entity& entityAt(size_t index) override
+            {
+                return index < m_items.size() ? m_items[index] : m_pending[index - m_items.size()];
+            }
+
+        private:
+            // Déplace l'entité from à l'indice to (dont l'entité est détruite) et met à jour son emplacement.
+            // Les opérateurs = des entités ne copient pas tout leur état : on reconstruit à la place
+            void relocate(size_t from, size_t to)
+            {
+                std::destroy_at(&m_items[to]);
+                ::new (static_cast<void*>(&m_items[to])) T(std::move(m_items[from]));
+
+                m_indexSlots[to] = m_indexSlots[from];
+                m_slots[m_indexSlots[to]].index = to;
+            }
+
+            // Retire count entrées de m_indexSlots à partir de first (fin de m_items) : les ajouts différés
+            // qui suivent descendent d'autant
+            void dropIndexSlots(size_t first, size_t count)
+            {
+                m_indexSlots.erase(m_indexSlots.begin() + first, m_indexSlots.begin() + first + count);
+                for(size_t i = first; i < m_indexSlots.size(); i++)
+                    m_slots[m_indexSlots[i]].index = i;
+            }
+
+            std::vector<T> m_items;
+            std::vector<T> m_pending;
+            std::vector<bool> m_removed;
+    };
+
+    template<class T>
+    T* EntityHandle<T>::lock() const
+    {
+        return m_pool ? static_cast<T*>(m_pool->get(m_slot, m_generation)) : nullptr;
+    }
+}
+
+#endif
@@ -0,0 +1,390 @@
+#include "hpa.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace simu;
+
+ClusterGraph::ClusterGraph(const Grid& grid) : m_grid(grid), m_gridWidth(grid.getGridWidth())
+{
+    m_clustersPerRow = (m_gridWidth + CLUSTER_SIZE - 1) / CLUSTER_SIZE;
+
+    const int clusterCount = m_clustersPerRow * m_clustersPerRow;
+    m_clusters.resize(clusterCount);
+    m_rightEntrances.resize(clusterCount);
+    m_bottomEntrances.resize(clusterCount);
+
+    for(int c = 0; c < clusterCount; c++)
+    {
+        Cluster& cluster = m_clusters[c];
+        cluster.x0 = (c % m_clustersPerRow) * CLUSTER_SIZE;
+        cluster.y0 = (c / m_clustersPerRow) * CLUSTER_SIZE;
+        cluster.x1 = std::min(cluster.x0 + CLUSTER_SIZE, m_gridWidth) - 1;
+        cluster.y1 = std::min(cluster.y0 + CLUSTER_SIZE, m_gridWidth) - 1;
+        cluster.dirty = false;
+    }
+
+    for(int c = 0; c < clusterCount; c++)
+    {
+        buildBorder(c, true);
+        buildBorder(c, false);
+    }
+
+    for(int c = 0; c < clusterCount; c++)
+        buildCluster(c);
+}
+
+void ClusterGraph::invalidate(int x, int y)
+{
+    const int c = clusterOf(y * m_gridWidth + x);
+    if(!m_clusters[c].dirty)
+    {
+        m_clusters[c].dirty = true;
+        m_dirty.push_back(c);
+    }
+}
+
+size_t ClusterGraph::getNodeCount()
+{
+    update();
+
+    size_t count = 0;
+    for(const Cluster& cluster : m_clusters)
+        count += cluster.nodes.size();
+    return count;
+}
+
+int ClusterGraph::clusterOf(int index) const
+{
+    return (index / m_gridWidth / CLUSTER_SIZE) * m_clustersPerRow + (index % m_gridWidth) / CLUSTER_SIZE;
+}
+
+int ClusterGraph::localIndex(const Cluster& cluster, int index) const
+{
+    return (index / m_gridWidth - cluster.y0) * (cluster.x1 - cluster.x0 + 1) + index % m_gridWidth - cluster.x0;
+}
+
+void ClusterGraph::buildBorder(int c, bool vertical)
+{
+    std::vector<std::pair<int, int>>& entrances = vertical ? m_rightEntrances[c] : m_bottomEntrances[c];
+    entrances.clear();
+
+    const Cluster& cluster = m_clusters[c];
+    if((vertical && c % m_clustersPerRow == m_clustersPerRow - 1) || (!vertical && c / m_clustersPerRow == m_clustersPerRow - 1))
+        return;
+
+    // Case du bord à la position i et sa voisine dans l'autre cluster
+    const int length = vertical ? cluster.y1 - cluster.y0 + 1 : cluster.x1 - cluster.x0 + 1;
+    auto side = [&](int i) { return vertical ? (cluster.y0 + i) * m_gridWidth + cluster.x1 : cluster.y1 * m_gridWidth + cluster.x0 + i; };
+    const int step = vertical ? 1 : m_gridWidth;
+
+    auto isFree = [&](int i) {
+        const int index = side(i);
+        return !m_grid.getTile<false>(Vec2i(index % m_gridWidth, index / m_gridWidth)).flags.solid &&
+               !m_grid.getTile<false>(Vec2i((index + step) % m_gridWidth, (index + step) / m_gridWidth)).flags.solid;
+    };
+
+    // Découpe le bord en passages libres maximaux
+    for(int i = 0; i < length;)
+    {
+        if(!isFree(i))
+        {
+            i++;
+            continue;
+        }
+
+        const int begin = i;
+        while(i < length && isFree(i))
+            i++;
+        const int end = i - 1;
+
+        if(end - begin + 1 > MAX_ENTRANCE_WIDTH)
+        {
+            entrances.emplace_back(side(begin), side(begin) + step);
+            entrances.emplace_back(side(end), side(end) + step);
+        }
+        else
+        {
+            const int middle = (begin + end) / 2;
+            entrances.emplace_back(side(middle), side(middle) + step);
+        }
+    }
+}
+
+void ClusterGraph::buildCluster(int c)
+{
+    Cluster& cluster = m_clusters[c];
+    cluster.crossings.clear();
+    cluster.nodes.clear();
+
+    for(const auto& entrance : m_rightEntrances[c])
+        cluster.crossings.push_back(Crossing{entrance.first, entrance.second});
+    for(const auto& entrance : m_bottomEntrances[c])
+        cluster.crossings.push_back(Crossing{entrance.first, entrance.second});
+    if(c % m_clustersPerRow > 0)
+        for(const auto& entrance : m_rightEntrances[c - 1])
+            cluster.crossings.push_back(Crossing{entrance.second, entrance.first});
+    if(c / m_clustersPerRow > 0)
+        for(const auto& entrance : m_bottomEntrances[c - m_clustersPerRow])
+            cluster.crossings.push_back(Crossing{entrance.second, entrance.first});
+
+    for(const Crossing& crossing : cluster.crossings)
+        cluster.nodes.push_back(crossing.from);
+    std::sort(cluster.nodes.begin(), cluster.nodes.end());
+    cluster.nodes.erase(std::unique(cluster.nodes.begin(), cluster.nodes.end()), cluster.nodes.end());
+
+    const size_t n = cluster.nodes.size();
+    cluster.distances.assign(n * n, -1);
+    for(size_t i = 0; i < n; i++)
+    {
+        search(cluster, cluster.nodes[i]);
+        for(size_t j = 0; j < n; j++)
+            cluster.distances[i * n + j] = m_localDistances[localIndex(cluster, cluster.nodes[j])];
+    }
+}
+
+void ClusterGraph::update()
+{
+    if(m_dirty.empty())
+        return;
+
+    // Les bords du cluster modifié changent aussi les transitions de ses voisins
+    std::vector<int> rebuild;
+    for(int c : m_dirty)
+    {
+        const int cx = c % m_clustersPerRow;
+        const int cy = c / m_clustersPerRow;
+
+        buildBorder(c, true);
+        buildBorder(c, false);
+        rebuild.push_back(c);
+
+        if(cx > 0)
+        {
+            buildBorder(c - 1, true);
+            rebuild.push_back(c - 1);
+        }
+        if(cy > 0)
+        {
+            buildBorder(c - m_clustersPerRow, false);
+            rebuild.push_back(c - m_clustersPerRow);
+        }
+        if(cx < m_clustersPerRow - 1)
+            rebuild.push_back(c + 1);
+        if(cy < m_clustersPerRow - 1)
+            rebuild.push_back(c + m_clustersPerRow);
+
+        m_clusters[c].dirty = false;
+    }
+    m_dirty.clear();
+
+    std::sort(rebuild.begin(), rebuild.end());
+    rebuild.erase(std::unique(rebuild.begin(), rebuild.end()), rebuild.end());
+    for(int c : rebuild)
+        buildCluster(c);
+}
+
+void ClusterGraph::search(const Cluster& cluster, int source)
+{
+    const int width = cluster.x1 - cluster.x0 + 1;
+    const int height = cluster.y1 - cluster.y0 + 1;
+
+    m_localDistances.assign(width * height, -1);
+    m_localParents.assign(width * height, -1);
+    m_queue.clear();
+
+    const int localSource = localIndex(cluster, source);
+    m_localDistances[localSource] = 0;
+    m_queue.push_back(localSource);
+
+    for(size_t head = 0; head < m_queue.size(); head++)
+    {
+        const int local = m_queue[head];
+        const int x = local % width;
+        const int y = local / width;
+
+        const int neighbours[4][2] = {{x, y + 1}, {x + 1, y}, {x - 1, y}, {x, y - 1}};
+        for(const auto& n : neighbours)
+        {
+            if(n[0] < 0 || n[1] < 0 || n[0] >= width || n[1] >= height)
+                continue;
+
+            const int nLocal = n[1] * width + n[0];
+            if(m_localDistances[nLocal] >= 0 || m_grid.getTile<false>(Vec2i(cluster.x0 + n[0], cluster.y0 + n[1])).flags.solid)
+                continue;
+
+            m_localDistances[nLocal] = m_localDistances[local] + 1;
+            m_localParents[nLocal] = local;
+            m_queue.push_back(nLocal);
+        }
+    }
+}
+
+bool ClusterGraph::findPath(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch)
+{
+    update();
+    path.clear();
+
+    if(!m_grid.isValid(start.x, start.y) || !m_grid.isValid(dest.x, dest.y) ||
+        m_grid.getTile<false>(start).flags.solid || m_grid.getTile<false>(dest).flags.solid)
+        return false;
+
+    const uint32_t generation = scratch.begin(m_grid.getTileNumber());
+
+    const int startIndex = start.y * m_gridWidth + start.x;
+    const int destIndex = dest.y * m_gridWidth + dest.x;
+    const int startCluster = clusterOf(startIndex);
+    const int destCluster = clusterOf(destIndex);
+
+    // Ajoute au chemin les cases allant de from (exclue) à la source de la dernière recherche (incluse)
+    auto unroll = [this, &path](const Cluster& cluster, int from) {
+        const int width = cluster.x1 - cluster.x0 + 1;
+        for(int local = m_localParents[localIndex(cluster, from)]; local >= 0; local = m_localParents[local])
+            path.push_back(Vec2i(cluster.x0 + local % width, cluster.y0 + local / width));
+    };
+
+    // Même cluster : le chemin local suffit s'il existe
+    if(startCluster == destCluster)
+    {
+        const Cluster& cluster = m_clusters[startCluster];
+        search(cluster, startIndex);
+        scratch.expanded += m_queue.size();
+        if(m_localDistances[localIndex(cluster, destIndex)] >= 0)
+        {
+            unroll(cluster, destIndex);
+            return true;
+        }
+    }
+
+    // Relie temporairement start et dest aux transitions de leur cluster
+    m_startEdges.clear();
+    search(m_clusters[startCluster], startIndex);
+    scratch.expanded += m_queue.size();
+    for(int node : m_clusters[startCluster].nodes)
+    {
+        const int distance = m_localDistances[localIndex(m_clusters[startCluster], node)];
+        if(distance >= 0)
+            m_startEdges.emplace_back(node, distance);
+    }
+
+    m_destEdges.clear();
+    search(m_clusters[destCluster], destIndex);
+    scratch.expanded += m_queue.size();
+    for(int node : m_clusters[destCluster].nodes)
+    {
+        const int distance = m_localDistances[localIndex(m_clusters[destCluster], node)];
+        if(distance >= 0)
+            m_destEdges.emplace_back(node, distance);
+    }
+
+    auto heuristic = [&dest, this](int index) {
+        return std::abs(index % m_gridWidth - dest.x) + std::abs(index / m_gridWidth - dest.y);
+    };
+
+    size_t bucket = heuristic(startIndex);
+    const size_t firstBucket = bucket;
+    size_t lastBucket = bucket;
+
+    auto relax = [&](int from, int to, int cost) {
+        if(scratch.stamp[to] != generation || cost < scratch.g[to])
+        {
+            scratch.stamp[to] = generation;
+            scratch.g[to] = cost;
+            scratch.parent[to] = from;
+
+            const size_t f = cost + heuristic(to);
+            scratch.push(f, to);
+            lastBucket = std::max(lastBucket, f);
+        }
+    };
+
+    scratch.g[startIndex] = 0;
+    scratch.parent[startIndex] = -1;
+    scratch.stamp[startIndex] = generation;
+    scratch.push(bucket, startIndex);
+
+    // Les arêtes abstraites coûtent au moins la distance de Manhattan : l'heuristique reste cohérente
+    bool found = false;
+    while(bucket <= lastBucket)
+    {
+        std::vector<int32_t>& open = scratch.buckets[bucket];
+        if(open.empty())
+        {
+            bucket++;
+            continue;
+        }
+
+        const int index = open.back();
+        open.pop_back();
+
+        if(scratch.closed[index] == generation)
+            continue;
+        scratch.closed[index] = generation;
+        scratch.expanded++;
+
+        if(index == destIndex)
+        {
+            found = true;
+            break;
+        }
+
+        const int g = scratch.g[index];
+        const Cluster& cluster = m_clusters[clusterOf(index)];
+
+        if(index == startIndex)
+        {
+            for(const auto& edge : m_startEdges)
+                relax(index, edge.first, g + edge.second);
+        }
+        else
+        {
+            const auto node = std::lower_bound(cluster.nodes.begin(), cluster.nodes.end(), index);
+            if(node != cluster.nodes.end() && *node == index)
+            {
+                const size_t n = cluster.nodes.size();
+                const size_t i = node - cluster.nodes.begin();
+                for(size_t j = 0; j < n; j++)
+                    if(cluster.distances[i * n + j] > 0)
+                        relax(index, cluster.nodes[j], g + cluster.distances[i * n + j]);
+            }
+        }
+
+        for(const Crossing& crossing : cluster.crossings)
+            if(crossing.from == index)
+                relax(index, crossing.to, g + 1);
+
+        if(&cluster == &m_clusters[destCluster])
+        {
+            for(const auto& edge : m_destEdges)
+                if(edge.first == index)
+                    relax(index, destIndex, g + edge.second);
+        }
+    }
+
+    for(size_t i = firstBucket; i <= lastBucket; i++)
+        scratch.buckets[i].clear();
+
+    if(!found)
+        return false;
+
+    // Raffine chaque arête abstraite en chemin case par case
+    for(int current = destIndex; current != startIndex;)
+    {
+        const int parent = scratch.parent[current];
+        const int distance = std::abs(parent % m_gridWidth - current % m_gridWidth) + std::abs(parent / m_gridWidth - current / m_gridWidth);
+
+        if(distance == 1)
+            path.push_back(Vec2i(parent % m_gridWidth, parent / m_gridWidth));
+        else
+        {
+            const Cluster& cluster = m_clusters[clusterOf(parent)];
+            search(cluster, parent);
+            scratch.expanded += m_queue.size();
+            unroll(cluster, current);
+        }
+
+        current = parent;
+    }
+
+    return true;
+}
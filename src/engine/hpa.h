@@ -0,0 +1,88 @@
+#ifndef __HPA_H__
+#define __HPA_H__
+
+#include "tiles.h"
+
+#include <vector>
+#include <utility>
+
+namespace simu
+{
+    /**
+     * @brief Abstraction hiérarchique de la grille pour PathAlgorithm::HPA (HPA*).
+     *
+     * La grille est découpée en clusters carrés. Chaque passage libre entre deux clusters voisins
+     * (entrée) donne une ou deux paires de cases de transition, reliées par une arête de coût 1.
+     * Dans un cluster, les transitions sont reliées par leur distance calculée par un BFS limité au cluster.
+     * Une requête cherche d'abord dans ce graphe abstrait puis raffine chaque arête en chemin case par case.
+     *
+     * Quand setTile change la solidité d'une case, seul son cluster est marqué : ses quatre bords et
+     * les clusters qui les partagent sont reconstruits à la requête suivante.
+     */
+    class ClusterGraph
+    {
+        public:
+            static constexpr int CLUSTER_SIZE = 16;
+
+            // Au delà de cette longueur, une entrée a une transition à chaque extrémité au lieu d'une seule au milieu
+            static constexpr int MAX_ENTRANCE_WIDTH = 6;
+
+            explicit ClusterGraph(const Grid& grid);
+
+            /** @brief Marque le cluster contenant la case (x, y) pour reconstruction.
+             */
+            void invalidate(int x, int y);
+
+            /** @brief Cherche un chemin de start à dest, au même format que Grid::findPath.
+             *  @return false si start ou dest est solide ou si dest est inaccessible, path est alors vide.
+             */
+            bool findPath(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch);
+
+            // Nombre de cases de transition du graphe abstrait
+            size_t getNodeCount();
+
+        private:
+            struct Crossing
+            {
+                int from;   // Case de ce cluster
+                int to;     // Case du cluster voisin
+            };
+
+            struct Cluster
+            {
+                int x0, y0, x1, y1;             // Bornes incluses
+                std::vector<int> nodes;         // Cases de transition
+                std::vector<int> distances;     // Distances entre transitions (nodes.size()²), -1 si inaccessible
+                std::vector<Crossing> crossings;
+                bool dirty;
+            };
+
+            int clusterOf(int index) const;
+
+            // Reconstruit les entrées du bord droit (vertical = true) ou bas du cluster
+            void buildBorder(int cluster, bool vertical);
+            void buildCluster(int cluster);
+            void update();
+
+            // BFS limité au cluster depuis source, les résultats sont dans m_localDistances et m_localParents
+            void search(const Cluster& cluster, int source);
+            int localIndex(const Cluster& cluster, int index) const;
+
+            const Grid& m_grid;
+            int m_gridWidth;
+            int m_clustersPerRow;
+
+            std::vector<Cluster> m_clusters;
+            std::vector<std::vector<std::pair<int, int>>> m_rightEntrances;    // (case gauche, case droite)
+            std::vector<std::vector<std::pair<int, int>>> m_bottomEntrances;   // (case haute, case basse)
+            std::vector<int> m_dirty;
+
+            std::vector<int> m_localDistances;
+            std::vector<int> m_localParents;
+            std::vector<int> m_queue;
+            std::vector<std::pair<int, int>> m_startEdges;
+            std::vector<std::pair<int, int>> m_destEdges;
+    };
+}
+
+#endif
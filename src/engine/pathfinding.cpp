@@ -1,70 +1,398 @@
 #include "tiles.h"
+#include "hpa.h"
 #include "types.h"
-#include <stack>
-#include <queue>
-#include <functional>
-#include <utility>
+#include <algorithm>
+#include <cstdlib>
 
 using namespace simu;
 
-std::vector<Vec2i> Grid::findPath(Vec2i start, Vec2i dest)
+uint32_t PathScratch::begin(int tileNumber)
 {
-    using element = std::pair<int, Vec2i>;
-    
-    std::priority_queue<element, std::vector<element>, std::greater<element>> edges;
-    std::unordered_map<Vec2i, Vec2i, VecHasher<int>> paths;
-    std::unordered_map<Vec2i, int, VecHasher<int>> reached;
-    const std::array<Vec2i, 4> directions = {Vec2i(0, 1), Vec2i(1, 0), Vec2i(-1, 0), Vec2i(0, -1)};
-    
-    edges.push(element(0, start));
-    reached[start] = 0;
-    paths[start] = Vec2i(0, 0);
-
-    Vec2i current;
-
-    while(!edges.empty())
+    if(stamp.size() != static_cast<size_t>(tileNumber))
     {
-        current = edges.top().second;
-        edges.pop();
+        g.assign(tileNumber, 0);
+        parent.assign(tileNumber, -1);
+        stamp.assign(tileNumber, 0);
+        closed.assign(tileNumber, 0);
+        generation = 0;
+    }
+
+    expanded = 0;
+
+    // Nouvelle génération : invalide toutes les cases d'un coup
+    if(++generation == 0)
+    {
+        std::fill(stamp.begin(), stamp.end(), 0);
+        std::fill(closed.begin(), closed.end(), 0);
+        generation = 1;
+    }
+    return generation;
+}
+
+void PathScratch::push(size_t f, int32_t index)
+{
+    if(f >= buckets.size())
+        buckets.resize(f + 1);
+    buckets[f].push_back(index);
+}
 
-        if(current == dest)
+namespace
+{
+    int sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+}
+
+std::vector<Vec2i> Grid::findPath(Vec2i start, Vec2i dest, PathAlgorithm algorithm) const
+{
+    static thread_local PathScratch scratch;
+
+    std::vector<Vec2i> path;
+    findPath(start, dest, path, scratch, algorithm);
+    return path;
+}
+
+void Grid::findPath(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch, PathAlgorithm algorithm) const
+{
+    path.clear();
+
+    if(!isValid(start.x, start.y))
+        return;
+
+    switch(algorithm)
+    {
+        case PathAlgorithm::JPS:
+            findPathJPS(start, dest, path, scratch);
+            break;
+        case PathAlgorithm::HPA:
+        {
+            std::lock_guard<std::mutex> lock(m_clustersMutex);
+            if(!m_clusters)
+                m_clusters = std::make_unique<ClusterGraph>(*this);
+
+            // Le graphe abstrait ne couvre que les cases libres, sinon on garde le comportement de A*
+            if(!m_clusters->findPath(start, dest, path, scratch))
+                findPathAStar(start, dest, path, scratch);
+            break;
+        }
+        default:
+            findPathAStar(start, dest, path, scratch);
             break;
+    }
+}
+
+void Grid::findPathAStar(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch) const
+{
+    const uint32_t generation = scratch.begin(getTileNumber());
 
-        // setTile(FOOD, current.x, current.y);
+    auto heuristic = [&dest, this](int index) {
+        return std::abs(index % m_gridWidth - dest.x) + std::abs(index / m_gridWidth - dest.y);
+    };
 
-        for(const auto& dir : directions)
+    const int startIndex = start.y * m_gridWidth + start.x;
+    const int destIndex = isValid(dest.x, dest.y) ? dest.y * m_gridWidth + dest.x : -1;
+
+    scratch.g[startIndex] = 0;
+    scratch.parent[startIndex] = -1;
+    scratch.stamp[startIndex] = generation;
+
+    // L'heuristique est cohérente : f ne décroît jamais, les seaux sont parcourus dans l'ordre
+    size_t bucket = heuristic(startIndex);
+    const size_t firstBucket = bucket;
+    size_t lastBucket = bucket;
+    scratch.push(bucket, startIndex);
+
+    int current = startIndex;
+    while(bucket <= lastBucket)
+    {
+        std::vector<int32_t>& open = scratch.buckets[bucket];
+        if(open.empty())
         {
-            const Vec2i newEdge = current + dir;
-            Tile tile = getTile<true>(newEdge);
+            bucket++;
+            continue;
+        }
 
-            if(tile.flags.solid)
-                continue;
+        const int index = open.back();
+        open.pop_back();
+
+        if(scratch.closed[index] == generation)
+            continue;
+        scratch.closed[index] = generation;
+        scratch.expanded++;
+        current = index;
+
+        if(index == destIndex)
+            break;
 
-            int cost = reached[current] + 1;
+        const int x = index % m_gridWidth;
+        const int y = index / m_gridWidth;
+        const int cost = scratch.g[index] + 1;
 
-            if(reached.find(newEdge) == reached.end() || cost < reached[newEdge])
+        const int neighbours[4][2] = {{x, y + 1}, {x + 1, y}, {x - 1, y}, {x, y - 1}};
+        for(const auto& n : neighbours)
+        {
+            if(!isWalkable(n[0], n[1]))
+                continue;
+
+            const int nIndex = n[1] * m_gridWidth + n[0];
+            if(scratch.stamp[nIndex] != generation || cost < scratch.g[nIndex])
             {
-                paths[newEdge] = current;
-                reached[newEdge] = cost;
-                int totalCost = cost + newEdge.manhattan(dest);
-                edges.push(element(totalCost, newEdge));
+                scratch.stamp[nIndex] = generation;
+                scratch.g[nIndex] = cost;
+                scratch.parent[nIndex] = index;
+
+                const size_t f = cost + heuristic(nIndex);
+                scratch.push(f, nIndex);
+                lastBucket = std::max(lastBucket, f);
             }
         }
     }
 
-    std::vector<Vec2i> path;
-    while(current != start)
+    // Vide les seaux encore remplis, ils gardent leur capacité pour la prochaine recherche
+    for(size_t i = firstBucket; i <= lastBucket; i++)
+        scratch.buckets[i].clear();
+
+    for(int index = scratch.parent[current]; current != startIndex; index = scratch.parent[current])
     {
-        Vec2i parent = paths[current];
-        current = parent;
-        path.push_back(parent);
+        current = index;
+        path.push_back(Vec2i(index % m_gridWidth, index / m_gridWidth));
     }
+}
 
-    return path;
+/*
+ * Jump Point Search en 4-connexité. Les chemins canoniques sont formés de segments verticaux
+ * qui ne tournent à l'horizontale que là où un saut horizontal trouve quelque chose, et de segments
+ * horizontaux qui ne tournent à la verticale que devant un voisin forcé (case libre au dessus ou
+ * en dessous alors que la case précédente était bloquée). Seuls ces points de saut sont mis dans la file.
+ */
+int Grid::jumpHorizontal(int x, int y, int dx, int destIndex) const
+{
+    while(true)
+    {
+        x += dx;
+        if(!isWalkable(x, y))
+            return -1;
+
+        const int index = y * m_gridWidth + x;
+        if(index == destIndex)
+            return index;
+
+        if((isWalkable(x, y - 1) && !isWalkable(x - dx, y - 1)) ||
+           (isWalkable(x, y + 1) && !isWalkable(x - dx, y + 1)))
+            return index;
+    }
 }
 
+int Grid::jumpVertical(int x, int y, int dy, int destIndex) const
+{
+    while(true)
+    {
+        y += dy;
+        if(!isWalkable(x, y))
+            return -1;
+
+        const int index = y * m_gridWidth + x;
+        if(index == destIndex)
+            return index;
+
+        if(jumpHorizontal(x, y, 1, destIndex) >= 0 || jumpHorizontal(x, y, -1, destIndex) >= 0)
+            return index;
+    }
+}
 
-int Grid::pathDistance(Vec2i start, Vec2i dest)
+void Grid::findPathJPS(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch) const
 {
+    const uint32_t generation = scratch.begin(getTileNumber());
+
+    auto heuristic = [&dest, this](int index) {
+        return std::abs(index % m_gridWidth - dest.x) + std::abs(index / m_gridWidth - dest.y);
+    };
+
+    const int startIndex = start.y * m_gridWidth + start.x;
+    const int destIndex = isValid(dest.x, dest.y) ? dest.y * m_gridWidth + dest.x : -1;
+
+    scratch.g[startIndex] = 0;
+    scratch.parent[startIndex] = -1;
+    scratch.stamp[startIndex] = generation;
+
+    // Les segments coûtent leur longueur et l'heuristique reste cohérente : même file à seaux que A*
+    size_t bucket = heuristic(startIndex);
+    const size_t firstBucket = bucket;
+    size_t lastBucket = bucket;
+    scratch.push(bucket, startIndex);
+
+    int current = startIndex;
+    while(bucket <= lastBucket)
+    {
+        std::vector<int32_t>& open = scratch.buckets[bucket];
+        if(open.empty())
+        {
+            bucket++;
+            continue;
+        }
+
+        const int index = open.back();
+        open.pop_back();
+
+        if(scratch.closed[index] == generation)
+            continue;
+        scratch.closed[index] = generation;
+        scratch.expanded++;
+        current = index;
+
+        if(index == destIndex)
+            break;
+
+        const int x = index % m_gridWidth;
+        const int y = index / m_gridWidth;
+
+        // Directions à explorer selon la direction d'arrivée
+        int directions[4][2];
+        int directionCount = 0;
+        const int parent = scratch.parent[index];
+        if(parent < 0)
+        {
+            directions[directionCount][0] = 1; directions[directionCount++][1] = 0;
+            directions[directionCount][0] = -1; directions[directionCount++][1] = 0;
+            directions[directionCount][0] = 0; directions[directionCount++][1] = 1;
+            directions[directionCount][0] = 0; directions[directionCount++][1] = -1;
+        }
+        else if(parent % m_gridWidth == x) // Arrivée verticale
+        {
+            const int dy = sign(y - parent / m_gridWidth);
+            directions[directionCount][0] = 0; directions[directionCount++][1] = dy;
+            directions[directionCount][0] = 1; directions[directionCount++][1] = 0;
+            directions[directionCount][0] = -1; directions[directionCount++][1] = 0;
+        }
+        else // Arrivée horizontale : tout droit et voisins forcés
+        {
+            const int dx = sign(x - parent % m_gridWidth);
+            directions[directionCount][0] = dx; directions[directionCount++][1] = 0;
+            for(int dy = -1; dy <= 1; dy += 2)
+            {
+                if(isWalkable(x, y + dy) && !isWalkable(x - dx, y + dy))
+                {
+                    directions[directionCount][0] = 0;
+                    directions[directionCount++][1] = dy;
+                }
+            }
+        }
+
+        for(int d = 0; d < directionCount; d++)
+        {
+            const int jumpIndex = directions[d][1] == 0 ?
+                jumpHorizontal(x, y, directions[d][0], destIndex) :
+                jumpVertical(x, y, directions[d][1], destIndex);
+
+            if(jumpIndex < 0)
+                continue;
+
+            const int cost = scratch.g[index] + std::abs(jumpIndex % m_gridWidth - x) + std::abs(jumpIndex / m_gridWidth - y);
+            if(scratch.stamp[jumpIndex] != generation || cost < scratch.g[jumpIndex])
+            {
+                scratch.stamp[jumpIndex] = generation;
+                scratch.g[jumpIndex] = cost;
+                scratch.parent[jumpIndex] = index;
+
+                const size_t f = cost + heuristic(jumpIndex);
+                scratch.push(f, jumpIndex);
+                lastBucket = std::max(lastBucket, f);
+            }
+        }
+    }
+
+    for(size_t i = firstBucket; i <= lastBucket; i++)
+        scratch.buckets[i].clear();
+
+    // Déroule les segments entre points de saut case par case
+    while(current != startIndex)
+    {
+        const int parent = scratch.parent[current];
+        const int px = parent % m_gridWidth;
+        const int py = parent / m_gridWidth;
+        int x = current % m_gridWidth;
+        int y = current / m_gridWidth;
+        const int dx = sign(px - x);
+        const int dy = sign(py - y);
+
+        do
+        {
+            x += dx;
+            y += dy;
+            path.push_back(Vec2i(x, y));
+        } while(x != px || y != py);
+
+        current = parent;
+    }
+}
+
+int Grid::pathDistance(Vec2i start, Vec2i dest) const
+{
+    if(isValid(start.x, start.y))
+    {
+        const uint16_t distance = distanceField(dest)[start.y * m_gridWidth + start.x];
+        if(distance != UNREACHABLE)
+            return distance;
+    }
+
     return findPath(start, dest).size();
-}
\ No newline at end of file
+}
+
+const std::vector<uint16_t>& Grid::distanceField(Vec2i target) const
+{
+    std::lock_guard<std::mutex> lock(m_fieldsMutex);
+
+    auto it = m_fields.find(target);
+    if(it != m_fields.end() && it->second.revision == m_revision)
+        return it->second.distances;
+
+    // Les champs d'une ancienne révision ne serviront plus
+    for(auto field = m_fields.begin(); field != m_fields.end();)
+    {
+        if(field->second.revision != m_revision)
+            field = m_fields.erase(field);
+        else
+            field++;
+    }
+
+    DistanceField& field = m_fields[target];
+    field.revision = m_revision;
+    field.distances.assign(getTileNumber(), UNREACHABLE);
+
+    if(!isValid(target.x, target.y))
+        return field.distances;
+
+    // BFS depuis la cible : tous les déplacements coûtent 1
+    std::vector<int> queue;
+    queue.reserve(getTileNumber());
+    queue.push_back(target.y * m_gridWidth + target.x);
+    field.distances[queue.front()] = 0;
+
+    for(size_t head = 0; head < queue.size(); head++)
+    {
+        const int index = queue[head];
+        const int x = index % m_gridWidth;
+        const int y = index / m_gridWidth;
+        const uint16_t next = field.distances[index] + 1;
+
+        if(next == UNREACHABLE)
+            continue;
+
+        const int neighbours[4][2] = {{x, y + 1}, {x + 1, y}, {x - 1, y}, {x, y - 1}};
+        for(const auto& n : neighbours)
+        {
+            if(!isValid(n[0], n[1]))
+                continue;
+
+            const int nIndex = n[1] * m_gridWidth + n[0];
+            if(field.distances[nIndex] != UNREACHABLE || isSolid(nIndex))
+                continue;
+
+            field.distances[nIndex] = next;
+            queue.push_back(nIndex);
+        }
+    }
+
+    return field.distances;
+}
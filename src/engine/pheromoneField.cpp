@@ -0,0 +1,229 @@
+#include "pheromoneField.h"
+#include "tiles.h"
+
+#include <algorithm>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+using namespace simu;
+
+namespace
+{
+#if defined(__AVX__)
+    constexpr int LANES = 8;
+    using vec = __m256;
+
+    inline vec vload(const float *p) { return _mm256_loadu_ps(p); }
+    inline void vstore(float *p, vec v) { _mm256_storeu_ps(p, v); }
+    inline vec vset(float x) { return _mm256_set1_ps(x); }
+    inline vec vadd(vec a, vec b) { return _mm256_add_ps(a, b); }
+    inline vec vsub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+    inline vec vmul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+    inline vec vmax(vec a, vec b) { return _mm256_max_ps(a, b); }
+    // Met à 0 les valeurs sous le seuil
+    inline vec vflush(vec v, vec threshold) { return _mm256_and_ps(v, _mm256_cmp_ps(v, threshold, _CMP_GE_OQ)); }
+    inline float vhmax(vec v)
+    {
+        __m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+        m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+        return _mm_cvtss_f32(m);
+    }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+    constexpr int LANES = 4;
+    using vec = __m128;
+
+    inline vec vload(const float *p) { return _mm_loadu_ps(p); }
+    inline void vstore(float *p, vec v) { _mm_storeu_ps(p, v); }
+    inline vec vset(float x) { return _mm_set1_ps(x); }
+    inline vec vadd(vec a, vec b) { return _mm_add_ps(a, b); }
+    inline vec vsub(vec a, vec b) { return _mm_sub_ps(a, b); }
+    inline vec vmul(vec a, vec b) { return _mm_mul_ps(a, b); }
+    inline vec vmax(vec a, vec b) { return _mm_max_ps(a, b); }
+    inline vec vflush(vec v, vec threshold) { return _mm_and_ps(v, _mm_cmpge_ps(v, threshold)); }
+    inline float vhmax(vec v)
+    {
+        v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+        v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 1));
+        return _mm_cvtss_f32(v);
+    }
+
+#else
+    constexpr int LANES = 1;
+#endif
+}
+
+void PheromoneField::resize(int width)
+{
+    m_width = std::max(0, width);
+    m_stride = m_width + 2;
+    m_bandCount = (m_width + BAND_ROWS - 1) / BAND_ROWS;
+
+    const size_t size = m_stride * (m_width + 2);
+    for(auto& planes : m_planes)
+    {
+        for(auto& plane : planes)
+            plane.assign(size, 0.f);
+    }
+    for(auto& active : m_active)
+        active.assign(m_bandCount, 0);
+
+    m_open.assign(size, 0.f);
+    m_maskRevision = UINT64_MAX;
+    m_current = 0;
+}
+
+void PheromoneField::clear()
+{
+    for(auto& planes : m_planes)
+    {
+        for(auto& plane : planes)
+            std::fill(plane.begin(), plane.end(), 0.f);
+    }
+    for(auto& active : m_active)
+        std::fill(active.begin(), active.end(), 0);
+}
+
+void PheromoneField::setRates(PheromoneChannel channel, float evaporation, float diffusion)
+{
+    m_keep[static_cast<int>(channel)] = 1.f - std::clamp(evaporation, 0.f, 1.f);
+    m_diffusion[static_cast<int>(channel)] = std::clamp(diffusion, 0.f, 0.25f);
+}
+
+void PheromoneField::deposit(PheromoneChannel channel, int x, int y, float amount)
+{
+    if(x < 0 || y < 0 || x >= m_width || y >= m_width)
+        return;
+
+    const size_t i = index(x, y);
+    if(m_open[i] == 0.f && m_maskRevision != UINT64_MAX) // Rien ne se pose dans un mur
+        return;
+
+    m_planes[m_current][static_cast<int>(channel)][i] += amount;
+    m_active[m_current][y / BAND_ROWS] = 1;
+}
+
+Vec2f PheromoneField::gradient(PheromoneChannel channel, int x, int y) const
+{
+    if(x < 0 || y < 0 || x >= m_width || y >= m_width)
+        return Vec2f(0.f, 0.f);
+
+    const std::vector<float>& plane = m_planes[m_current][static_cast<int>(channel)];
+    const size_t i = index(x, y);
+    return Vec2f((plane[i + 1] - plane[i - 1]) * 0.5f, (plane[i + m_stride] - plane[i - m_stride]) * 0.5f);
+}
+
+void PheromoneField::rebuildMask(const Grid& grid)
+{
+    for(int y = 0; y < m_width; y++)
+    {
+        for(int x = 0; x < m_width; x++)
+            m_open[index(x, y)] = grid.getTile<false>(Vec2i(x, y)).flags.solid ? 0.f : 1.f;
+    }
+    m_maskRevision = grid.getRevision();
+}
+
+void PheromoneField::update(const Grid& grid, ThreadPool& pool)
+{
+    if(m_width == 0 || grid.getGridWidth() != m_width)
+        return;
+
+    if(m_maskRevision != grid.getRevision())
+        rebuildMask(grid);
+
+    const std::vector<uint8_t>& active = m_active[m_current];
+    std::vector<uint8_t>& next = m_active[1 - m_current];
+
+    // Une bande change si elle ou une voisine contient des phéromones, sinon elle reste (ou devient) nulle
+    m_bands.clear();
+    for(int band = 0; band < m_bandCount; band++)
+    {
+        const bool needed = active[band] || (band > 0 && active[band - 1]) || (band + 1 < m_bandCount && active[band + 1]);
+        if(needed)
+            m_bands.push_back(band);
+        else if(next[band])
+        {
+            const size_t begin = index(0, band * BAND_ROWS) - 1;
+            const size_t end = index(0, std::min(m_width, (band + 1) * BAND_ROWS)) - 1;
+            for(auto& plane : m_planes[1 - m_current])
+                std::fill(plane.begin() + begin, plane.begin() + end, 0.f);
+            next[band] = 0;
+        }
+    }
+
+    if(m_bands.empty())
+        return;
+
+    pool.parallelFor(m_bands.size(), 1, [this](size_t begin, size_t end, unsigned int) {
+        for(size_t b = begin; b < end; b++)
+            updateBand(m_bands[b]);
+    });
+
+    m_current = 1 - m_current;
+}
+
+void PheromoneField::updateBand(int band)
+{
+    const int yEnd = std::min(m_width, (band + 1) * BAND_ROWS);
+    const float* open = m_open.data();
+    const size_t stride = m_stride;
+    float bandMax = 0.f;
+
+    for(int channel = 0; channel < PHEROMONE_CHANNELS; channel++)
+    {
+        const float* in = m_planes[m_current][channel].data();
+        float* out = m_planes[1 - m_current][channel].data();
+        const float keep = m_keep[channel];
+        const float diffusion = m_diffusion[channel];
+
+        for(int y = band * BAND_ROWS; y < yEnd; y++)
+        {
+            const size_t row = index(0, y);
+            int x = 0;
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+            const vec vkeep = vset(keep);
+            const vec vdiffusion = vset(diffusion);
+            const vec threshold = vset(EPSILON);
+            vec vmaximum = vset(0.f);
+
+            for(; x + LANES <= m_width; x += LANES)
+            {
+                const size_t i = row + x;
+                const vec c = vload(in + i);
+                vec flux = vmul(vload(open + i - 1), vsub(vload(in + i - 1), c));
+                flux = vadd(flux, vmul(vload(open + i + 1), vsub(vload(in + i + 1), c)));
+                flux = vadd(flux, vmul(vload(open + i - stride), vsub(vload(in + i - stride), c)));
+                flux = vadd(flux, vmul(vload(open + i + stride), vsub(vload(in + i + stride), c)));
+
+                vec v = vmul(vmul(vload(open + i), vkeep), vadd(c, vmul(vdiffusion, flux)));
+                v = vflush(v, threshold);
+                vstore(out + i, v);
+                vmaximum = vmax(vmaximum, v);
+            }
+            bandMax = std::max(bandMax, vhmax(vmaximum));
+#endif
+
+            for(; x < m_width; x++)
+            {
+                const size_t i = row + x;
+                const float c = in[i];
+                const float flux = open[i - 1] * (in[i - 1] - c) + open[i + 1] * (in[i + 1] - c) +
+                    open[i - stride] * (in[i - stride] - c) + open[i + stride] * (in[i + stride] - c);
+
+                float v = open[i] * keep * (c + diffusion * flux);
+                if(v < EPSILON)
+                    v = 0.f;
+                out[i] = v;
+                bandMax = std::max(bandMax, v);
+            }
+        }
+    }
+
+    m_active[1 - m_current][band] = bandMax > 0.f;
+}
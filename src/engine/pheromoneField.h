@@ -0,0 +1,103 @@
+#ifndef __PHEROMONE_FIELD_H__
+#define __PHEROMONE_FIELD_H__
+
+#include <vector>
+#include <cstdint>
+
+#include "types.h"
+#include "threadpool.h"
+
+namespace simu
+{
+    class Grid;
+
+    /**
+     * @brief Canaux du champ de phéromones.
+     */
+    enum class PheromoneChannel: uint8_t
+    {
+        FOOD,   // Piste vers la nourriture, posée par les fourmis chargées
+        HOME,   // Piste vers le nid, posée par les fourmis qui cherchent
+        COUNT,
+    };
+
+    constexpr int PHEROMONE_CHANNELS = static_cast<int>(PheromoneChannel::COUNT);
+
+    /**
+     * @brief Champ continu de phéromones à plusieurs canaux, à côté de la grille de tuiles.
+     *
+     * Chaque canal est un plan de float, une valeur par tuile, bordé d'une case nulle pour que le noyau
+     * n'ait aucun test de bord. A chaque tick, la valeur d'une case libre devient
+     * (1 - évaporation) * (c + diffusion * somme(voisine libre - c)) : les murs ne laissent rien passer
+     * et restent à 0. Le noyau est vectorisé (AVX ou SSE2) et appliqué par bandes de BAND_ROWS lignes
+     * réparties sur le pool de threads. Une bande n'est calculée que si elle ou une voisine contient
+     * des phéromones, les valeurs sous EPSILON sont remises à 0.
+     */
+    class PheromoneField
+    {
+        public:
+            static constexpr int BAND_ROWS = 16;
+            static constexpr float EPSILON = 1e-4f;
+
+            /** @brief Redimensionne le champ pour une grille de width² tuiles et le vide.
+             */
+            void resize(int width);
+            void clear();
+
+            int getWidth() const { return m_width; };
+
+            /** @brief Définit les taux d'un canal.
+             *  @param evaporation Part perdue à chaque tick, dans [0, 1].
+             *  @param diffusion Part échangée avec chaque voisine à chaque tick, limitée à 0.25 pour rester stable.
+             */
+            void setRates(PheromoneChannel channel, float evaporation, float diffusion);
+
+            /** @brief Ajoute amount au canal sur la tuile (x, y). Sans effet hors de la grille.
+             *  @warning Pendant la mise à jour parallèle des entités, passer par Grid::depositPheromone.
+             */
+            void deposit(PheromoneChannel channel, int x, int y, float amount);
+
+            // Valeur du canal sur la tuile (x, y), 0 hors de la grille
+            float sample(PheromoneChannel channel, int x, int y) const
+            {
+                if(x < 0 || y < 0 || x >= m_width || y >= m_width)
+                    return 0.f;
+                return m_planes[m_current][static_cast<int>(channel)][index(x, y)];
+            }
+
+            /** @brief Gradient du canal en (x, y) par différences centrées, orienté vers les valeurs croissantes.
+             *  Les murs et l'extérieur de la grille valent 0.
+             */
+            Vec2f gradient(PheromoneChannel channel, int x, int y) const;
+
+            /** @brief Évapore et diffuse tous les canaux d'un tick.
+             *  @param grid Grille dont les cases solides bloquent la diffusion (masque recalculé à chaque révision).
+             */
+            void update(const Grid& grid, ThreadPool& pool);
+
+        private:
+            size_t index(int x, int y) const { return (y + 1) * m_stride + (x + 1); };
+
+            void rebuildMask(const Grid& grid);
+            void updateBand(int band);
+
+            int m_width = 0;
+            size_t m_stride = 0;
+            int m_bandCount = 0;
+
+            // Deux jeux de plans : m_current est lu, l'autre est écrit, puis ils sont échangés
+            std::vector<float> m_planes[2][PHEROMONE_CHANNELS];
+            std::vector<uint8_t> m_active[2]; // Bandes contenant au moins une valeur non nulle
+            int m_current = 0;
+
+            std::vector<float> m_open;  // 1 pour une case libre, 0 pour un mur ou le bord
+            uint64_t m_maskRevision = UINT64_MAX;
+
+            float m_keep[PHEROMONE_CHANNELS] = {0.99f, 0.99f};
+            float m_diffusion[PHEROMONE_CHANNELS] = {0.1f, 0.1f};
+
+            std::vector<int> m_bands;   // Bandes à calculer au tick courant
+    };
+}
+
+#endif
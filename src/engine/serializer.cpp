@@ -0,0 +1,315 @@
+#include "serializer.h"
+
+#include <stdexcept>
+#include <fstream>
+#include <cstdio>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace simu;
+
+namespace
+{
+    constexpr size_t HEADER_SIZE = Serializer::HEADER_SIZE;
+    constexpr size_t SECTION_HEADER_SIZE = 16;  // Étiquette, réservé, taille
+
+    size_t align8(size_t pos) { return (pos + 7) & ~size_t(7); }
+}
+
+Serializer::Serializer(const int version) : m_version(version)
+{
+    write(MAGIC);
+    write(static_cast<uint32_t>(version));
+}
+
+Serializer::Serializer(const void* data, size_t size) : m_data(static_cast<const uint8_t*>(data)), m_size(size)
+{
+    if(size < HEADER_SIZE || read<uint32_t>() != MAGIC)
+        throw std::runtime_error("Impossible de charger le snapshot: en-tête invalide");
+
+    m_version = read<uint32_t>();
+    if(m_version <= 0 || m_version > VERSION)
+        throw std::runtime_error("Impossible de charger le snapshot: version " + std::to_string(m_version) + " non supportée");
+}
+
+Serializer::Serializer(const uint8_t* data, size_t size, int version) : m_version(version), m_data(data), m_size(size) {}
+
+void Serializer::writeBytes(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+}
+
+void Serializer::writeString(const std::string& str)
+{
+    write(static_cast<uint32_t>(str.size()));
+    writeBytes(str.data(), str.size());
+}
+
+void Serializer::pad()
+{
+    m_buffer.resize(align8(m_buffer.size()), 0);
+}
+
+void Serializer::beginSection(uint32_t tag)
+{
+    if(m_sectionStart != 0)
+        throw std::logic_error("Une section est déjà ouverte");
+
+    pad();
+    write(tag);
+    write(uint32_t(0));
+    m_sectionStart = m_buffer.size();
+    write(uint64_t(0)); // Taille, écrite par endSection
+}
+
+void Serializer::endSection()
+{
+    const uint64_t size = m_buffer.size() - m_sectionStart - sizeof(uint64_t);
+    std::memcpy(m_buffer.data() + m_sectionStart, &size, sizeof(size));
+    m_sectionStart = 0;
+    pad();
+}
+
+void Serializer::appendSection(uint32_t tag, const Serializer& content)
+{
+    beginSection(tag);
+    m_buffer.insert(m_buffer.end(), content.m_buffer.begin() + HEADER_SIZE, content.m_buffer.end());
+    endSection();
+}
+
+uint32_t Serializer::beginRecord()
+{
+    m_recordStart = m_buffer.size();
+    write(uint32_t(0));
+    return m_recordCount++;
+}
+
+void Serializer::endRecord()
+{
+    const uint32_t size = m_buffer.size() - m_recordStart - sizeof(uint32_t);
+    std::memcpy(m_buffer.data() + m_recordStart, &size, sizeof(size));
+}
+
+void Serializer::writeFile(const std::string& file) const
+{
+    const std::string tmp = file + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        out.write(reinterpret_cast<const char*>(m_buffer.data()), m_buffer.size());
+        if(!out)
+            throw std::runtime_error("Impossible d'écrire le fichier " + tmp);
+    }
+
+#ifdef _WIN32
+    // rename ne remplace pas un fichier existant sous Windows
+    if(!MoveFileExA(tmp.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        throw std::runtime_error("Impossible de renommer " + tmp + " en " + file);
+#else
+    // rename remplace le fichier de façon atomique : un crash laisse l'ancien ou le nouveau
+    if(std::rename(tmp.c_str(), file.c_str()) != 0)
+        throw std::runtime_error("Impossible de renommer " + tmp + " en " + file);
+#endif
+}
+
+const uint8_t* Serializer::readBytes(size_t size)
+{
+    if(size > m_size - m_cursor)
+        throw std::runtime_error("Impossible de charger le snapshot: données tronquées");
+
+    const uint8_t* bytes = m_data + m_cursor;
+    m_cursor += size;
+    return bytes;
+}
+
+std::string Serializer::readString()
+{
+    const uint32_t size = read<uint32_t>();
+    const uint8_t* bytes = readBytes(size);
+    return std::string(reinterpret_cast<const char*>(bytes), size);
+}
+
+size_t Serializer::completeSize(const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    if(size < HEADER_SIZE)
+        return 0;
+
+    uint32_t magic;
+    std::memcpy(&magic, bytes, sizeof(magic));
+    if(magic != MAGIC)
+        return 0;
+
+    size_t pos = HEADER_SIZE;
+    while(pos + SECTION_HEADER_SIZE <= size)
+    {
+        uint64_t sectionSize;
+        std::memcpy(&sectionSize, bytes + pos + 8, sizeof(sectionSize));
+        if(sectionSize > size - pos - SECTION_HEADER_SIZE)
+            break;
+        pos = std::min(align8(pos + SECTION_HEADER_SIZE + sectionSize), size);
+    }
+
+    return pos;
+}
+
+std::vector<Serializer> Serializer::sections(uint32_t tag) const
+{
+    std::vector<Serializer> found;
+
+    size_t pos = HEADER_SIZE;
+    while(pos + SECTION_HEADER_SIZE <= m_size)
+    {
+        uint32_t sectionTag;
+        uint64_t size;
+        std::memcpy(&sectionTag, m_data + pos, sizeof(sectionTag));
+        std::memcpy(&size, m_data + pos + 8, sizeof(size));
+        pos += SECTION_HEADER_SIZE;
+
+        if(size > m_size - pos)
+            throw std::runtime_error("Impossible de charger le snapshot: section tronquée");
+
+        if(sectionTag == tag)
+            found.push_back(Serializer(m_data + pos, size, m_version));
+        pos = align8(pos + size);
+    }
+
+    return found;
+}
+
+Serializer Serializer::section(uint32_t tag) const
+{
+    std::vector<Serializer> found = sections(tag);
+    if(found.empty())
+        throw std::runtime_error("Impossible de charger le snapshot: section " + std::to_string(tag) + " absente");
+    return found.front();
+}
+
+Serializer Serializer::record(uint32_t index)
+{
+    if(m_records.empty())
+    {
+        size_t pos = 0;
+        while(pos + sizeof(uint32_t) <= m_size)
+        {
+            uint32_t size;
+            std::memcpy(&size, m_data + pos, sizeof(size));
+            if(size > m_size - pos - sizeof(uint32_t))
+                throw std::runtime_error("Impossible de charger le snapshot: enregistrement tronqué");
+
+            m_records.push_back(pos);
+            pos += sizeof(uint32_t) + size;
+        }
+    }
+
+    if(index >= m_records.size())
+        throw std::runtime_error("Impossible de charger le snapshot: enregistrement " + std::to_string(index) + " absent");
+
+    const size_t pos = m_records[index];
+    uint32_t size;
+    std::memcpy(&size, m_data + pos, sizeof(size));
+    return Serializer(m_data + pos + sizeof(uint32_t), size, m_version);
+}
+
+Serializer& Serializer::genomes() const
+{
+    if(!m_genomes)
+        throw std::runtime_error("Aucune section de génomes associée");
+    return *m_genomes;
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string& file)
+{
+    m_file = CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        throw std::runtime_error("Impossible d'ouvrir le fichier " + file);
+    }
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+    if(m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+    m_data = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if(!m_data)
+    {
+        release();
+        throw std::runtime_error("Impossible de projeter le fichier " + file);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+void MappedFile::release()
+{
+    if(m_data)
+        UnmapViewOfFile(m_data);
+    if(m_mapping)
+        CloseHandle(m_mapping);
+    if(m_file)
+        CloseHandle(m_file);
+    m_data = m_mapping = m_file = nullptr;
+}
+#else
+MappedFile::MappedFile(const std::string& file)
+{
+    const int fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("Impossible d'ouvrir le fichier " + file);
+
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("Impossible de lire la taille du fichier " + file);
+    }
+
+    m_size = static_cast<size_t>(st.st_size);
+    if(m_size > 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Impossible de projeter le fichier " + file);
+        }
+        madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = data;
+    }
+
+    close(fd); // La projection reste valide
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data)
+        munmap(const_cast<void*>(m_data), m_size);
+}
+#endif
+
+bool simu::isSnapshot(const std::string& file)
+{
+    std::ifstream in(file, std::ios_base::in | std::ios_base::binary);
+    uint32_t magic = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    return in && magic == Serializer::MAGIC;
+}
@@ -1,19 +1,163 @@
 #ifndef __SERIALIZER_H__
 #define __SERIALIZER_H__
 
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
 namespace simu
 {
     /**
-     * @brief Class permettant de serialiser et deserialiser 
+     * @brief Class permettant de serialiser et deserialiser au format binaire des snapshots.
+     *
+     * Un snapshot est un en-tête (MAGIC, version) suivi de sections : une étiquette, une taille et les données,
+     * chaque section commençant sur 8 octets. En lecture, le Serializer ne copie rien : il avance dans un bloc
+     * mémoire (en général un fichier projeté, voir MappedFile) et les lectures sont faites en place.
+     * Toutes les lectures sont bornées, un snapshot tronqué ou corrompu lève std::runtime_error.
+     * Les valeurs sont écrites telles qu'en mémoire (petit-boutiste sur les plateformes supportées).
      */
     class Serializer
     {
         public:
-            Serializer(const int version) : m_version(version) {};
+            static constexpr uint32_t MAGIC = 0x554D4953; // "SIMU"
+            static constexpr int VERSION = 1;
+            static constexpr size_t HEADER_SIZE = 8; // MAGIC, version
+
+            /** @brief Étiquettes des sections d'un snapshot du monde.
+             */
+            enum Section: uint32_t
+            {
+                WORLD = 1,      // Graine
+                GRID,           // Cases de la grille (voir Grid::save)
+                ENTITIES,       // Une section par type : nom, taille d'un enregistrement, nombre, enregistrements
+                GENOMES,        // Génomes référencés par les entités, un enregistrement par génome
+                CHECKPOINT,     // Génération d'un entraînement (voir CheckpointWriter)
+                STATS,          // Statistiques de fitness d'une génération
+            };
+
+            /** @brief Crée un Serializer en écriture, l'en-tête du snapshot est écrit.
+             */
+            Serializer(const int version);
+
+            /** @brief Crée un Serializer en lecture sur un snapshot complet. Les données doivent rester valides
+             *  tant que le Serializer et ses sections sont utilisés.
+             *  @throw std::runtime_error si l'en-tête est invalide ou la version plus récente que VERSION.
+             */
+            Serializer(const void* data, size_t size);
+
             virtual ~Serializer() {};
-        
+
+            int getVersion() const { return m_version; };
+            bool isReading() const { return m_data != nullptr; };
+
+            // ------ ECRITURE -------
+            template<typename T>
+            void write(const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                writeBytes(&value, sizeof(T));
+            }
+
+            void writeBytes(const void* data, size_t size);
+            void writeString(const std::string& str);
+
+            // Réécrit une valeur déjà écrite, à la position renvoyée par tell()
+            template<typename T>
+            void writeAt(size_t pos, const T& value)
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                std::memcpy(m_buffer.data() + pos, &value, sizeof(T));
+            }
+
+            size_t tell() const { return m_buffer.size(); };
+
+            /** @brief Ouvre une section, à fermer par endSection. Les sections ne s'imbriquent pas.
+             */
+            void beginSection(uint32_t tag);
+            void endSection();
+
+            /** @brief Ajoute une section déjà écrite dans un autre Serializer (sans son en-tête).
+             */
+            void appendSection(uint32_t tag, const Serializer& content);
+
+            /** @brief Ouvre un enregistrement de taille variable, à fermer par endRecord.
+             *  @return L'indice de l'enregistrement, à passer à record() en lecture.
+             */
+            uint32_t beginRecord();
+            void endRecord();
+
+            const std::vector<uint8_t>& getBuffer() const { return m_buffer; };
+
+            /** @brief Écrit le snapshot dans un fichier temporaire puis le renomme : un snapshot
+             *  interrompu ne remplace jamais le précédent.
+             *  @throw std::runtime_error si le fichier ne peut pas être écrit.
+             */
+            void writeFile(const std::string& file) const;
+
+            // ------ LECTURE -------
+            template<typename T>
+            T read()
+            {
+                static_assert(std::is_trivially_copyable_v<T>);
+                T value;
+                std::memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+                return value;
+            }
+
+            /** @brief Taille du plus long préfixe de data formé de l'en-tête et de sections complètes :
+             *  un fichier auquel on ajoute des sections et interrompu en cours d'écriture reste lisible jusque là.
+             *  @return 0 si l'en-tête est absent ou invalide.
+             */
+            static size_t completeSize(const void* data, size_t size);
+
+            // Pointeur vers les size prochains octets, sans copie
+            const uint8_t* readBytes(size_t size);
+            std::string readString();
+
+            size_t remaining() const { return m_size - m_cursor; };
+
+            /** @brief Renvoie les sections d'étiquette tag, dans l'ordre du fichier.
+             */
+            std::vector<Serializer> sections(uint32_t tag) const;
+
+            /** @brief Renvoie la première section d'étiquette tag.
+             *  @throw std::runtime_error si elle n'existe pas.
+             */
+            Serializer section(uint32_t tag) const;
+
+            /** @brief Renvoie l'enregistrement index d'une section écrite avec beginRecord.
+             *  La table des enregistrements est construite au premier appel.
+             */
+            Serializer record(uint32_t index);
+
+            /** @brief Section des génomes associée à une section d'entités (voir AntIA).
+             */
+            void setGenomes(Serializer* genomes) { m_genomes = genomes; };
+            Serializer& genomes() const;
+
         private:
-            const int m_version;
+            // Lecteur sur un bloc déjà validé
+            Serializer(const uint8_t* data, size_t size, int version);
+
+            void pad();
+
+            int m_version;
+
+            // Écriture
+            std::vector<uint8_t> m_buffer;
+            size_t m_sectionStart = 0;      // Position de la taille de la section ouverte, 0 si aucune
+            size_t m_recordStart = 0;       // Position de la taille de l'enregistrement ouvert
+            uint32_t m_recordCount = 0;
+
+            // Lecture
+            const uint8_t* m_data = nullptr;
+            size_t m_size = 0;
+            size_t m_cursor = 0;
+            std::vector<size_t> m_records;  // Position de chaque enregistrement
+
+            Serializer* m_genomes = nullptr;
     };
 
     /**
@@ -28,14 +172,46 @@ namespace simu
          * @brief Construit l'objet au moment d'être chargé
          * @param Serializer étant le support pour charger l'objet
          */
-        virtual void load(Serializer) = 0;
+        virtual void load(Serializer&) = 0;
 
         /**
          * @brief Sauvegarde les données d'objet
          * @param Serializer étant le support pour écrire l'objet
          */
-        virtual void save(Serializer) = 0; 
+        virtual void save(Serializer&) const = 0;
     };
+
+    /**
+     * @brief Fichier projeté en mémoire en lecture seule (mmap, MapViewOfFile sous Windows).
+     */
+    class MappedFile
+    {
+        public:
+            /** @throw std::runtime_error si le fichier ne peut pas être ouvert.
+             */
+            MappedFile(const std::string& file);
+            ~MappedFile();
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            const void* data() const { return m_data; };
+            size_t size() const { return m_size; };
+
+        private:
+            const void* m_data = nullptr;
+            size_t m_size = 0;
+#ifdef _WIN32
+            void release();
+
+            void* m_file = nullptr;
+            void* m_mapping = nullptr;
+#endif
+    };
+
+    /** @brief Vrai si le fichier commence par l'en-tête d'un snapshot binaire.
+     */
+    bool isSnapshot(const std::string& file);
 }
 
 #endif
@@ -0,0 +1,160 @@
+#include "spatialHash.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+using namespace simu;
+
+void SpatialHash::reset(int gridWidth, int tileSize)
+{
+    m_gridWidth = gridWidth;
+    m_tileSize = tileSize;
+    m_cellsPerRow = std::max(1, (gridWidth + CELL_TILES - 1) / CELL_TILES);
+    m_cellSize = static_cast<float>(std::max(1, tileSize) * CELL_TILES);
+
+    m_cells.assign(m_cellsPerRow * m_cellsPerRow, std::vector<uint32_t>());
+    m_entries.clear();
+    m_count = 0;
+}
+
+void SpatialHash::clear()
+{
+    for(auto& cell : m_cells)
+        cell.clear();
+    m_entries.clear();
+    m_count = 0;
+}
+
+int SpatialHash::cellCoord(float coord) const
+{
+    const float cell = std::floor(coord / m_cellSize);
+    if(!(cell >= 0.f)) // NaN compris
+        return 0;
+    return cell >= m_cellsPerRow ? m_cellsPerRow - 1 : static_cast<int>(cell);
+}
+
+void SpatialHash::unlink(const Entry& entry)
+{
+    std::vector<uint32_t>& cell = m_cells[entry.cell];
+    const uint32_t last = cell.back();
+    cell[entry.slot] = last;
+    m_entries[last].slot = entry.slot;
+    cell.pop_back();
+}
+
+void SpatialHash::move(unsigned long id, Vec2f pos)
+{
+    if(m_cells.empty())
+        return;
+
+    if(id >= m_entries.size())
+        m_entries.resize(id + 1);
+
+    Entry& entry = m_entries[id];
+    entry.pos = pos;
+
+    const int cell = cellOf(pos);
+    if(cell == entry.cell)
+        return;
+
+    if(entry.cell == NONE)
+        m_count++;
+    else
+        unlink(entry);
+
+    entry.cell = cell;
+    entry.slot = m_cells[cell].size();
+    m_cells[cell].push_back(static_cast<uint32_t>(id));
+}
+
+void SpatialHash::remove(unsigned long id)
+{
+    if(!contains(id))
+        return;
+
+    unlink(m_entries[id]);
+    m_entries[id].cell = NONE;
+    m_count--;
+}
+
+void SpatialHash::queryRadius(Vec2f center, float radius, std::vector<unsigned long>& out) const
+{
+    out.clear();
+    const float radius2 = radius * radius;
+    forEachInRect(Vec2f(center.x - radius, center.y - radius), Vec2f(center.x + radius, center.y + radius),
+        [&](unsigned long id, Vec2f pos) {
+            const float dx = pos.x - center.x, dy = pos.y - center.y;
+            if(dx * dx + dy * dy <= radius2)
+                out.push_back(id);
+        });
+}
+
+void SpatialHash::nearest(Vec2f center, size_t k, std::vector<unsigned long>& out, float maxRadius, long ignore) const
+{
+    out.clear();
+    if(k == 0 || m_count == 0)
+        return;
+
+    // Tas max des k meilleurs candidats (distance², ID)
+    static thread_local std::vector<std::pair<float, uint32_t>> heap;
+    heap.clear();
+
+    const float limit = maxRadius < 0.f ? std::numeric_limits<float>::max() : maxRadius * maxRadius;
+    const int cx = cellCoord(center.x);
+    const int cy = cellCoord(center.y);
+
+    auto visit = [&](int x, int y) {
+        if(x < 0 || y < 0 || x >= m_cellsPerRow || y >= m_cellsPerRow)
+            return;
+
+        for(uint32_t id : m_cells[y * m_cellsPerRow + x])
+        {
+            if(static_cast<long>(id) == ignore)
+                continue;
+
+            const float dx = m_entries[id].pos.x - center.x, dy = m_entries[id].pos.y - center.y;
+            const float d2 = dx * dx + dy * dy;
+            if(d2 > limit || (heap.size() == k && d2 >= heap.front().first))
+                continue;
+
+            if(heap.size() == k)
+            {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.pop_back();
+            }
+            heap.emplace_back(d2, id);
+            std::push_heap(heap.begin(), heap.end());
+        }
+    };
+
+    for(int ring = 0; ring < m_cellsPerRow; ring++)
+    {
+        // Les cellules de l'anneau ring sont au moins à ring - 1 cellules de center sur un des axes
+        const float bound = std::max(0, ring - 1) * m_cellSize;
+        if(bound * bound > limit || (heap.size() == k && heap.front().first <= bound * bound))
+            break;
+
+        if(ring == 0)
+        {
+            visit(cx, cy);
+            continue;
+        }
+
+        for(int x = cx - ring; x <= cx + ring; x++)
+        {
+            visit(x, cy - ring);
+            visit(x, cy + ring);
+        }
+        for(int y = cy - ring + 1; y <= cy + ring - 1; y++)
+        {
+            visit(cx - ring, y);
+            visit(cx + ring, y);
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+    for(const auto& candidate : heap)
+        out.push_back(candidate.second);
+}
@@ -0,0 +1,101 @@
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+#include <vector>
+#include <cstdint>
+
+#include "types.h"
+
+namespace simu
+{
+    /**
+     * @brief Index spatial des entités : grille uniforme de cellules alignées sur les tuiles de Grid.
+     *
+     * Chaque cellule couvre CELL_TILES x CELL_TILES tuiles et contient les ID de ses entités.
+     * Une entité qui change de cellule est retirée de l'ancienne par swap and pop, les autres
+     * ne coûtent qu'une comparaison. Les entités hors de la grille sont rangées dans la cellule du bord.
+     * Les requêtes utilisent les positions enregistrées, pas celles des entités : l'index
+     * peut être lu en parallèle pendant que les entités se déplacent.
+     */
+    class SpatialHash
+    {
+        public:
+            static constexpr int CELL_TILES = 4;
+            static constexpr int NONE = -1;
+
+            /** @brief Vide l'index et le dimensionne pour une grille de gridWidth² tuiles de tileSize pixels.
+             */
+            void reset(int gridWidth, int tileSize);
+
+            // Vrai si l'index a été dimensionné pour cette grille
+            bool matches(int gridWidth, int tileSize) const { return gridWidth == m_gridWidth && tileSize == m_tileSize; };
+
+            void clear();
+
+            /** @brief Ajoute l'entité id ou met à jour sa position.
+             */
+            void move(unsigned long id, Vec2f pos);
+            void remove(unsigned long id);
+
+            bool contains(unsigned long id) const { return id < m_entries.size() && m_entries[id].cell != NONE; };
+            size_t size() const { return m_count; };
+
+            /** @brief Appelle f(id, position) pour chaque entité des cellules qui recouvrent le rectangle [min, max].
+             *  Les entités reçues ne sont pas toutes dans le rectangle : le test exact revient à f.
+             */
+            template<typename F>
+            void forEachInRect(Vec2f min, Vec2f max, F&& f) const
+            {
+                if(m_cells.empty())
+                    return;
+
+                const int x0 = cellCoord(min.x), x1 = cellCoord(max.x);
+                const int y0 = cellCoord(min.y), y1 = cellCoord(max.y);
+                for(int y = y0; y <= y1; y++)
+                {
+                    for(int x = x0; x <= x1; x++)
+                    {
+                        for(uint32_t id : m_cells[y * m_cellsPerRow + x])
+                            f(static_cast<unsigned long>(id), m_entries[id].pos);
+                    }
+                }
+            }
+
+            /** @brief Renvoie dans out les entités à une distance (euclidienne) inférieure ou égale à radius de center.
+             */
+            void queryRadius(Vec2f center, float radius, std::vector<unsigned long>& out) const;
+
+            /** @brief Renvoie dans out les k entités les plus proches de center, de la plus proche à la plus éloignée.
+             *  Les cellules sont parcourues par anneaux autour de celle de center jusqu'à ce qu'aucune entité plus
+             *  proche ne puisse se trouver dans l'anneau suivant.
+             *  @param maxRadius Distance maximale des entités renvoyées.
+             *  @param ignore ID d'une entité à ignorer (celle qui fait la requête), NONE pour aucune.
+             */
+            void nearest(Vec2f center, size_t k, std::vector<unsigned long>& out,
+                float maxRadius = -1.f, long ignore = NONE) const;
+
+        private:
+            struct Entry
+            {
+                int cell = NONE;    // Cellule de l'entité, NONE si elle n'est pas dans l'index
+                uint32_t slot = 0;  // Indice de l'entité dans sa cellule
+                Vec2f pos;
+            };
+
+            int cellCoord(float coord) const;
+            int cellOf(Vec2f pos) const { return cellCoord(pos.y) * m_cellsPerRow + cellCoord(pos.x); };
+
+            void unlink(const Entry& entry);
+
+            int m_gridWidth = 0;
+            int m_tileSize = 0;
+            int m_cellsPerRow = 0;
+            float m_cellSize = 1.f; // En pixels
+
+            std::vector<std::vector<uint32_t>> m_cells;
+            std::vector<Entry> m_entries;   // Indexé par ID
+            size_t m_count = 0;
+    };
+}
+
+#endif
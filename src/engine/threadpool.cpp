@@ -0,0 +1,146 @@
+#include "threadpool.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace simu;
+
+ThreadPool::ThreadPool(unsigned int threads) : m_func(nullptr), m_remaining(0), m_job(0), m_stop(false)
+{
+    if(threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for(unsigned int i = 0; i < threads; i++)
+        m_queues.push_back(std::make_unique<Queue>());
+
+    // Le worker 0 est le thread appelant
+    for(unsigned int i = 1; i < threads; i++)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for(auto& thread : m_threads)
+        thread.join();
+}
+
+void ThreadPool::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t, unsigned int)>& func)
+{
+    if(count == 0)
+        return;
+
+    grain = std::max<size_t>(grain, 1);
+    const size_t taskCount = (count + grain - 1) / grain;
+
+    if(m_threads.empty() || taskCount == 1)
+    {
+        for(size_t begin = 0; begin < count; begin += grain)
+            func(begin, std::min(begin + grain, count), 0);
+        return;
+    }
+
+    m_func = &func;
+    m_error = nullptr;
+    m_remaining = taskCount;
+
+    // Chaque worker reçoit une suite contiguë de blocs
+    const size_t workers = m_queues.size();
+    for(size_t t = 0; t < taskCount; t++)
+    {
+        Queue& queue = *m_queues[t * workers / taskCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(Task{t * grain, std::min((t + 1) * grain, count)});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job++;
+    }
+    m_wake.notify_all();
+
+    runTasks(0);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_remaining == 0; });
+    }
+
+    m_func = nullptr;
+    if(m_error)
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+}
+
+void ThreadPool::workerLoop(unsigned int worker)
+{
+    unsigned long job = 0;
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this, job] { return m_stop || m_job != job; });
+            if(m_stop)
+                return;
+            job = m_job;
+        }
+        runTasks(worker);
+    }
+}
+
+void ThreadPool::runTasks(unsigned int worker)
+{
+    Task task;
+    while(pop(worker, task) || steal(worker, task))
+    {
+        try
+        {
+            (*m_func)(task.begin, task.end, worker);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(!m_error)
+                m_error = std::current_exception();
+        }
+
+        if(m_remaining.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::pop(unsigned int worker, Task& task)
+{
+    Queue& queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.tasks.empty())
+        return false;
+
+    task = queue.tasks.front();
+    queue.tasks.pop_front();
+    return true;
+}
+
+bool ThreadPool::steal(unsigned int worker, Task& task)
+{
+    const size_t workers = m_queues.size();
+    for(size_t i = 1; i < workers; i++)
+    {
+        Queue& queue = *m_queues[(worker + i) % workers];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.tasks.empty())
+        {
+            task = queue.tasks.back();
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,82 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <exception>
+
+namespace simu
+{
+    /**
+     * @brief Pool de threads à vol de tâches (work stealing) pour les boucles parallèles.
+     *
+     * Chaque worker possède sa file de blocs : il dépile les siens par le début et vole
+     * ceux des autres par la fin quand il n'a plus rien à faire. Le thread appelant
+     * participe au travail en tant que worker 0.
+     */
+    class ThreadPool
+    {
+        public:
+            /**
+             * @param threads Nombre total de workers, thread appelant compris (0 = nombre de coeurs).
+             */
+            explicit ThreadPool(unsigned int threads = 0);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            /**
+             * @brief Nombre de workers, thread appelant compris.
+             */
+            unsigned int size() const { return m_threads.size() + 1; };
+
+            /**
+             * @brief Découpe [0, count) en blocs d'au plus grain éléments et exécute func(begin, end, worker) sur chacun.
+             * Bloque jusqu'à ce que tous les blocs soient terminés (barrière).
+             * @param worker Indice du worker exécutant le bloc, dans [0, size()).
+             * @throw Relance la première exception levée par func.
+             * @warning Ne pas appeler parallelFor depuis func.
+             */
+            void parallelFor(size_t count, size_t grain, const std::function<void(size_t begin, size_t end, unsigned int worker)>& func);
+
+        private:
+            struct Task
+            {
+                size_t begin;
+                size_t end;
+            };
+
+            struct Queue
+            {
+                std::mutex mutex;
+                std::deque<Task> tasks;
+            };
+
+            void workerLoop(unsigned int worker);
+            void runTasks(unsigned int worker);
+            bool pop(unsigned int worker, Task& task);
+            bool steal(unsigned int worker, Task& task);
+
+            std::vector<std::thread> m_threads;
+            std::vector<std::unique_ptr<Queue>> m_queues;
+
+            const std::function<void(size_t, size_t, unsigned int)>* m_func;
+            std::atomic<size_t> m_remaining;
+            std::exception_ptr m_error;
+
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::condition_variable m_done;
+            unsigned long m_job;
+            bool m_stop;
+    };
+}
+
+#endif
@@ -1,12 +1,18 @@
 #include "tiles.h"
+#include "hpa.h"
 #include "utils.h"
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <iterator>
+
 using namespace simu;
 
 // On utilise le système d'allocation de raylib pour cette class! 
 
 
-Grid::Grid(const int tileSize) : m_gridWidth(0), m_tileSize(tileSize)
+Grid::Grid(const int tileSize) : m_gridWidth(0), m_tileSize(tileSize), m_grid(NULL)
 {
 
 }
@@ -25,19 +31,83 @@ void Grid::unload()
         m_grid = NULL;
     }
     
-    m_updateBuff.clear();
-
+    m_expiry.clear();
+    m_event.clear();
+    m_scheduled.clear();
+    m_wheel.clear();
+    m_fields.clear();
+    m_clusters.reset();
+    m_pheromones.resize(0);
+
+#ifndef SIMU_HEADLESS
     UnloadImage(m_img);
     UnloadTexture(m_tex);
+#endif
 }
 
 void Grid::draw()
 {
+#ifndef SIMU_HEADLESS
     if(m_gridWidth <= 0)
         return;
 
-    // TODO: Utiliser UpdateTextureRec pour mettre à jour que certains pixels
-    UpdateTexture(m_tex, m_img.data);
+    // Regroupe les lignes modifiées consécutives en rectangles
+    m_dirtyRects.clear();
+    float dirtyArea = 0;
+    for(int y = m_dirtyTop; y <= m_dirtyBottom && !m_fullUpload; y++)
+    {
+        if(m_dirtyMin[y] > m_dirtyMax[y])
+            continue;
+
+        Rectangle rect = {(float) m_dirtyMin[y], (float) y, (float) (m_dirtyMax[y] - m_dirtyMin[y] + 1), 1};
+        float covered = rect.width; // Pixels réellement modifiés couverts par rect
+
+        // Fusionne la ligne suivante tant que le rectangle reste rempli au moins à moitié
+        while(y + 1 <= m_dirtyBottom && m_dirtyMin[y + 1] <= m_dirtyMax[y + 1])
+        {
+            const float span = m_dirtyMax[y + 1] - m_dirtyMin[y + 1] + 1;
+            const float left = std::min(rect.x, (float) m_dirtyMin[y + 1]);
+            const float right = std::max(rect.x + rect.width, (float) m_dirtyMax[y + 1] + 1);
+            if((right - left) * (rect.height + 1) > 2 * (covered + span))
+                break;
+
+            y++;
+            rect.x = left;
+            rect.width = right - left;
+            rect.height++;
+            covered += span;
+        }
+
+        m_dirtyRects.push_back(rect);
+        dirtyArea += rect.width * rect.height;
+    }
+
+    if(m_fullUpload || dirtyArea > FULL_UPLOAD_RATIO * getTileNumber())
+        UpdateTexture(m_tex, m_img.data);
+    else
+    {
+        const int pixelSize = GetPixelDataSize(1, 1, m_img.format);
+        const unsigned char* pixels = static_cast<const unsigned char*>(m_img.data);
+
+        for(const Rectangle& rect : m_dirtyRects)
+        {
+            const int x = rect.x, y = rect.y, width = rect.width, height = rect.height;
+            m_upload.resize(width * height * pixelSize);
+            for(int row = 0; row < height; row++)
+                std::memcpy(&m_upload[row * width * pixelSize], pixels + ((y + row) * m_gridWidth + x) * pixelSize, width * pixelSize);
+
+            UpdateTextureRec(m_tex, rect, m_upload.data());
+        }
+    }
+
+    for(int y = m_dirtyTop; y <= m_dirtyBottom; y++)
+    {
+        m_dirtyMin[y] = m_gridWidth;
+        m_dirtyMax[y] = -1;
+    }
+    m_dirtyTop = m_gridWidth;
+    m_dirtyBottom = -1;
+    m_fullUpload = false;
 
     const int gridWidthPixel = getTileSize() * m_gridWidth;
     DrawTexturePro(m_tex, (Rectangle) {0, 0, (float) m_tex.width, (float) m_tex.width}, 
@@ -50,37 +120,121 @@ void Grid::draw()
         DrawLine(i*m_tileSize, 0, i*m_tileSize, m_tileSize*m_gridWidth, GRID_COLOR);
         DrawLine(0, i*m_tileSize, m_tileSize*m_gridWidth, i*m_tileSize, GRID_COLOR);
     }
+#endif
 }
 
 void Grid::update()
 {
-    for(auto it = m_updateBuff.begin(); it != m_updateBuff.end(); it++)
+    m_tick++;
+    if(m_wheel.empty())
+        return;
+
+    // Les reprogrammations vont dans d'autres seaux : la durée de vie est inférieure à la taille de la roue
+    m_firing.swap(m_wheel[m_tick % DECAY_WHEEL_SIZE]);
+    for(int index : m_firing)
     {
-        int index = *it;
-        Tile* tile = &m_grid[index];
+        // Entrée remplacée par une entrée plus proche
+        if(!(m_scheduled[index / 64] >> (index % 64) & 1) || m_event[index] != m_tick)
+            continue;
+        m_scheduled[index / 64] &= ~(uint64_t(1) << (index % 64));
+
+        if(!(flagsOf(m_grid[index]) & UPDATABLE))
+            continue;
 
-        switch(tile->type)
+        if(static_cast<int32_t>(m_tick - m_expiry[index]) >= 0)
         {
-            case Type::PHEROMONE:
-               
-                if(tile->color.a <= 0)
-                {
-                    setTile(AIR, index);
-                    erase(m_updateBuff, it);
-                    it--;
-                }else
-                {
-                    tile->color.a -= 1;
-                    setTile(*tile, index);
-                }
-            break;
-            default:
-                erase(m_updateBuff, it);
-                it--;
+            setTile(AIR, index);
+            continue;
         }
+
+#ifndef SIMU_HEADLESS
+        Color color = tileOf(m_grid[index]).color;
+        color.a = intensityAt(index);
+        ImageDrawPixel(&m_img, index % m_gridWidth, index / m_gridWidth, color);
+        markDirty(index % m_gridWidth, index / m_gridWidth);
+#endif
+        schedule(index, nextDecayEvent(index));
     }
+    m_firing.clear();
+}
+
+void Grid::resetDecay()
+{
+    m_expiry.assign(getTileNumber(), 0);
+    m_event.assign(getTileNumber(), 0);
+    m_scheduled.assign((getTileNumber() + 63) / 64, 0);
+    m_wheel.assign(DECAY_WHEEL_SIZE, std::vector<int>());
+}
+
+void Grid::schedule(int index, uint32_t tick)
+{
+    uint64_t& word = m_scheduled[index / 64];
+    const uint64_t bit = uint64_t(1) << (index % 64);
+
+    // Déjà inscrite plus tôt : elle sera reprogrammée à ce moment là
+    if((word & bit) && static_cast<int32_t>(tick - m_event[index]) >= 0)
+        return;
+
+    word |= bit;
+    m_event[index] = tick;
+    m_wheel[tick % DECAY_WHEEL_SIZE].push_back(index);
 }
 
+uint32_t Grid::nextDecayEvent(int index) const
+{
+#ifdef SIMU_HEADLESS
+    return m_expiry[index];
+#else
+    const uint32_t draw = m_tick + PHEROMONE_DRAW_STEP;
+    return static_cast<int32_t>(m_expiry[index] - draw) < 0 ? m_expiry[index] : draw;
+#endif
+}
+
+uint8_t Grid::intensityAt(int index) const
+{
+    // La phéromone posée avec l'intensité a au tick t disparaît au tick t + a + 1
+    const int32_t left = static_cast<int32_t>(m_expiry[index] - m_tick) - 1;
+    return left <= 0 ? 0 : static_cast<uint8_t>(std::min(left, 255));
+}
+
+void Grid::applyCommands(std::vector<TileCommand>& commands)
+{
+    std::stable_sort(commands.begin(), commands.end(), [](const TileCommand& c1, const TileCommand& c2) {
+        return c1.order < c2.order;
+    });
+
+    for(const TileCommand& command : commands)
+    {
+        if(command.channel >= 0)
+            m_pheromones.deposit(static_cast<PheromoneChannel>(command.channel), command.x, command.y, command.amount);
+        else
+            setTile(command.tile, command.x, command.y);
+    }
+    commands.clear();
+}
+
+#ifndef SIMU_HEADLESS
+void Grid::markDirty(int x, int y)
+{
+    if(m_fullUpload)
+        return;
+
+    m_dirtyMin[y] = std::min(m_dirtyMin[y], x);
+    m_dirtyMax[y] = std::max(m_dirtyMax[y], x);
+    m_dirtyTop = std::min(m_dirtyTop, y);
+    m_dirtyBottom = std::max(m_dirtyBottom, y);
+}
+
+void Grid::markAllDirty()
+{
+    m_dirtyMin.assign(m_gridWidth, m_gridWidth);
+    m_dirtyMax.assign(m_gridWidth, -1);
+    m_dirtyTop = m_gridWidth;
+    m_dirtyBottom = -1;
+    m_fullUpload = true;
+}
+#endif
+
 bool Grid::isValid(int x, int y) const
 {
     return x >= 0 && x < m_gridWidth && y >= 0 && y < m_gridWidth;
@@ -94,8 +248,24 @@ void Grid::check(int x, int y) const
 
 void Grid::setTile(Tile tile, int index)
 {
-    m_grid[index] = tile;
+    const TileId id = toTileId(tile);
+    if((flagsOf(m_grid[index]) ^ flagsOf(id)) & SOLID)
+    {
+        m_revision++;
+        if(m_clusters)
+            m_clusters->invalidate(index % m_gridWidth, index / m_gridWidth);
+    }
+
+    m_grid[index] = id;
+    if(flagsOf(id) & UPDATABLE)
+    {
+        m_expiry[index] = m_tick + tile.color.a + 1;
+        schedule(index, nextDecayEvent(index));
+    }
+#ifndef SIMU_HEADLESS
     ImageDrawPixel(&m_img, index % m_gridWidth, index / m_gridWidth, tile.color); // Met à jour le buffer de rendu
+    markDirty(index % m_gridWidth, index / m_gridWidth);
+#endif
 }
 
 void Grid::init(int gridWidth)
@@ -106,13 +276,18 @@ void Grid::init(int gridWidth)
     unload();
 
     m_gridWidth = gridWidth;
+    m_revision++;
 
-    m_grid = (Tile*) MemAlloc(getTileNumber() * sizeof(Tile));
-    m_updateBuff.reserve(getTileNumber());
+    m_grid = (TileId*) MemAlloc(getTileNumber() * sizeof(TileId));
+    resetDecay();
+    m_pheromones.resize(m_gridWidth);
 
+#ifndef SIMU_HEADLESS
     m_img = GenImageColor(m_gridWidth, m_gridWidth, WHITE);
     m_tex = LoadTextureFromImage(m_img);
     SetTextureFilter(m_tex, TEXTURE_FILTER_POINT);
+    markAllDirty();
+#endif
 }
 
 Vector2i Grid::toTileCoord(float x, float y) const
@@ -127,6 +302,53 @@ Vec2i Grid::toTileCoord(Vec2f pos) const
     return toTileCoord(pos.x, pos.y);
 }
 
+const std::vector<TileSensors>& Grid::sensors() const
+{
+    // Double vérification : la grille n'est modifiée qu'en dehors des mises à jour parallèles
+    if(m_sensorsRevision.load(std::memory_order_acquire) == m_revision)
+        return m_sensors;
+
+    std::lock_guard<std::mutex> lock(m_sensorsMutex);
+    if(m_sensorsRevision.load(std::memory_order_relaxed) == m_revision)
+        return m_sensors;
+
+    const int width = m_gridWidth;
+    m_sensors.assign(getTileNumber(), TileSensors{});
+
+    // Un balayage par direction : la distance d'une case libre est celle de sa voisine + 1
+    for(int y = 0; y < width; y++)
+    {
+        for(int x = 0; x < width; x++)
+        {
+            const int index = y * width + x;
+            if(isSolid(index))
+                continue;
+            m_sensors[index].wallDistance[SENSOR_LEFT] = 1 + (x > 0 ? m_sensors[index - 1].wallDistance[SENSOR_LEFT] : 0);
+            m_sensors[index].wallDistance[SENSOR_UP] = 1 + (y > 0 ? m_sensors[index - width].wallDistance[SENSOR_UP] : 0);
+        }
+    }
+
+    for(int y = width - 1; y >= 0; y--)
+    {
+        for(int x = width - 1; x >= 0; x--)
+        {
+            const int index = y * width + x;
+            TileSensors& sensors = m_sensors[index];
+            if(!isSolid(index))
+            {
+                sensors.wallDistance[SENSOR_RIGHT] = 1 + (x < width - 1 ? m_sensors[index + 1].wallDistance[SENSOR_RIGHT] : 0);
+                sensors.wallDistance[SENSOR_DOWN] = 1 + (y < width - 1 ? m_sensors[index + width].wallDistance[SENSOR_DOWN] : 0);
+            }
+
+            sensors.solidNeighbours = (!isWalkable(x, y - 1) << SENSOR_UP) | (!isWalkable(x, y + 1) << SENSOR_DOWN) |
+                (!isWalkable(x - 1, y) << SENSOR_LEFT) | (!isWalkable(x + 1, y) << SENSOR_RIGHT);
+        }
+    }
+
+    m_sensorsRevision.store(m_revision, std::memory_order_release);
+    return m_sensors;
+}
+
 void simu::to_json(json &json, const Grid &grid)
 {
     json["width"] = grid.getGridWidth();
@@ -138,7 +360,6 @@ void simu::to_json(json &json, const Grid &grid)
 
 void simu::from_json(const json & json, Grid & grid)
 {
-    // TODO: Ajouter les phéromones dans m_updateBuffer
     auto rowdata = json.at("data");
     
     if(!rowdata.is_string())
@@ -148,10 +369,20 @@ void simu::from_json(const json & json, Grid & grid)
     decompressGrid(grid, data, json.at("width"));
 }
 
+/* Format compressé : l'identifiant de chaque case (1 octet) suivi de l'intensité de chaque phéromone,
+ * dans l'ordre des cases. L'ancien format (un Tile complet par case) est toujours accepté en lecture. */
 void simu::compressGrid(const Grid& grid, std::string& output)
 {
+    const unsigned char* ids = reinterpret_cast<const unsigned char*>(grid.m_grid);
+    std::vector<unsigned char> raw(ids, ids + grid.getTileNumber());
+    for(int index = 0; index < grid.getTileNumber(); index++)
+    {
+        if(grid.m_grid[index] == TileId::PHEROMONE)
+            raw.push_back(grid.intensityAt(index));
+    }
+
     int compressed_len = 0, encoded_len = 0;
-    unsigned char* compressed = CompressData((const unsigned char*)(grid.m_grid), grid.getTileNumber() * sizeof(Tile), &compressed_len);
+    unsigned char* compressed = CompressData(raw.data(), raw.size(), &compressed_len);
     char* encoded = EncodeDataBase64((const unsigned char*)(compressed), compressed_len, &encoded_len);
     encoded = (char*) MemRealloc((void*) (encoded), encoded_len + 1);
     encoded[encoded_len] = '\0';
@@ -168,33 +399,112 @@ void simu::decompressGrid(Grid& grid, std::string &data, int gridWidth)
     unsigned char* decoded = DecodeDataBase64(reinterpret_cast<const unsigned char*>(data.c_str()), &decoded_len);
     unsigned char* decompressed = DecompressData(decoded, decoded_len, &decompressed_len);
     
-    int tilesNumber = decompressed_len / sizeof(Tile);
-    if(gridWidth*gridWidth != tilesNumber) // Test que la grille est bien carré
-        throw std::runtime_error("Impossible de charger la grille: La grille est corrompu");
-    
     if(decoded)
         MemFree(decoded);
 
-    grid.unload();
+    try
+    {
+        grid.loadTiles(decompressed, decompressed ? decompressed_len : 0, gridWidth);
+    }
+    catch(...)
+    {
+        if(decompressed)
+            MemFree(decompressed);
+        throw;
+    }
 
-    grid.m_gridWidth = gridWidth;
-    grid.m_grid = reinterpret_cast<Tile*>(decompressed);
+    MemFree(decompressed);
+}
 
-    grid.m_img = GenImageColor(grid.m_gridWidth, grid.m_gridWidth, WHITE);
-    grid.m_tex = LoadTextureFromImage(grid.m_img);
-    SetTextureFilter(grid.m_tex, TEXTURE_FILTER_POINT);
+void Grid::save(Serializer& s) const
+{
+    int pheromones = 0;
+    for(int index = 0; index < getTileNumber(); index++)
+        pheromones += m_grid[index] == TileId::PHEROMONE;
+
+    // Même disposition que les données brutes de compressGrid, sans compression : lues en place au chargement
+    s.write(static_cast<uint32_t>(m_gridWidth));
+    s.write(static_cast<uint64_t>(getTileNumber() + pheromones));
+    s.writeBytes(m_grid, getTileNumber() * sizeof(TileId));
+    for(int index = 0; index < getTileNumber(); index++)
+    {
+        if(m_grid[index] == TileId::PHEROMONE)
+            s.write(static_cast<uint8_t>(intensityAt(index)));
+    }
+}
 
-    // Update l'image et les phéromones
-    for(int index = 0; index < grid.m_gridWidth*grid.m_gridWidth; index++)
+void Grid::load(Serializer& s)
+{
+    const uint32_t gridWidth = s.read<uint32_t>();
+    const uint64_t len = s.read<uint64_t>();
+    if(gridWidth > 46340 || len > s.remaining() || len > static_cast<uint64_t>(INT32_MAX)) // 46340² < INT32_MAX
+        throw std::runtime_error("Impossible de charger la grille: La grille est corrompu");
+
+    loadTiles(s.readBytes(len), static_cast<int>(len), gridWidth);
+}
+
+void Grid::loadTiles(const unsigned char* data, int len, int gridWidth)
+{
+    const int tilesNumber = gridWidth*gridWidth;
+    const bool legacy = len == tilesNumber * static_cast<int>(sizeof(Tile));
+
+    // Test que la grille est bien carré et que chaque phéromone a son intensité
+    bool valid = data != NULL && gridWidth > 0 && (legacy || len >= tilesNumber);
+    if(valid && !legacy)
+    {
+        int pheromones = 0;
+        for(int index = 0; index < tilesNumber; index++)
+        {
+            valid &= data[index] < static_cast<unsigned char>(TileId::COUNT);
+            pheromones += data[index] == static_cast<unsigned char>(TileId::PHEROMONE);
+        }
+        valid &= len == tilesNumber + pheromones;
+    }
+    else if(valid)
     {
-        const Tile tile = grid.m_grid[index];
-        grid.setTile(tile, index);
-        if(tile.type == Type::PHEROMONE)
+        // Ancien format : toTileId doit trouver le type de chaque tuile
+        for(int index = 0; valid && index < tilesNumber; index++)
         {
-            grid.m_updateBuff.push_back(index);
+            Tile tile;
+            std::memcpy(&tile, data + index * sizeof(Tile), sizeof(Tile));
+            valid = std::any_of(std::begin(TILE_TABLE), std::end(TILE_TABLE), [&tile](const Tile& known) { return known.type == tile.type; });
         }
     }
 
+    if(!valid)
+        throw std::runtime_error("Impossible de charger la grille: La grille est corrompu");
+
+    unload();
+
+    m_gridWidth = gridWidth;
+    m_grid = (TileId*) MemAlloc(tilesNumber * sizeof(TileId));
+    resetDecay();
+    m_pheromones.resize(gridWidth);
+    m_revision++;
+
+#ifndef SIMU_HEADLESS
+    m_img = GenImageColor(m_gridWidth, m_gridWidth, WHITE);
+    m_tex = LoadTextureFromImage(m_img);
+    SetTextureFilter(m_tex, TEXTURE_FILTER_POINT);
+    markAllDirty();
+#endif
+
+    // Update l'image et les phéromones
+    const unsigned char* intensity = data + tilesNumber;
+    for(int index = 0; index < tilesNumber; index++)
+    {
+        Tile tile;
+        if(legacy)
+            std::memcpy(&tile, data + index * sizeof(Tile), sizeof(Tile));
+        else
+        {
+            tile = tileOf(static_cast<TileId>(data[index]));
+            if(tile.type == Type::PHEROMONE)
+                tile.color.a = *intensity++;
+        }
+
+        setTile(tile, index);
+    }
 }
 
 void Grid::fromImage(const std::string& file)
@@ -208,22 +518,32 @@ void Grid::fromImage(const std::string& file)
 
     unload();
 
+#ifndef SIMU_HEADLESS
     m_img = image;
     m_tex = LoadTextureFromImage(m_img);
     SetTextureFilter(m_tex, TEXTURE_FILTER_POINT);
+    markAllDirty();
+#endif
     
-    m_gridWidth = m_img.width;
-    m_grid = (Tile*) MemAlloc(sizeof(Tile) * getTileNumber());
+    m_gridWidth = image.width;
+    m_grid = (TileId*) MemAlloc(sizeof(TileId) * getTileNumber());
+    resetDecay();
+    m_pheromones.resize(m_gridWidth);
+    m_revision++;
 
-    for(int y = 0; y < m_img.height; y++)
+    for(int y = 0; y < image.height; y++)
     {
-        for(int x = 0; x < m_img.width; x++)
+        for(int x = 0; x < image.width; x++)
         {
-            Color color = GetImageColor(m_img, x, y);
+            Color color = GetImageColor(image, x, y);
             Tile tile = fromColor(color);
             setTile<false>(tile, x, y);
         }
     }
+
+#ifdef SIMU_HEADLESS
+    UnloadImage(image); // Pas de buffer de rendu, l'image n'est plus utile
+#endif
 }
 
 Tile simu::fromColor(const Color& color)
@@ -232,6 +552,27 @@ Tile simu::fromColor(const Color& color)
     return *std::find_if(tiles.begin(), tiles.end(), [color](auto t) { return t.color == color;});
 }
 
+TileId simu::toTileId(const Tile& tile)
+{
+    int sameType = -1;
+    for(size_t id = 0; id < static_cast<size_t>(TileId::COUNT); id++)
+    {
+        if(TILE_TABLE[id].type != tile.type)
+            continue;
+
+        if(TILE_TABLE[id].color == tile.color)
+            return static_cast<TileId>(id);
+
+        if(sameType < 0)
+            sameType = id;
+    }
+
+    if(sameType < 0)
+        throw std::invalid_argument("Type de tuile inconnu");
+
+    return static_cast<TileId>(sameType);
+}
+
 bool simu::operator==(const Color &c1, const Color &c2)
 {
     return c1.r == c2.r && c1.g == c2.g && c1.b == c2.b;
@@ -4,8 +4,18 @@
 #include "raylib.h"
 #include "engine.h"
 #include "types.h"
+#include "pheromoneField.h"
+#include "serializer.h"
 #include "../external/json.hpp"
 
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
 namespace simu
 {
     using json = nlohmann::json;
@@ -44,7 +54,6 @@ namespace simu
         };
     };
 
-    // TODO: Optimiser l'occupation en mémoire de la grille 
     struct Tile
     {
         Color color;
@@ -52,20 +61,122 @@ namespace simu
         TileFlags flags;
     };
 
-    const Tile AIR = (Tile) {.color=WHITE, .type=Type::AIR, .flags=NONE};
-    const Tile GROUND = (Tile) {.color=BROWN, .type=Type::GROUND, .flags=SOLID|CARRIABLE};
-    const Tile WALL = (Tile) {.color=BLACK, .type=Type::GROUND, .flags=SOLID|CARRIABLE};// Considère un mur comme le sol (utilisé pour le labyrinthe)
-    const Tile FOOD = (Tile) {.color=GREEN, .type=Type::FOOD, .flags=CARRIABLE|EATABLE};
-    const Tile PHEROMONE = (Tile) {.color=PINK, .type=Type::PHEROMONE, .flags=UPDATABLE};
-    const Tile BORDER = (Tile) {.color=WHITE, .type=Type::BORDER, .flags=SOLID};
-    const Tile CHECKPOINT = (Tile) {.color=GOLD, .type=Type::CHECKPOINT, .flags=0x10};
+    constexpr Tile AIR = {WHITE, Type::AIR, {NONE}};
+    constexpr Tile GROUND = {BROWN, Type::GROUND, {SOLID|CARRIABLE}};
+    constexpr Tile WALL = {BLACK, Type::GROUND, {SOLID|CARRIABLE}};// Considère un mur comme le sol (utilisé pour le labyrinthe)
+    constexpr Tile FOOD = {GREEN, Type::FOOD, {CARRIABLE|EATABLE}};
+    constexpr Tile PHEROMONE = {PINK, Type::PHEROMONE, {UPDATABLE}};
+    constexpr Tile BORDER = {WHITE, Type::BORDER, {SOLID}};
+    constexpr Tile CHECKPOINT = {GOLD, Type::CHECKPOINT, {0x10}};
+
+    /**
+     * @brief Identifiant d'une tuile stocké dans la grille (1 octet par case).
+     * Le type, les flags et la couleur de base sont lus dans TILE_TABLE. Seule l'intensité
+     * (alpha) des phéromones varie d'une case à l'autre, elle est rangée dans un plan séparé.
+     */
+    enum class TileId: uint8_t
+    {
+        AIR,
+        GROUND,
+        WALL,
+        FOOD,
+        PHEROMONE,
+        BORDER,
+        CHECKPOINT,
+        COUNT,
+    };
+
+    constexpr Tile TILE_TABLE[static_cast<size_t>(TileId::COUNT)] = {AIR, GROUND, WALL, FOOD, PHEROMONE, BORDER, CHECKPOINT};
+
+    constexpr const Tile& tileOf(TileId id) { return TILE_TABLE[static_cast<size_t>(id)]; }
+    constexpr uint8_t flagsOf(TileId id) { return tileOf(id).flags.all; }
+
+    /** @brief Renvoie l'identifiant de la tuile : même type et même couleur (alpha ignoré), sinon premier de même type.
+     *  @throw std::invalid_argument si aucune tuile connue n'a ce type.
+     */
+    TileId toTileId(const Tile& tile);
 
     Tile fromColor(const Color& color);
     bool operator==(const Color &c1, const Color &c2);
 
     constexpr Color GRID_COLOR { 130, 130, 130, 115 }; 
 
-    class Grid
+    // Au delà de cette proportion de pixels modifiés, la texture est envoyée en entier
+    constexpr float FULL_UPLOAD_RATIO = 0.5f;
+
+    // Nombre de seaux de la roue de décroissance des phéromones, supérieur à la durée de vie maximale (alpha + 1)
+    constexpr uint32_t DECAY_WHEEL_SIZE = 256;
+
+    // Intervalle en ticks entre deux mises à jour de la couleur d'une phéromone dans le rendu
+    constexpr uint32_t PHEROMONE_DRAW_STEP = 8;
+
+    /**
+     * @brief Écriture de tuile différée, émise pendant la mise à jour parallèle des entités.
+     */
+    struct TileCommand
+    {
+        size_t order;   // Ordre d'application (indice de l'entité émettrice)
+        Tile tile;
+        int x;
+        int y;
+        int8_t channel = -1;    // Canal de PheromoneField à alimenter, -1 pour poser la tuile
+        float amount = 0.f;
+    };
+
+    /**
+     * @brief Algorithme utilisé par Grid::findPath.
+     */
+    enum class PathAlgorithm
+    {
+        ASTAR,  // A* case par case, chemin optimal
+        JPS,    // Jump Point Search 4-connexe, chemin optimal, ne développe que les points de saut
+        HPA,    // A* hiérarchique sur les clusters de la grille, chemin quasi optimal
+    };
+
+    class ClusterGraph;
+
+    /**
+     * @brief Directions des capteurs de Grid::sensors.
+     */
+    enum SensorDirection: uint8_t
+    {
+        SENSOR_UP,
+        SENSOR_DOWN,
+        SENSOR_LEFT,
+        SENSOR_RIGHT,
+    };
+
+    /**
+     * @brief Capteurs précalculés d'une case, indexés par SensorDirection.
+     */
+    struct TileSensors
+    {
+        uint16_t wallDistance[4];   // Nombre de pas jusqu'à la première case solide (bords compris), 0 si la case est solide
+        uint8_t solidNeighbours;    // Bit d à 1 si la voisine dans la direction d est solide
+    };
+
+    /**
+     * @brief Contexte de recherche A* réutilisable : tableaux plats de la taille de la grille et file à seaux.
+     * Les cases ne sont jamais réinitialisées, une case n'est valide que si son tampon vaut la génération
+     * de la recherche courante. Les recherches suivantes n'allouent donc rien et ne hachent rien.
+     * Une instance ne doit être utilisée que par un seul thread à la fois.
+     */
+    struct PathScratch
+    {
+        std::vector<int32_t> g;         // Coût depuis le départ
+        std::vector<int32_t> parent;    // Index de la case précédente
+        std::vector<uint32_t> stamp;    // Génération à laquelle g et parent ont été écrits
+        std::vector<uint32_t> closed;   // Génération à laquelle la case a été développée
+        std::vector<std::vector<int32_t>> buckets; // Seaux indexés par f = g + h (coûts entiers)
+        uint32_t generation = 0;
+        int expanded = 0;               // Nombre de noeuds développés par la dernière recherche
+
+        // Dimensionne le contexte pour tileNumber cases et démarre une nouvelle génération
+        uint32_t begin(int tileNumber);
+        void push(size_t f, int32_t index);
+    };
+
+    class Grid : public Serializable
     {
         public:
             Grid(const int tileSize);
@@ -79,6 +190,12 @@ namespace simu
             friend void to_json(json& json, const Grid& grid);
             friend void from_json(const json& json, Grid& grid);
 
+            /** @brief Snapshot binaire : largeur puis cases brutes (identifiants et intensités des phéromones),
+             *  lues en place au chargement. Mêmes garanties que decompressGrid.
+             */
+            void save(Serializer& s) const override;
+            void load(Serializer& s) override;
+
             /** @brief Charge la grille depuis une image au format supporté par la version de raylib (SVG, PNG, JPG, BMP, GIF...). L'image doit être carré
              *  @param file Chemin et nom du fichier avec extension
              *  @throw std::runtime_eror si le fichier n'est pas trouvé, ne peut pas à être lu, l'extension n'est pas supporté ou que l'image n'est pas carré.
@@ -104,7 +221,11 @@ namespace simu
                         return BORDER;
                 }
                 
-                return m_grid[pos.y*m_gridWidth + pos.x];
+                const int index = pos.y*m_gridWidth + pos.x;
+                Tile tile = tileOf(m_grid[index]);
+                if(m_grid[index] == TileId::PHEROMONE)
+                    tile.color.a = intensityAt(index);
+                return tile;
             }
             
             /** @brief Renvoie une tuile en fonction des coordonnées globales x et y
@@ -140,27 +261,90 @@ namespace simu
             template<bool _check = true>
             void setTile(Tile tile, int x, int y)
             {
+                if(t_deferred) // Mise à jour parallèle: l'écriture est appliquée après la barrière
+                {
+                    t_deferred->push_back(TileCommand{t_deferredOrder, tile, x, y});
+                    return;
+                }
+
                 Tile tileOn = getTile<_check>((Vector2i) {x, y});
                
                 if constexpr(_check) // Si check est activé, sinon il y aurait du avoir une erreur
                     if(tileOn.type == Type::BORDER)
                         return;    
 
-                const int idx = y*m_gridWidth + x; 
-                
-                if(!tileOn.flags.updatable) // Évite d'ajouter un index est déjà présent
-                     m_updateBuff.push_back(idx);
-               
-                setTile(tile, idx);
+                setTile(tile, y*m_gridWidth + x);
+            }
+
+            /** @brief Redirige les setTile du thread courant vers commands au lieu de modifier la grille.
+             *  @param commands Buffer du thread, nullptr pour revenir aux écritures directes.
+             */
+            static void deferWrites(std::vector<TileCommand>* commands) { t_deferred = commands; };
+
+            /** @brief Définit l'ordre d'application des prochaines écritures différées du thread courant.
+             */
+            static void setDeferredOrder(size_t order) { t_deferredOrder = order; };
+
+            /** @brief Dépose amount phéromones du canal sur la case (x, y) du champ continu.
+             *  Pendant la mise à jour parallèle, le dépôt est différé comme setTile.
+             */
+            void depositPheromone(PheromoneChannel channel, int x, int y, float amount)
+            {
+                if(t_deferred)
+                {
+                    t_deferred->push_back(TileCommand{t_deferredOrder, AIR, x, y, static_cast<int8_t>(channel), amount});
+                    return;
+                }
+
+                m_pheromones.deposit(channel, x, y, amount);
             }
 
-            /** @brief Trouve un chemin depuis start a dest. L'algorithme A* est utilisé.
+            PheromoneField& getPheromones() { return m_pheromones; };
+            const PheromoneField& getPheromones() const { return m_pheromones; };
+
+            /** @brief Applique les écritures différées triées par ordre (stable pour un même ordre) puis vide le buffer.
+             */
+            void applyCommands(std::vector<TileCommand>& commands);
+
+            /** @brief Trouve un chemin depuis start a dest. L'algorithme A* est utilisé par défaut.
+             *  Utilise un contexte de recherche propre au thread appelant, peut donc être appelé en parallèle.
+             */
+            std::vector<Vec2i> findPath(Vec2i start, Vec2i dest, PathAlgorithm algorithm = PathAlgorithm::ASTAR) const;
+
+            /** @brief Trouve un chemin depuis start a dest avec le contexte fourni, sans allocation
+             *  si path et scratch ont déjà la capacité nécessaire (A* et JPS).
+             *  Les requêtes HPA sont sérialisées : le graphe des clusters est construit à la première
+             *  requête puis seuls les clusters modifiés par setTile sont reconstruits.
+             *  @param path Reçoit les cases du chemin, de la case précédant dest jusqu'à start.
+             */
+            void findPath(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch,
+                PathAlgorithm algorithm = PathAlgorithm::ASTAR) const;
+
+            /* @brief Renvoie le nombre de case du chemin entre start et dest.
+             * Lit le champ de distance de dest (voir distanceField), A* n'est utilisé que si start est inaccessible.
+             */
+            int pathDistance(Vec2i start, Vec2i dest) const;
+
+            static constexpr uint16_t UNREACHABLE = 0xFFFF;
+
+            /** @brief Renvoie le champ de distance vers target : distance en nombre de cases (4-connexité) de chaque
+             *  tuile jusqu'à target, UNREACHABLE si elle est inaccessible. Indexé par y*largeur + x.
+             *  Le champ est calculé par un BFS au premier appel puis mis en cache jusqu'au prochain changement de révision.
+             *  @warning La référence reste valide tant que la grille n'est pas modifiée.
              */
-            std::vector<Vec2i> findPath(Vec2i start, Vec2i dest);
+            const std::vector<uint16_t>& distanceField(Vec2i target) const;
 
-            /* @brief Renvoie le nombre de case du chemin entre start et dest utilisant A*.
+            /** @brief Révision de la grille, incrémentée à chaque modification de la solidité d'une tuile
+             *  (seule propriété dont dépendent les chemins) et à chaque chargement.
              */
-            int pathDistance(Vec2i start, Vec2i dest);
+            uint64_t getRevision() const { return m_revision; };
+
+            /** @brief Renvoie les capteurs de chaque case, indexés par y*largeur + x. Ils sont recalculés
+             *  au premier appel après un changement de révision, les appels suivants ne prennent pas de verrou
+             *  et peuvent être faits en parallèle.
+             *  @warning La référence reste valide tant que la grille n'est pas modifiée.
+             */
+            const std::vector<TileSensors>& sensors() const;
 
             Vec2i toTileCoord(float x, float y) const;
             Vec2i toTileCoord(Vec2f pos) const;
@@ -178,19 +362,93 @@ namespace simu
         
         private:
 
+            // Valide puis charge les données brutes d'une grille (voir compressGrid), la grille n'est pas modifiée en cas d'erreur
+            void loadTiles(const unsigned char* data, int len, int gridWidth);
+
             // Met à jour le buffer du rendu et la grille. Ne vérifie pas l'index.
             void setTile(Tile, int index); 
 
+            void findPathAStar(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch) const;
+            void findPathJPS(Vec2i start, Vec2i dest, std::vector<Vec2i>& path, PathScratch& scratch) const;
+
+            // Renvoie le prochain point de saut depuis (x, y) dans la direction donnée, -1 s'il n'y en a pas
+            int jumpHorizontal(int x, int y, int dx, int destIndex) const;
+            int jumpVertical(int x, int y, int dy, int destIndex) const;
+
+            // Dimensionne l'état de décroissance des phéromones pour la grille courante et le vide
+            void resetDecay();
+
+            /** @brief Inscrit la case dans la roue pour le tick donné, sauf si elle y est déjà pour un tick antérieur.
+             */
+            void schedule(int index, uint32_t tick);
+
+            // Prochain tick où la phéromone de la case doit être traitée : disparition ou mise à jour du rendu
+            uint32_t nextDecayEvent(int index) const;
+
+            // Intensité (alpha) de la phéromone de la case, déduite de son tick de disparition
+            uint8_t intensityAt(int index) const;
+
+            bool isSolid(int index) const { return flagsOf(m_grid[index]) & SOLID; };
+            bool isWalkable(int x, int y) const { return isValid(x, y) && !isSolid(y*m_gridWidth + x); };
+
             int m_gridWidth;
             int m_tileSize;
 
-            Tile *m_grid;
+            TileId *m_grid;                 // Identifiant de chaque case
 
-            // Buffer pour savoir quelles sont les cases à mettre à jour au lieu de faire du polling sur toutes les cases
-            std::vector<int> m_updateBuff;
+            /* Décroissance des phéromones : au lieu de décrémenter chaque phéromone à chaque tick, on garde
+             * le tick où elle redevient de l'air et l'intensité en est déduite. Les cases sont rangées dans
+             * une roue temporelle indexée par le tick de leur prochain événement, update() ne traite que
+             * le seau du tick courant. */
+            uint32_t m_tick = 0;
+            std::vector<uint32_t> m_expiry;     // Tick de disparition, lu seulement pour TileId::PHEROMONE
+            std::vector<uint32_t> m_event;      // Tick de l'entrée de la case dans la roue
+            std::vector<uint64_t> m_scheduled;  // Bit à 1 si la case a une entrée valide dans la roue
+            std::vector<std::vector<int>> m_wheel;
+            std::vector<int> m_firing;          // Seau en cours de traitement
+
+            PheromoneField m_pheromones;        // Champ continu, indépendant des tuiles PHEROMONE
+
+            struct DistanceField
+            {
+                uint64_t revision;
+                std::vector<uint16_t> distances;
+            };
+
+            uint64_t m_revision = 0;
+
+            // Champs de distance par cible, protégés pour les requêtes parallèles
+            mutable std::unordered_map<Vec2i, DistanceField, VecHasher<int>> m_fields;
+            mutable std::mutex m_fieldsMutex;
+
+            mutable std::vector<TileSensors> m_sensors;
+            mutable std::atomic<uint64_t> m_sensorsRevision{UINT64_MAX};
+            mutable std::mutex m_sensorsMutex;
+
+            // Abstraction hiérarchique pour PathAlgorithm::HPA, construite à la première requête
+            mutable std::unique_ptr<ClusterGraph> m_clusters;
+            mutable std::mutex m_clustersMutex;
+
+            static inline thread_local std::vector<TileCommand>* t_deferred = nullptr;
+            static inline thread_local size_t t_deferredOrder = 0;
+
+#ifndef SIMU_HEADLESS
+            // Marque le pixel (x, y) de m_img comme à envoyer à la texture au prochain draw
+            void markDirty(int x, int y);
+            void markAllDirty();
 
             Texture2D m_tex;    // Buffer de rendu pour optimiser les FPS
             Image m_img;        // Buffer de rendu pour optimiser les FPS 
+
+            // Colonnes modifiées de chaque ligne depuis le dernier envoi (min > max si la ligne est propre)
+            std::vector<int> m_dirtyMin;
+            std::vector<int> m_dirtyMax;
+            int m_dirtyTop = 0;
+            int m_dirtyBottom = -1;
+            bool m_fullUpload = false;
+            std::vector<Rectangle> m_dirtyRects;
+            std::vector<unsigned char> m_upload; // Pixels d'un rectangle, contigus pour UpdateTextureRec
+#endif
     };
 
     void to_json(json& json, const Grid& grid);
@@ -0,0 +1,93 @@
+#ifndef __VISITED_TILES_H__
+#define __VISITED_TILES_H__
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace simu
+{
+    /**
+     * @brief Ensemble des tuiles visitées par une entité : un bit par tuile.
+     *
+     * La grille est découpée en blocs carrés de BLOCK_SIZE² tuiles (un mot de 64 bits par ligne de bloc),
+     * alloués à la première visite d'une de leurs tuiles. Une fourmi qui n'explore qu'une partie d'une
+     * grande grille ne paye que les blocs traversés. Ajout et test en O(1), la taille est tenue à jour.
+     */
+    class VisitedTiles
+    {
+        public:
+            static constexpr int BLOCK_SIZE = 64;
+
+            /** @brief Marque la tuile (x, y) d'une grille de gridWidth² tuiles.
+             *  Si la largeur de grille change, l'ensemble est d'abord vidé.
+             *  @return Vrai si la tuile n'était pas encore visitée, faux si elle l'était ou est hors de la grille.
+             */
+            bool insert(int x, int y, int gridWidth)
+            {
+                if(x < 0 || y < 0 || x >= gridWidth || y >= gridWidth)
+                    return false;
+
+                if(gridWidth != m_gridWidth)
+                    resize(gridWidth);
+
+                const size_t block = (y / BLOCK_SIZE) * m_blocksPerRow + x / BLOCK_SIZE;
+                if(m_blocks[block] == NONE)
+                {
+                    m_blocks[block] = m_words.size() / BLOCK_SIZE;
+                    m_words.resize(m_words.size() + BLOCK_SIZE, 0);
+                }
+
+                uint64_t& word = m_words[m_blocks[block] * BLOCK_SIZE + y % BLOCK_SIZE];
+                const uint64_t bit = uint64_t(1) << (x % BLOCK_SIZE);
+                if(word & bit)
+                    return false;
+
+                word |= bit;
+                m_count++;
+                return true;
+            }
+
+            bool contains(int x, int y) const
+            {
+                if(x < 0 || y < 0 || x >= m_gridWidth || y >= m_gridWidth)
+                    return false;
+
+                const uint32_t block = m_blocks[(y / BLOCK_SIZE) * m_blocksPerRow + x / BLOCK_SIZE];
+                return block != NONE && (m_words[block * BLOCK_SIZE + y % BLOCK_SIZE] >> (x % BLOCK_SIZE)) & 1;
+            }
+
+            // Nombre de tuiles visitées
+            size_t size() const { return m_count; };
+
+            /** @brief Vide l'ensemble en gardant la mémoire des blocs pour les prochaines visites.
+             */
+            void clear()
+            {
+                std::fill(m_blocks.begin(), m_blocks.end(), NONE);
+                m_words.clear();
+                m_count = 0;
+            }
+
+        private:
+            static constexpr uint32_t NONE = UINT32_MAX;
+
+            void resize(int gridWidth)
+            {
+                m_gridWidth = gridWidth;
+                m_blocksPerRow = (gridWidth + BLOCK_SIZE - 1) / BLOCK_SIZE;
+                m_blocks.assign(m_blocksPerRow * m_blocksPerRow, NONE);
+                m_words.clear();
+                m_count = 0;
+            }
+
+            int m_gridWidth = 0;
+            int m_blocksPerRow = 0;
+            std::vector<uint32_t> m_blocks; // Indice de chaque bloc dans m_words (en blocs), NONE s'il n'est pas alloué
+            std::vector<uint64_t> m_words;  // BLOCK_SIZE mots par bloc alloué
+            size_t m_count = 0;
+    };
+}
+
+#endif
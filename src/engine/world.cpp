@@ -4,13 +4,17 @@
 
 #include "utils.h"
 #include "ant.h"
+#include "../NEAT/NetworkCache.h"
 
+#include "../external/json.hpp"
+
+#ifndef SIMU_HEADLESS
 #include "raygui.h"
 
-#include "../external/json.hpp"
 #include "../external/ui/imgui.h"
 #include "../external/ui/rlImGui.h"
 #include "../external/ui/imgui_internal.h"
+#endif
 
 
 using namespace simu;
@@ -27,11 +31,13 @@ void World::init()
 {
     Engine::init();
 
-    m_seed = GetRandomValue(0, std::numeric_limits<int>::max());
-    SetRandomSeed(m_seed);
+    setSeed(m_initSeed ? *m_initSeed : GetRandomValue(0, std::numeric_limits<int>::max()));
 
     clearEntities();
 
+    if(!m_pool)
+        setThreadCount(0);
+
     if(m_level)
         m_level.get()->onInit();
 }
@@ -41,6 +47,34 @@ void World::unload()
     if(m_level)
         m_level.get()->onUnload();
     m_grid.unload();
+    m_pool.reset();
+}
+
+void World::setThreadCount(unsigned int threads)
+{
+    m_pool = std::make_unique<ThreadPool>(threads);
+    m_tileCommands.resize(m_pool->size());
+}
+
+void World::setSeed(unsigned int seed)
+{
+    m_seed = seed;
+    SetRandomSeed(m_seed);
+    RNG::set_run_seed(m_seed);
+    gRng = RNG(m_seed, 0, 0, RngPurpose::WORLD);
+    TraceLog(LOG_INFO, "Graine du monde: %u", m_seed);
+}
+
+void World::setInitSeed(unsigned int seed)
+{
+    m_initSeed = seed;
+}
+
+ThreadPool& World::getThreadPool()
+{
+    if(!m_pool)
+        setThreadCount(0);
+    return *m_pool;
 }
 
 Vector2i World::mouseToGridCoord() const
@@ -65,20 +99,112 @@ Tile World::getSelectedTile() const
     return m_cursorTiles[m_cursorTileIndex];
 }
 
+namespace
+{
+    template<size_t... I>
+    std::unordered_map<std::string, entities_t> makeEntityTypes(std::index_sequence<I...>)
+    {
+        std::unordered_map<std::string, entities_t> types;
+        (types.emplace(std::variant_alternative_t<I, entities_t>().getType(), entities_t(std::in_place_index<I>)), ...);
+        return types;
+    }
+
+    bool isJsonFile(const std::string& filename)
+    {
+        const std::string ext = ".json";
+        return filename.size() >= ext.size() && filename.compare(filename.size() - ext.size(), ext.size(), ext) == 0;
+    }
+}
+
+const entities_t& simu::entityPrototype(const std::string& entity_type)
+{
+    static const std::unordered_map<std::string, entities_t> types = makeEntityTypes(std::make_index_sequence<std::variant_size_v<entities_t>>());
+
+    auto it = types.find(entity_type);
+    if(it == types.end())
+        throw std::runtime_error("Impossible de charger l'entité " + entity_type);
+    return it->second;
+}
+
 void World::save(const std::string& filename)
 {
+    if(isJsonFile(filename))
+    {
+        exportJson(filename);
+        return;
+    }
+
     //TRACELOG(LOG_INFO, "Saving simulation..");
- 
+
+    try
+    {
+        Serializer s(Serializer::VERSION);
+        Serializer genomes(Serializer::VERSION);
+        s.setGenomes(&genomes);
+
+        s.beginSection(Serializer::WORLD);
+        s.write(static_cast<uint32_t>(m_seed));
+        s.endSection();
+
+        s.beginSection(Serializer::GRID);
+        m_grid.save(s);
+        s.endSection();
+
+        // Une section par pool : les enregistrements d'un même type ont tous la même taille
+        for(auto& pool : m_pools)
+        {
+            if(pool->size() == 0)
+                continue;
+
+            s.beginSection(Serializer::ENTITIES);
+            s.writeString(pool->at(0).getType());
+            const size_t recordSizePos = s.tell();
+            s.write(uint32_t(0));
+            s.write(static_cast<uint64_t>(pool->size()));
+
+            size_t recordSize = 0;
+            for(size_t i = 0; i < pool->size(); i++)
+            {
+                const size_t start = s.tell();
+                pool->at(i).save(s);
+
+                if(i == 0)
+                    recordSize = s.tell() - start;
+                else if(s.tell() - start != recordSize)
+                    throw std::runtime_error(std::string("Taille d'enregistrement variable pour ") + pool->at(i).getType());
+            }
+            s.writeAt(recordSizePos, static_cast<uint32_t>(recordSize));
+            s.endSection();
+        }
+
+        s.appendSection(Serializer::GENOMES, genomes);
+
+        if(m_level)
+            m_level.get()->onSave(json::object());
+
+        s.writeFile(filename);
+
+        //TRACELOG(LOG_INFO, "File saved to %s", filename.c_str());
+    } catch(const std::runtime_error& e)
+    {
+        //TRACELOG(LOG_ERROR, "Erreur de sauvegarde du fichier %s: %s", filename, e.what());
+    }
+}
+
+void World::exportJson(const std::string& filename)
+{
     try
     {
         json j;
 
-        for(auto& en : m_entities)
+        for(auto& pool : m_pools)
         {
-            Entity& a = *en.get();
-            json ja;
-            a.save(ja);
-            j["entities"] += ja;
+            for(size_t i = 0; i < pool->size(); i++)
+            {
+                json ja;
+                pool->at(i).save(ja);
+                j["entities"] += ja;
+            }
         }
 
         j["grid"] = m_grid;
@@ -90,8 +216,6 @@ void World::save(const std::string& filename)
         auto file = std::ofstream(filename, std::ios_base::out);
         file << j;
         file.close();
-
-        //TRACELOG(LOG_INFO, "File saved to %s", filename.c_str());
     }catch(const json::exception& e)
     {
         //TRACELOG(LOG_ERROR, "Erreur de chargement du fichier %s: %s", filename, e.what());
@@ -101,64 +225,149 @@ void World::save(const std::string& filename)
 void World::load(const std::string& filename)
 {
     //TRACELOG(LOG_INFO, "Loading file %s", filename.c_str());
-    
+
     try
     {
-        auto file = std::ifstream(filename, std::ios_base::in);
-        
-        json j = json::parse(file);
-        
-        // Lecture des entités
-        auto entities_json = j.at("entities");
-        std::vector<std::shared_ptr<Entity>> entities_tmp;
+        if(isSnapshot(filename))
+            loadSnapshot(filename);
+        else
+            loadJson(filename);
 
-        if(entities_json.is_array())
-        {
-            entities_tmp.resize(entities_json.size());
+        //TRACELOG(LOG_INFO, "Loaded !");
+    } catch(const json::exception& e)
+    {
+        //TRACELOG(LOG_ERROR, "Erreur de chargement du fichier %s: %s", filename, e.what());
+    } catch(const std::runtime_error& e)
+    {
+        //TRACELOG(LOG_ERROR, "Erreur de chargement du fichier %s: %s", filename, e.what());
+    }
+}
+
+void World::loadSnapshot(const std::string& filename)
+{
+    MappedFile file(filename);
+    Serializer s(file.data(), file.size());
+    Serializer genomes = s.section(Serializer::GENOMES);
+
+    const uint32_t seed = s.section(Serializer::WORLD).read<uint32_t>();
 
-            // Instantie la bonne class en fonction du type json
-            for(size_t i = 0; i < entities_json.size(); i++)
+    // Lecture des entités
+    std::vector<entities_t> entities_tmp;
+    for(Serializer& section : s.sections(Serializer::ENTITIES))
+    {
+        section.setGenomes(&genomes);
+
+        const entities_t& prototype = entityPrototype(section.readString());
+        const uint32_t recordSize = section.read<uint32_t>();
+        const uint64_t count = section.read<uint64_t>();
+        if(recordSize == 0 || count != section.remaining() / recordSize)
+            throw std::runtime_error("Impossible de charger les entités: section corrompue");
+
+        entities_tmp.reserve(entities_tmp.size() + count);
+        std::visit([&](const auto& proto) {
+            using EntityType = std::decay_t<decltype(proto)>;
+            for(uint64_t i = 0; i < count; i++)
             {
-                std::string typestr = entities_json[i]["type"];
-                entities_t t = entityFactory(typestr);
-                std::visit([&](auto& e) mutable {
-                    using EntityType = std::decay_t<decltype(e)>;
-                    auto en = std::make_shared<EntityType>(m_entity_cnt++);
-                    auto en_j = entities_json[i];
-                    en.get()->load(en_j);
-                    entities_tmp[i] = en;
-                }, t);
+                // Copie du prototype plutôt qu'une construction par défaut (une AntIA y génèrerait un génome)
+                entities_tmp.emplace_back(std::in_place_type<EntityType>, m_entity_cnt++, proto);
+
+                const size_t remaining = section.remaining();
+                std::get<EntityType>(entities_tmp.back()).load(section);
+                if(remaining - section.remaining() != recordSize)
+                    throw std::runtime_error("Impossible de charger les entités: section corrompue");
             }
-        }
+        }, prototype);
+    }
 
-        // Lecture de la grille
-        j.at("grid").get_to(m_grid);
-        
-        if(j.find("seed") != j.end())
+    // Lecture de la grille, en place dans le fichier projeté
+    Serializer grid = s.section(Serializer::GRID);
+    m_grid.load(grid);
+
+    // Si on arrive ici c'est qu'il n'y a pas eu d'erreurs
+    setSeed(seed);
+    commitEntities(entities_tmp);
+
+    if(m_level)
+        m_level.get()->onLoad(json::object());
+}
+
+void World::loadJson(const std::string& filename)
+{
+    auto file = std::ifstream(filename, std::ios_base::in);
+    
+    json j = json::parse(file);
+    
+    // Lecture des entités
+    auto entities_json = j.at("entities");
+    std::vector<entities_t> entities_tmp;
+
+    if(entities_json.is_array())
+    {
+        entities_tmp.reserve(entities_json.size());
+
+        // Instantie la bonne class en fonction du type json
+        for(size_t i = 0; i < entities_json.size(); i++)
         {
-            m_seed = j.at("seed");
-            SetRandomSeed(m_seed);
+            std::string typestr = entities_json[i]["type"];
+            std::visit([&](const auto& proto) {
+                using EntityType = std::decay_t<decltype(proto)>;
+                entities_tmp.emplace_back(std::in_place_type<EntityType>, m_entity_cnt++, proto);
+                std::get<EntityType>(entities_tmp.back()).load(entities_json[i]);
+            }, entityPrototype(typestr));
         }
+    }
 
-        // Si on arrive ici c'est qu'il n'y a pas eu d'erreurs
-        m_entities.clear();
-        m_entities = std::move(entities_tmp); // On peut altérer la partie
-       
-        if(m_level)
-            m_level.get()->onLoad(j);
+    // Lecture de la grille
+    j.at("grid").get_to(m_grid);
+    
+    if(j.find("seed") != j.end())
+    {
+        setSeed(j.at("seed"));
+    }
 
-        file.close();
+    // Si on arrive ici c'est qu'il n'y a pas eu d'erreurs
+    commitEntities(entities_tmp);
+   
+    if(m_level)
+        m_level.get()->onLoad(j);
 
-        //TRACELOG(LOG_INFO, "Loaded !");
-    } catch(const json::exception& e)
-    {
-        //TRACELOG(LOG_ERROR, "Erreur de chargement du fichier %s: %s", filename, e.what());
-    } catch(const std::runtime_error& e)
+    file.close();
+}
+
+void World::commitEntities(std::vector<entities_t>& entities)
+{
+    for(auto& pool : m_pools) // On peut altérer la partie
+        pool->clear();
+    m_ids.clear();
+    m_spatial.clear();
+    for(auto& en : entities)
     {
-        //TRACELOG(LOG_ERROR, "Erreur de chargement du fichier %s: %s", filename, e.what());
+        std::visit([this](auto& e) {
+            using EntityType = std::decay_t<decltype(e)>;
+            const unsigned long id = e.getId();
+            registerEntity(id, getPool<EntityType>().emplace(false, std::move(e)));
+        }, en);
     }
+    m_networksDirty = true;
+    updateSpatialIndex();
 }
 
+#ifdef SIMU_HEADLESS
+int World::train(const std::string& name, int generations)
+{
+    loadLevel(name);
+
+    return runHeadless([this, generations]() {
+        return !m_level || m_level->getGeneration() >= generations;
+    });
+}
+
+void World::handleMouse() {}
+void World::handleKeyboard() {}
+void World::drawFrame() {}
+void World::drawUI() {}
+void World::drawEntityInfo() {}
+#else
 void World::handleMouse()
 {
     if(ImGui::GetIO().WantCaptureMouse)
@@ -237,10 +446,10 @@ void World::handleKeyboard()
     if(IsKeyPressed(KEY_P)) setPause(!isPaused());
 
     if(IsKeyPressed(KEY_S))
-        save("simu-save.json");
+        save("simu-save.sim");
 
     if(IsKeyPressed(KEY_R))
-        load("simu-save.json");
+        load("simu-save.sim");
     
     if(IsKeyPressed(KEY_SPACE))
     {
@@ -255,9 +464,9 @@ void World::drawFrame()
 {
     m_grid.draw();
 
-    for(auto& en : m_entities)
+    for(auto& pool : m_pools)
     {
-        en->draw();
+        pool->draw();
     }
 
     if(m_level)
@@ -280,18 +489,24 @@ void World::drawUI()
     DrawRectangle(135, GetScreenHeight() - 17, 10, 10, getSelectedTile().color);
 
     // Nombre d'entités
-    DrawText(TextFormat("Entity: %d", m_entities.size()), 0, 100, 20, BLUE);
+    DrawText(TextFormat("Entity: %d", getEntityCount()), 0, 100, 20, BLUE);
 
     ImGui::Begin("World");
     ImGui::Text("Seed: 0x%X", m_seed);
     
     // Sauvegarde et chargement
-    static char saveFileName[128] = "simu-save.json";
+    static char saveFileName[128] = "simu-save.sim";
     ImGui::InputText("##input_file", saveFileName, IM_ARRAYSIZE(saveFileName));
     ImGui::SameLine();
     if(ImGui::Button("Save")) save(saveFileName);
+    ImGui::SameLine();
+    if(ImGui::Button("Export JSON"))
+    {
+        const std::string name = saveFileName;
+        exportJson(name.substr(0, name.find_last_of('.')) + ".json");
+    }
 
-    static char loadFileName[128] = "simu-save.json";
+    static char loadFileName[128] = "simu-save.sim";
     ImGui::InputText("##output_file", loadFileName, IM_ARRAYSIZE(loadFileName));
     ImGui::SameLine();
     if(ImGui::Button("Load")) load(loadFileName);
@@ -354,7 +569,11 @@ void World::drawUI()
 
     if(ImGui::CollapsingHeader("Entity"))
     {
-        ImGui::Text("Entity count: %lld", m_entities.size());
+        ImGui::Text("Entity count: %lld", getEntityCount());
+
+        const NetworkCache& cache = NetworkCache::shared();
+        ImGui::Text("Network cache: %zu/%zu (exact %zu, topology %zu, miss %zu)", cache.size(), cache.capacity(),
+                    cache.exact_hits(), cache.topology_hits(), cache.misses());
     
         if(ImGui::Button("Remove all")) clearEntities();
         
@@ -377,11 +596,11 @@ void World::drawUI()
         if(ImGui::TreeNode("List"))
         {
             ImGuiListClipper clipper; // Evite d'itérer sur toutes les entités
-            clipper.Begin(m_entities.size());
+            clipper.Begin(getEntityCount());
 
             if(m_focus_en_gui && !m_selected_en.expired())
             {
-                const Entity* entity = m_selected_en.lock().get(); 
+                const Entity* entity = m_selected_en.lock(); 
                 clipper.IncludeItemByIndex(entity->getId());
             }
 
@@ -389,7 +608,8 @@ void World::drawUI()
             {
                 for(int row_n = clipper.DisplayStart; row_n < clipper.DisplayEnd; row_n++)
                 {
-                    Entity* entity = m_entities[row_n].get();
+                    EntityHandle<Entity> handle = getEntityByIndex(row_n);
+                    Entity* entity = handle.lock();
 
                     ImGuiTreeNodeFlags nodeFlag = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick;
                     if(!m_selected_en.expired() && (m_selected_en.lock()->getId() == entity->getId()))
@@ -400,7 +620,7 @@ void World::drawUI()
                     if(ImGui::TreeNodeEx((void*) entity->getId(), nodeFlag, "%s Id:%ld", entity->getType(), entity->getId()))
                     {
                         if(ImGui::IsItemFocused()) 
-                            m_selected_en = m_entities[row_n];
+                            m_selected_en = handle;
                         // if(ImGui::Selectable(nodeId)) m_selected_en = m_entities[row_n];
                         // if(ImGui::IsWindowHovered(ImGuiHoveredFlags_ChildWindows) && ImGui::IsMouseClicked(ImGuiPopupFlags_MouseButtonLeft))
 
@@ -437,7 +657,7 @@ void World::drawEntityInfo()
 {
     if(!m_selected_en.expired())
     {
-        const Entity* en = m_selected_en.lock().get();
+        const Entity* en = m_selected_en.lock();
        
         Vec2f enPos = en->getPos();
         Vec2f pos = GetWorldToScreen2D((Vector2){enPos.x, enPos.y}, m_camera);
@@ -472,69 +692,251 @@ void World::drawEntityInfo()
     }
 }
 
-void World::updateTick()
+#endif
+
+void World::evaluateNetworks()
 {
-    m_grid.update();
+    if(m_networksDirty)
+    {
+        m_batchAnts.clear();
+        std::vector<FeedForwardNeuralNetwork*> networks;
+        for(auto& pool : m_pools)
+        {
+            for(size_t i = 0; i < pool->size(); i++)
+            {
+                if(AntIA* ant = dynamic_cast<AntIA*>(&pool->at(i)))
+                {
+                    m_batchAnts.push_back(ant);
+                    networks.push_back(&ant->getNetwork());
+                }
+            }
+        }
 
-    for(size_t i = 0; i < m_entities.size(); i++)
+        m_evaluator.rebuild(networks);
+        m_batchInputs.resize(AntIA::inputCount() * m_batchAnts.size());
+        m_batchOutputs.resize(AntIA::outputCount() * m_batchAnts.size());
+        m_networksDirty = false;
+    }
+
+    const size_t count = m_batchAnts.size();
+    if(count == 0)
+        return;
+
+    m_pool->parallelFor(count, 64, [this, count](size_t begin, size_t end, unsigned int) {
+        std::array<double, AntIA::inputCount()> inputs;
+        for(size_t n = begin; n < end; n++)
+        {
+            m_batchAnts[n]->sense(inputs.data());
+            for(size_t i = 0; i < inputs.size(); i++)
+                m_batchInputs[i * count + n] = inputs[i];
+        }
+    });
+
+    m_evaluator.activate(m_batchInputs.data(), m_batchOutputs.data());
+
+    std::array<double, AntIA::outputCount()> outputs;
+    for(size_t n = 0; n < count; n++)
+    {
+        for(size_t o = 0; o < outputs.size(); o++)
+            outputs[o] = m_batchOutputs[o * count + n];
+        m_batchAnts[n]->setActions(outputs.data());
+    }
+}
+
+void World::updateEntities()
+{
+    // L'ordre d'une écriture différée est l'indice global du premier élément de son bloc :
+    // dans un bloc, les entités sont mises à jour et émettent leurs écritures dans l'ordre
+    size_t order = 0;
+    for(auto& pool : m_pools)
     {
-        auto en = m_entities[i];
-        if(en != nullptr)
+        const size_t count = pool->size();
+        if(pool->isThreadSafe())
         {
-            en->update();
+            const size_t grain = std::max<size_t>(16, count / (m_pool->size() * 4));
+            EntityPoolBase* entities = pool.get();
+
+            m_pool->parallelFor(count, grain, [this, entities, order](size_t begin, size_t end, unsigned int worker) {
+                Grid::deferWrites(&m_tileCommands[worker]);
+                Grid::setDeferredOrder(order + begin);
+                entities->update(begin, end);
+                Grid::deferWrites(nullptr);
+            });
         }
+        order += count;
+    }
+
+    // Application déterministe : ordre des entités, puis ordre d'émission pour une même entité
+    for(size_t worker = 1; worker < m_tileCommands.size(); worker++)
+    {
+        m_tileCommands[0].insert(m_tileCommands[0].end(), m_tileCommands[worker].begin(), m_tileCommands[worker].end());
+        m_tileCommands[worker].clear();
+    }
+    m_grid.applyCommands(m_tileCommands[0]);
+
+    // Les entités non thread safe peuvent ajouter des entités pendant leur update, elles sont
+    // intégrées à leur pool une fois tous les pools mis à jour
+    m_deferSpawns = true;
+    for(size_t p = 0; p < m_pools.size(); p++)
+    {
+        if(!m_pools[p]->isThreadSafe())
+            m_pools[p]->update(0, m_pools[p]->size());
     }
+    m_deferSpawns = false;
+
+    for(auto& pool : m_pools)
+    {
+        if(pool->flush())
+            m_networksDirty = true;
+    }
+}
+
+void World::updateTick()
+{
+    m_grid.update();
+    m_grid.getPheromones().update(m_grid, getThreadPool());
+
+    evaluateNetworks();
+    updateEntities();
 
     if(m_level)
         m_level.get()->onUpdate();
+
+    updateSpatialIndex();
 }
 
 bool World::exist(unsigned long id) const
 {
-    if(m_entities.size() < 0)
-        return false;
+    return id < m_ids.size() && !m_ids[id].expired();
+}
 
-    return std::binary_search(m_entities.begin(), m_entities.end(), nullptr, [id](const std::shared_ptr<Entity>& v1, const std::shared_ptr<Entity>& v2) 
-    {
-        return v1 && v1->getId() < id;
-    });
+size_t World::getEntityCount() const
+{
+    size_t count = 0;
+    for(auto& pool : m_pools)
+        count += pool->size();
+    return count;
 }
 
 bool World::removeEntity(unsigned long id)
 {
-    if(m_entities.size() < 1)
+    if(id >= m_ids.size() || !m_ids[id].getPool() || !m_ids[id].getPool()->erase(m_ids[id]))
         return false;
 
-    auto it = std::lower_bound(m_entities.begin(), m_entities.end(), nullptr, [id](const auto& v1, const auto& v2) {
-        return v1->getId() < id;
-    });
-
-    m_entities.erase(it);
+    m_ids[id].reset();
+    m_spatial.remove(id);
+    m_networksDirty = true;
+    return true;
+}
 
-    if(it != m_entities.end())
+void World::removeEntities(const std::vector<unsigned long>& ids)
+{
+    // Emplacements à supprimer regroupés par pool
+    std::unordered_map<EntityPoolBase*, std::vector<uint32_t>> slots;
+    for(unsigned long id : ids)
     {
-       // if(id == (m_entity_cnt - 1)) // Source de bugs .. avoir plus tard
-       //     m_entity_cnt--; // Maintient l'ordre tout en évitant la limite atteinte (casi impossible)
+        if(id >= m_ids.size() || !m_ids[id].getPool())
+            continue;
+
+        EntityPoolBase* pool = m_ids[id].getPool();
+        const uint32_t slot = pool->slotOf(m_ids[id]);
+        if(slot == UINT32_MAX)
+            continue;
 
-        return true;
+        slots[pool].push_back(slot);
+        m_ids[id].reset();
+        m_spatial.remove(id);
     }
-    return false;
+
+    for(auto& [pool, poolSlots] : slots)
+        pool->removeSlots(poolSlots);
+
+    if(!slots.empty())
+        m_networksDirty = true;
 }
 
-std::weak_ptr<Entity> World::getEntityAt(Vec2f pos)
+EntityHandle<Entity> World::getEntityAt(Vec2f pos)
 {
-    auto en_it = std::find_if(m_entities.begin(), m_entities.end(), [&](const auto& en) {
-        // Distance de manhattan (+ rapide que euclidien car lent pour beaucoup d'entité)
-        return (en.get()->getPos() + Vec2f(2.5f, 2.5f)).manhattan(pos) < 5; 
+    const SpatialHash& index = getSpatialIndex();
+
+    // Les entités font 5 pixels de large : leur centre doit être à moins de 5 (Manhattan) de pos
+    unsigned long found = 0;
+    float best = 5.f;
+    index.forEachInRect(pos - Vec2f(7.5f, 7.5f), pos + Vec2f(2.5f, 2.5f), [&](unsigned long id, Vec2f enPos) {
+        const float distance = (enPos + Vec2f(2.5f, 2.5f)).manhattan(pos);
+        if(distance < best || (distance == best && id < found))
+        {
+            best = distance;
+            found = id;
+        }
     });
 
-    return std::weak_ptr<Entity>(en_it == m_entities.end() ? nullptr : *en_it);
+    return best < 5.f ? m_ids[found] : EntityHandle<Entity>();
+}
+
+std::vector<EntityHandle<Entity>> World::getEntitiesInRadius(Vec2f center, float radius)
+{
+    std::vector<unsigned long> ids;
+    getSpatialIndex().queryRadius(center, radius, ids);
+
+    std::vector<EntityHandle<Entity>> entities(ids.size());
+    for(size_t i = 0; i < ids.size(); i++)
+        entities[i] = m_ids[ids[i]];
+    return entities;
+}
+
+std::vector<EntityHandle<Entity>> World::getNearestEntities(Vec2f center, size_t k, float maxRadius)
+{
+    std::vector<unsigned long> ids;
+    getSpatialIndex().nearest(center, k, ids, maxRadius);
+
+    std::vector<EntityHandle<Entity>> entities(ids.size());
+    for(size_t i = 0; i < ids.size(); i++)
+        entities[i] = m_ids[ids[i]];
+    return entities;
+}
+
+const SpatialHash& World::getSpatialIndex()
+{
+    if(!m_spatial.matches(m_grid.getGridWidth(), m_grid.getTileSize()))
+        updateSpatialIndex();
+    return m_spatial;
+}
+
+void World::updateSpatialIndex()
+{
+    if(!m_spatial.matches(m_grid.getGridWidth(), m_grid.getTileSize()))
+        m_spatial.reset(m_grid.getGridWidth(), m_grid.getTileSize());
+
+    for(auto& pool : m_pools)
+    {
+        for(size_t i = 0; i < pool->size(); i++)
+        {
+            const Entity& entity = pool->at(i);
+            m_spatial.move(entity.getId(), entity.getPos());
+        }
+    }
+}
+
+EntityHandle<Entity> World::getEntityByIndex(size_t index)
+{
+    for(auto& pool : m_pools)
+    {
+        if(index < pool->size())
+            return pool->handle<Entity>(index);
+        index -= pool->size();
+    }
+    return EntityHandle<Entity>();
 }
 
 void World::clearEntities() 
 { 
-    m_entities.clear();
+    for(auto& pool : m_pools)
+        pool->clear();
+    m_ids.clear();
+    m_spatial.clear();
     m_entity_cnt = 0;
+    m_networksDirty = true;
 }
 
 void World::loadLevel(const std::string& name)
@@ -10,12 +10,18 @@
 #include <fstream>
 #include <variant>
 #include <unordered_map>
+#include <typeindex>
 #include <functional>
+#include <tuple>
 
 #include "engine.h"
 #include "entity.h"
+#include "entityPool.h"
+#include "spatialHash.h"
 #include "tiles.h"
 #include "ant.h"
+#include "threadpool.h"
+#include "../NEAT/BatchEvaluator.h"
 
 // #define TEMPLATE_CONDITION(T) std::enable_if_t<std::is_base_of<Entity, T>::value && !std::is_same<Entity, T>::value>
 #define TEMPLATE_CONDITION(T) std::enable_if_t<std::is_base_of<Entity, T>::value>
@@ -32,24 +38,12 @@ namespace simu
     // Liste des entités enregistrés 
     using entities_t = std::variant<AntIA, Test, DemoAnt>;
 
-    template<size_t index = std::variant_size_v<entities_t>>
-    entities_t entityFactory(const std::string& entity_type) {
-        if constexpr (index == 0) {
-            throw std::runtime_error("Impossible de charger l'entité " + entity_type);
-        } else {
-            // On récupère le type courant du variant
-            using current_type = std::variant_alternative_t<index - 1, entities_t>;
-
-            // Si le type courant correspond à entity_type, on retourne une instance de ce type
-            if (current_type().getType() == entity_type) {
-                return current_type();
-            } else {
-                // Sinon, on continue la récursion avec l'index précédent
-                return entityFactory<index - 1>(entity_type);
-            }
-        }
-    }
-
+    /**
+     * @brief Renvoie une instance par défaut du type d'entité enregistré sous ce nom (voir Entity::getType).
+     * La table des types est construite au premier appel.
+     * @throw std::runtime_error si le type n'est pas enregistré
+     */
+    const entities_t& entityPrototype(const std::string& entity_type);
 
     class World : public Engine
     {
@@ -62,32 +56,31 @@ namespace simu
              * @tparam T Type de l'entité (class fille de Entity)
              * @param count Quantité d'entitée à ajouter
              * @param args Les paramètres du constructeur de l'entité
-             * @return La position du premier élément ajouté. Renvoie end() si il y a une erreur (count <= 0)
+             * @return Les handles des entités ajoutées. Vide si il y a une erreur (count <= 0)
              */
             template<class T, typename... Args, class = TEMPLATE_CONDITION(T)>
-            std::vector<std::weak_ptr<T>> spawnEntities(size_t count, const Args&... args)
+            std::vector<EntityHandle<T>> spawnEntities(size_t count, const Args&... args)
             {
                 CHECK_TEMPLATE_ST(T);
 
                 if(count <= 0)
-                    return std::vector<std::weak_ptr<T>>();
+                    return std::vector<EntityHandle<T>>();
 
-                const size_t en_cnt = m_entities.size();
+                EntityPool<T>& pool = getPool<T>();
+                if(!m_deferSpawns)
+                    pool.reserve(count);
 
-                // Redimensionne le vecteur pour ajouter "count" nouveaux éléments
-                m_entities.resize(en_cnt + count); 
-                std::vector<std::weak_ptr<T>> newlies(count);
+                m_ids.resize(m_entity_cnt + count);
 
-                // Itère à partir de l'ancienne fin, jusqu'à la nouvelle fin
+                std::vector<EntityHandle<T>> newlies(count);
                 for (size_t i = 0; i < count; ++i)
                 {
-                    auto en = std::make_shared<T>(m_entity_cnt, args...);
-                    m_entities[en_cnt + i] = en;
-                    newlies[i] = en;
+                    newlies[i] = pool.emplace(m_deferSpawns, m_entity_cnt, args...);
+                    registerEntity(m_entity_cnt, newlies[i]);
                     m_entity_cnt++;
                 }   
+                m_networksDirty = true;
 
-                // Retourne un vecteur de weak_ptr vers les nouvelles entités ajoutées
                 return newlies;
             };
             
@@ -95,44 +88,40 @@ namespace simu
              * @brief Ajoute une entité dans la simulation
              * @tparam T Type de l'entité (class fille de Entity)
              * @param args Les paramètres du constructeur de l'entité
-             * @return Un pointeur vers la fourmis nouvellement crée
+             * @return Un handle vers l'entité nouvellement crée
              */
             template<class T, typename... Args, class = TEMPLATE_CONDITION(T)>
-            std::weak_ptr<T> spawnEntity(Args... args)
+            EntityHandle<T> spawnEntity(Args... args)
             {
                 CHECK_TEMPLATE_ST(T);
 
-                std::shared_ptr<T> en = std::make_shared<T>(m_entity_cnt, args...);
-
-                m_entities.push_back(en);
+                EntityHandle<T> en = getPool<T>().emplace(m_deferSpawns, m_entity_cnt, args...);
+                registerEntity(m_entity_cnt, en);
                 m_entity_cnt++;
+                m_networksDirty = true;
                 
                 return en;
             };
 
+            /**
+             * @brief Renvoie l'entité d'ID id en temps constant.
+             * @return Un handle vide si l'entité n'existe pas ou n'est pas un T.
+             */
             template<class T, class = TEMPLATE_CONDITION(T)>
-            std::weak_ptr<T> getEntity(unsigned long id)
+            EntityHandle<T> getEntity(unsigned long id)
             {
                 CHECK_TEMPLATE_ST(T);
 
-                auto it = std::find_if(m_entities.begin(), m_entities.end(), [id](std::shared_ptr<Entity> en)
-                {
-                    return en.get()->getId() == id;
-                });
-
-                std::weak_ptr<T> ptr;
-                if(it != m_entities.end())
-                {
-                    ptr = std::dynamic_pointer_cast<T>(*it);
-                }
-                return ptr;
+                if(id >= m_ids.size() || !dynamic_cast<T*>(m_ids[id].lock()))
+                    return EntityHandle<T>();
+                return EntityHandle<T>::staticCast(m_ids[id]);
             };
 
             bool exist(unsigned long id) const;
 
-            std::vector<std::weak_ptr<Entity>> getEntities()
+            std::vector<EntityHandle<Entity>> getEntities()
             {
-                return std::vector<std::weak_ptr<Entity>>(m_entities.begin(), m_entities.end());
+                return getEntities<Entity>();
             }
 
             /**
@@ -140,25 +129,45 @@ namespace simu
              * @tparam T Type de l'entité
              */
             template<class T, class = TEMPLATE_CONDITION(T)>
-            std::vector<std::weak_ptr<Entity>> getEntities()
+            std::vector<EntityHandle<T>> getEntities()
             {
-                std::vector<std::weak_ptr<T>> entities;
-                for(auto en: m_entities)
+                std::vector<EntityHandle<T>> entities;
+                for(auto& pool : m_pools)
                 {
-                    if(auto sp = std::dynamic_pointer_cast<T>(en))
+                    for(size_t i = 0; i < pool->size(); i++)
                     {
-                        entities.push_back(sp);
+                        if(dynamic_cast<T*>(&pool->at(i)))
+                            entities.push_back(pool->template handle<T>(i));
                     }
                 }
                 return entities;
             }
 
+            /**
+             * @brief Renvoie le pool contigu des entités de type exact T, créé au premier appel.
+             * Permet d'itérer sur un type d'entité sans appel virtuel ni indirection.
+             */
+            template<class T, class = TEMPLATE_CONDITION(T)>
+            EntityPool<T>& getPool()
+            {
+                CHECK_TEMPLATE_ST(T);
+
+                auto it = m_poolIndex.find(std::type_index(typeid(T)));
+                if(it != m_poolIndex.end())
+                    return static_cast<EntityPool<T>&>(*m_pools[it->second]);
 
-            /** @brief Supprime une entitié en utilisant l'algo binary search. 
+                m_poolIndex[std::type_index(typeid(T))] = m_pools.size();
+                m_pools.push_back(std::make_unique<EntityPool<T>>());
+                return static_cast<EntityPool<T>&>(*m_pools.back());
+            }
+
+            size_t getEntityCount() const;
+
+            /** @brief Supprime une entitié. 
              *  @param id L'ID de l'entité.
              *  @return Renvoie vrai si l'entité à été supprimé et que l'ID existe.
              * 
-             *  @warning A ne pas utiliser dans un update d'une entitié. 
+             *  @warning A ne pas utiliser dans un update d'une entitié. La dernière entité de son pool prend sa place.
              */
             bool removeEntity(unsigned long id);
 
@@ -166,28 +175,34 @@ namespace simu
              *  @tparam T Type d'itérateur
              *  @param beg Début de la liste
              *  @param end Fin de la lite
-             *  @example std::vector<std::weak_ptr<Ant>> en; \
+             *  @example std::vector<EntityHandle<Ant>> en; \
              *  getWorld().removeEntities(en.begin(), en.end())
              */
             template<typename T>
             void removeEntities(T beg, T end)
             {
+                std::vector<unsigned long> ids;
                 for(auto it = beg; it != end; it++)
                 {
-                    if(auto sp = it->lock())
-                    {
-                        removeEntity(sp->getId());
-                    }
+                    if(auto en = it->lock())
+                        ids.push_back(en->getId());
                 }
+                removeEntities(ids);
             }
 
+            /** @brief Supprime les entités d'ID ids. Chaque pool n'est compacté qu'une fois (voir EntityPoolBase::removeSlots).
+             *  @warning A ne pas utiliser dans un update d'une entitié.
+             */
+            void removeEntities(const std::vector<unsigned long>& ids);
+
             /**
              * @brief Enregistre un niveau dans la simulation. Il est préférable de l'appeler avec world.run()
              * @parma name Nom du niveau, doit être unique
+             * @param options Paramètres passés au constructeur du niveau après son nom, à chaque chargement
              * @throw std::runtime_error si le nom est vide ou déjà enregistré 
              */
-            template<class T>
-            void registerLevel(const std::string& name)
+            template<class T, typename... Options>
+            void registerLevel(const std::string& name, Options... options)
             {
                 CHECK_TEMPLATE(T, Level);
                 
@@ -199,8 +214,8 @@ namespace simu
                 
                 TraceLog(LOG_INFO, "Enregistrement du niveau %s", name.c_str());
 
-                m_levels[name] = [name, this]() -> void {
-                    this->m_level = std::make_shared<T>(name);
+                m_levels[name] = [name, this, options = std::make_tuple(std::move(options)...)]() -> void {
+                    this->m_level = std::apply([&name](const auto&... args) { return std::make_shared<T>(name, args...); }, options);
                     this->init();
                 };
             }
@@ -220,13 +235,60 @@ namespace simu
             void clearEntities();
 
             Grid& getGrid() { return m_grid; };
+
+            unsigned int getSeed() const { return m_seed; };
+
+            /**
+             * @brief Définit la graine du monde : graine de raylib et graine du run des flux RNG (NEAT et entités).
+             * Les entités créées ensuite et les populations construites ensuite en dérivent leurs flux.
+             */
+            void setSeed(unsigned int seed);
+
+            /**
+             * @brief Fixe la graine appliquée par init à chaque chargement de niveau, au lieu d'une graine aléatoire.
+             */
+            void setInitSeed(unsigned int seed);
+
+            /**
+             * @brief Définit le nombre de threads utilisés pour la mise à jour des entités.
+             * @param threads Nombre de threads, 0 pour utiliser tous les coeurs.
+             */
+            void setThreadCount(unsigned int threads);
+
+            /**
+             * @brief Renvoie le pool de threads de la simulation, utilisable par les niveaux hors de la mise à jour des entités.
+             */
+            ThreadPool& getThreadPool();
             
             void init() override;
             void unload() override;
 
+            /**
+             * @brief Sauvegarde la simulation dans un snapshot binaire (voir Serializer), ou en json si l'extension est .json
+             */
             void save(const std::string& file);
+
+            /**
+             * @brief Exporte la simulation au format json, lisible par load()
+             */
+            void exportJson(const std::string& file);
+
+            /**
+             * @brief Charge un snapshot binaire, projeté en mémoire, ou une sauvegarde json.
+             * La simulation n'est pas modifiée si le fichier est invalide.
+             */
             void load(const std::string& file);
 
+#ifdef SIMU_HEADLESS
+            /**
+             * @brief Entraine un niveau sans rendu jusqu'à atteindre le nombre de générations demandé.
+             * @param name Nom du niveau, doit être enregistré
+             * @param generations Nombre de générations à effectuer
+             * @throw std::runtime_error si le niveau n'existe pas
+             */
+            int train(const std::string& name, int generations);
+#endif
+
             /**
              * @brief Renvoie la position de la souris dans la grille
              */
@@ -252,9 +314,27 @@ namespace simu
             /**
              * @brief Cherche une entité à la position indiquée en prennant compte la largeur de l'entité.
              * @param pos Position globale.
-             * @return Renvoie la première entité trouvée pendant l'itération.
+             * @return Renvoie l'entité la plus proche parmi celles qui recouvrent pos.
              */
-            std::weak_ptr<Entity> getEntityAt(Vec2f pos);
+            EntityHandle<Entity> getEntityAt(Vec2f pos);
+
+            /**
+             * @brief Renvoie les entités à une distance inférieure ou égale à radius de center.
+             * Les positions sont celles de la fin du dernier tick (voir getSpatialIndex).
+             */
+            std::vector<EntityHandle<Entity>> getEntitiesInRadius(Vec2f center, float radius);
+
+            /**
+             * @brief Renvoie les k entités les plus proches de center, de la plus proche à la plus éloignée.
+             * @param maxRadius Distance maximale, négative pour ne pas limiter la recherche.
+             */
+            std::vector<EntityHandle<Entity>> getNearestEntities(Vec2f center, size_t k, float maxRadius = -1.f);
+
+            /**
+             * @brief Index spatial des entités, mis à jour à la fin de chaque tick et à chaque ajout ou suppression.
+             * Ses requêtes renvoient des ID sans allocation et peuvent être faites pendant l'update des entités.
+             */
+            const SpatialHash& getSpatialIndex();
 
         private:
             World();
@@ -268,13 +348,64 @@ namespace simu
 
             void drawEntityInfo();
 
+            // Handle de l'entité à l'indice index, les pools étant mis bout à bout
+            EntityHandle<Entity> getEntityByIndex(size_t index);
+
+            void registerEntity(unsigned long id, EntityHandle<Entity> handle)
+            {
+                if(id >= m_ids.size())
+                    m_ids.resize(id + 1);
+                m_ids[id] = handle;
+                m_spatial.move(id, handle.lock()->getPos());
+            }
+
+            // Reporte les positions des entités dans l'index spatial, le redimensionne si la grille a changé
+            void updateSpatialIndex();
+
+            void loadJson(const std::string& file);
+            void loadSnapshot(const std::string& file);
+
+            // Remplace les entités de la simulation par celles chargées
+            void commitEntities(std::vector<entities_t>& entities);
+
+            /**
+             * @brief Évalue en un seul lot les réseaux de toutes les AntIA avant leur update().
+             * Le lot n'est reconstruit que lorsque la liste des entités a changé.
+             */
+            void evaluateNetworks();
+
+            /**
+             * @brief Met à jour en parallèle les pools d'entités thread safe, leurs écritures dans la grille
+             * sont appliquées dans l'ordre des entités après la barrière. Les autres pools sont
+             * ensuite mis à jour dans l'ordre sur le thread principal, leurs ajouts d'entités étant différés.
+             */
+            void updateEntities();
+
             unsigned long m_entity_cnt;
             unsigned int m_seed;
+            std::optional<unsigned int> m_initSeed;
 
             std::shared_ptr<Level> m_level;
-            std::vector<std::shared_ptr<Entity>> m_entities;
 
-            std::weak_ptr<Entity> m_selected_en;
+            // Un pool contigu par type concret d'entité, dans l'ordre de création
+            std::vector<std::unique_ptr<EntityPoolBase>> m_pools;
+            std::unordered_map<std::type_index, size_t> m_poolIndex;
+            // Handle de chaque entité indexé par son ID (les ID sont attribués à la suite), vide si l'entité est supprimée
+            std::vector<EntityHandle<Entity>> m_ids;
+            SpatialHash m_spatial;
+            bool m_deferSpawns = false; // Vrai pendant la mise à jour des entités
+
+            EntityHandle<Entity> m_selected_en;
+
+            // Évaluation groupée des réseaux des AntIA
+            BatchEvaluator m_evaluator;
+            std::vector<AntIA*> m_batchAnts;
+            std::vector<double> m_batchInputs;
+            std::vector<double> m_batchOutputs;
+            bool m_networksDirty = true;
+
+            std::unique_ptr<ThreadPool> m_pool;
+            std::vector<std::vector<TileCommand>> m_tileCommands; // Une file d'écritures différées par worker
 
             std::unordered_map<std::string, std::function<void()>> m_levels;
 
@@ -327,6 +458,9 @@ namespace simu
             const std::string getName() const { return m_name; };
             virtual const std::string getDescription() const { return ""; };
 
+            // Numéro de la génération courante pour les niveaux d'apprentissage
+            virtual int getGeneration() const { return 0; };
+
         private:
             const std::string m_name;
     };
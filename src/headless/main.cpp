@@ -0,0 +1,78 @@
+#include "../engine/world.h"
+
+#include "../simulation/laborer.h"
+#include "../simulation/maze.h"
+#include "../simulation/mazeSpe.h"
+#include "../simulation/minimazeSpe.h"
+#include "../simulation/minimaze.h"
+#include "../simulation/road.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Entrainement sans fenêtre: ./game-headless [niveau] [générations] [threads] [--resume journal] [--seed N]
+// --resume reprend MazeCheckSpe depuis un journal, sinon chaque lancement écrit un nouveau journal
+// --seed fixe la graine du monde pour rejouer un run, la graine utilisée est affichée au chargement du niveau
+int main(int argc, char** argv) {
+    SetTraceLogLevel(LOG_INFO);
+
+    std::vector<std::string> args;
+    std::string resume;
+    unsigned long seed = 0;
+    bool hasSeed = false;
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if(arg == "--resume")
+        {
+            if(++i >= argc)
+            {
+                std::cerr << "--resume attend un fichier journal" << '\n';
+                return 1;
+            }
+            resume = argv[i];
+        }
+        else if(arg == "--seed")
+        {
+            char* end = nullptr;
+            if(++i < argc && argv[i][0] != '-')
+                seed = std::strtoul(argv[i], &end, 10);
+            if(!end || end == argv[i] || *end != '\0')
+            {
+                std::cerr << "--seed attend un entier positif" << '\n';
+                return 1;
+            }
+            hasSeed = true;
+        }
+        else
+            args.push_back(arg);
+    }
+
+    const std::string level = args.size() > 0 ? args[0] : "MazeCheckSpe";
+    const int generations = args.size() > 1 ? std::atoi(args[1].c_str()) : 100;
+    const int threads = args.size() > 2 ? std::atoi(args[2].c_str()) : 0;
+
+    simu::World &world = simu::getWorld();
+    world.registerLevel<Laborer>("Laborer");
+    world.registerLevel<MazeCheck>("MazeCheck");
+    world.registerLevel<Road>("Road");
+    world.registerLevel<MazeCheckSpe>("MazeCheckSpe", resume);
+    world.registerLevel<MiniMaze>("MiniMaze");
+    world.registerLevel<MiniMazeSpe>("MiniMazeSpe");
+
+    world.setThreadCount(threads);
+    if(hasSeed)
+        world.setInitSeed(static_cast<unsigned int>(seed));
+
+    try
+    {
+        return world.train(level, generations);
+    }
+    catch(const std::runtime_error& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+}
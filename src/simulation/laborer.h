@@ -5,28 +5,27 @@
 #include "../engine/types.h"
 #include "../NEAT/Genome.h"
 #include "../NEAT/NeuralNetwork.h"
+#include "../NEAT/NetworkCache.h"
 #include "../NEAT/population.h"
 #include <deque>
 #include <set>
 
 namespace simu
 {
-    RNG gRng;
-
     class LaborerIA : public Ant
     {
     public:
         LaborerIA(const long id, std::vector<Vec2i> *foodPos, Vec2i spawnPos)
             : Ant(id, getWorld().gridToWorld(spawnPos)),
               m_genome(Genome::create_minimal_genome(8, 1, gRng)),
-              m_network(FeedForwardNeuralNetwork::create_from_genome(m_genome)),
+              m_network(NetworkCache::shared().get(m_genome)),
               m_spawnPos(spawnPos),
               m_foodPos(foodPos) {}
 
         LaborerIA(const long id, std::vector<Vec2i> *foodPos, Genome genome, Vec2i spawnPos)
             : Ant(id, getWorld().gridToWorld(spawnPos)),
               m_genome(genome),
-              m_network(FeedForwardNeuralNetwork::create_from_genome(m_genome)),
+              m_network(NetworkCache::shared().get(m_genome)),
               m_spawnPos(spawnPos),
               m_foodPos(foodPos) {}
 
@@ -60,9 +59,9 @@ namespace simu
 
             double max_rotation_speed = 0.1;
             double rotation = (outputs[0] - 0.5) * 0.05;
-            if (gRng.uniform(0.0, 1.0) < 0.02)
+            if (m_rng.uniform(0.0, 1.0) < 0.02)
             {
-                m_angle += gRng.uniform(-0.3, 0.3);
+                m_angle += m_rng.uniform(-0.3, 0.3);
             }
 
             rotate(m_angle += rotation * max_rotation_speed);
@@ -140,7 +139,7 @@ namespace simu
         int m_generation = 0;
 
         Population m_pop;
-        std::vector<std::weak_ptr<LaborerIA>> m_laborers;
+        std::vector<EntityHandle<LaborerIA>> m_laborers;
         std::vector<Vec2i> m_foodPos;
 
     public:
@@ -149,9 +148,11 @@ namespace simu
               m_pop((NeatConfig){.population_size = m_popSize, .num_inputs = 8, .num_outputs = 1}, gRng) {}
 
         const std::string getDescription() const override { return "Apprentissage de récolte de nourriture."; }
+        int getGeneration() const override { return m_generation; }
 
         void onInit() override
         {
+            m_pop.reseed(); // Graine du monde fixée par World::init
             getWorld().getGrid().init(160);
             generateFood();
             m_laborers = getWorld().spawnEntities<LaborerIA>(m_popSize, &m_foodPos, m_spawnPos);
@@ -190,7 +191,7 @@ namespace simu
             TraceLog(LOG_INFO, "Génération terminée n°%d", m_generation);
         }
 
-        double calculFitness(const std::weak_ptr<LaborerIA> ia)
+        double calculFitness(const EntityHandle<LaborerIA> ia)
         {
             if (ia.expired())
                 return 0.0;
@@ -3,6 +3,7 @@
 
 #include "../engine/world.h"
 #include "../engine/ant.h"
+#include "../engine/checkpoint.h"
 #include "../NEAT/population.h"
 #include "../NEAT/ComputeFitness.h"
 #include "../NEAT/Utils.h"
@@ -11,6 +12,8 @@
 #include "../external/ui/imgui.h"
 #include <fstream>
 #include <iostream>
+#include <filesystem>
+#include <ctime>
 
 
 namespace simu
@@ -21,7 +24,7 @@ namespace simu
 
     class MazeCheckSpe: public Level
     {
-      std::vector<std::weak_ptr<AntIA>> ants;
+      std::vector<EntityHandle<AntIA>> ants;
     Population mPop;
     ComputeFitness compute_fitness;
 
@@ -43,25 +46,83 @@ std::vector<double> min_fitness_per_gen; // Fitness minimum par génération
     double initial_distance; // Distance initiale pré-calculée
     NeatConfig config;
 
+    // Journal des générations : celui repris avec resume_file, sinon un nouveau journal par run
+    const std::string resume_file;
+    std::string checkpoint_file;
+    std::unique_ptr<CheckpointWriter> checkpoints;
+
+    // Nom du journal d'un nouveau run : graine et heure de lancement, jamais celui d'un journal existant
+    static std::string newJournalName() {
+        char date[32];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y%m%d-%H%M%S", std::localtime(&now));
+
+        const std::string base = "mazeCheck-" + std::to_string(getWorld().getSeed()) + "-" + date;
+        std::string file = base + ".ckpt";
+        for (int i = 1; std::filesystem::exists(file); i++)
+            file = base + "-" + std::to_string(i) + ".ckpt";
+        return file;
+    }
+
+    // Met de côté un journal illisible : il n'est ni repris ni écrasé
+    static void rotateJournal(const std::string &file, const std::runtime_error &error) {
+        const std::string rotated = file + ".invalid";
+        std::error_code ec;
+        std::filesystem::rename(file, rotated, ec);
+        std::cerr << "Attention: journal " << file << " ignoré (" << error.what() << ")";
+        if (!ec)
+            std::cerr << ", renommé en " << rotated;
+        std::cerr << std::endl;
+    }
+
+    // Ouvre le journal de ce run, sans journal si même un fichier neuf ne peut pas être écrit
+    void openJournal() {
+        for (int attempt = 0; attempt < 2 && !checkpoints; attempt++) {
+            try {
+                checkpoints = std::make_unique<CheckpointWriter>(checkpoint_file);
+            } catch (const std::runtime_error &e) {
+                rotateJournal(checkpoint_file, e);
+            }
+        }
+        if (!checkpoints)
+            std::cerr << "Attention: entraînement sans checkpoint" << std::endl;
+    }
+
 public:
-    MazeCheckSpe(std::string name) : Level(name), mPop((NeatConfig){}, simu::gRng), compute_fitness(simu::gRng) {}
+    /**
+     * @param resumeFile Journal à reprendre au lancement du niveau, vide pour un nouveau run.
+     */
+    MazeCheckSpe(std::string name, std::string resumeFile = "")
+        : Level(name), mPop((NeatConfig){}, simu::gRng), compute_fitness(simu::gRng), resume_file(std::move(resumeFile)) {}
     const std::string getDescription() const override { return "Apprentissage de résolution de labyrinthe avec checkpoint et gestion des espèces."; };
+    int getGeneration() const override { return current_generation; };
 
    void onInit() override {
+        mPop.reseed(); // Graine du monde fixée par World::init
         getWorld().getGrid().fromImage("rsc/mazeCheck.png");
         Vec2i startPos(90, 150);
         Vec2i goalPos(73, 0);
 
-
-        ants = getWorld().spawnEntities<AntIA>(num_ants, startPos);
+        TrainingCheckpoint checkpoint;
+        bool resumed = false;
+        if (current_generation == 0 && !resume_file.empty()) {
+            try {
+                resumed = loadCheckpoint(resume_file, checkpoint);
+                if (!resumed)
+                    std::cerr << "Attention: pas de checkpoint dans " << resume_file << ", nouveau run" << std::endl;
+            } catch (const std::runtime_error &e) {
+                rotateJournal(resume_file, e);
+            }
+        }
+        if (!resumed)
+            ants = getWorld().spawnEntities<AntIA>(num_ants, startPos);
         
         steps_count.resize(num_ants, 0); // Initialiser les compteurs d'étapes
 
         // Calculer le nombre maximal d'actions
         Grid &grid = getWorld().getGrid();
         
-        auto path = grid.findPath(startPos, goalPos);
-        double path_length = static_cast<double>(path.size());
+        double path_length = static_cast<double>(grid.pathDistance(startPos, goalPos));
         max_steps = static_cast<int>(path_length * 1.5);
 
         max_allowed_ticks_during_explo = 26244 / 2;
@@ -69,9 +130,69 @@ public:
 
         initial_distance = path_length;
         current_tick = 0;
+
+        if (!checkpoints) {
+            checkpoint_file = resumed ? resume_file : newJournalName();
+            openJournal();
+        }
+
+        if (resumed)
+            resume(checkpoint);
     }
 
-    void onUnload() override {}
+    // Termine l'écriture des derniers checkpoints
+    void onUnload() override { checkpoints.reset(); }
+
+    /**
+     * Reprend l'entraînement à la fin de la génération sauvegardée : la population et les espèces sont restaurées
+     * avec la fitness de chaque génome, puis la génération suivante est produite comme si le run ne s'était pas arrêté.
+     */
+    void resume(const TrainingCheckpoint &checkpoint) {
+        getWorld().setSeed(checkpoint.runSeed);
+        simu::gRng = RNG(checkpoint.rngKey, checkpoint.rngCounter);
+        mPop.restore(checkpoint.population, checkpoint.species);
+
+        for (const GenerationStats &stats : checkpoint.history) {
+            avg_fitness_per_gen.push_back(stats.average);
+            max_fitness_per_gen.push_back(stats.max);
+            min_fitness_per_gen.push_back(stats.min);
+        }
+
+        ants.clear();
+        for (const neat::Individual &individual : checkpoint.individuals) {
+            ants.push_back(getWorld().spawnEntity<AntIA>(*individual.genome, Vec2i(90, 150)));
+            ants.back().lock()->setFitness(individual.fitness);
+        }
+
+        current_generation = checkpoint.generation;
+        std::cout << "Reprise depuis " << resume_file << " après la génération " << current_generation + 1 << std::endl;
+        nextGeneration(collectGenomes());
+    }
+
+    // Ajoute la génération évaluée au journal, l'écriture se fait en arrière-plan
+    void writeCheckpoint(double avg_fitness, double max_fitness, double min_fitness) {
+        if (!checkpoints)
+            return;
+
+        // Les génomes des fourmis et les espèces sont sérialisés en place par push
+        CheckpointView checkpoint;
+        checkpoint.generation = current_generation;
+        checkpoint.runSeed = getWorld().getSeed();
+        checkpoint.population = mPop.get_state();
+        checkpoint.rngKey = simu::gRng.get_key();
+        checkpoint.rngCounter = simu::gRng.get_counter();
+        checkpoint.species = &mPop.get_species_list();
+
+        checkpoint.individuals.reserve(ants.size());
+        for (const auto &ant : ants) {
+            auto locked_ant = ant.lock();
+            if (!locked_ant) continue;
+
+            checkpoint.individuals.push_back({&locked_ant->getGenome(), locked_ant->getFitness(), true});
+        }
+
+        checkpoints->push(checkpoint, GenerationStats{static_cast<uint64_t>(current_generation), avg_fitness, max_fitness, min_fitness});
+    }
 
     void onDraw() override {
         if (IsKeyPressed(KEY_G)) {
@@ -106,34 +227,20 @@ public:
         current_tick++;
     }
 
-    void speciate() {
-    // Effacer les membres des espèces existantes
-    mPop.clear_species();
-
-    // Parcourir chaque fourmi et son génome
-    for (const auto &ant : ants) {
-        if (ant.expired()) continue;
-
-        auto locked_ant = ant.lock();
-        std::shared_ptr<Genome> genome = std::make_shared<Genome>(locked_ant->getGenome());
-        bool assigned = false;
-
-        // Comparer avec les représentants des espèces existantes
-        for (auto &species : mPop.get_species_list()) {
-            double distance = genome->compute_distance(species.representative, config);
-            if (distance < config.compatibility_threshold) {
-                species.add_member(*genome); // Ajouter le génome à l'espèce
-                assigned = true;
-                break;
-            }
+    // Génomes des fourmis de la génération, partagés par la spéciation et la reproduction
+    std::vector<std::shared_ptr<Genome>> collectGenomes() const {
+        std::vector<std::shared_ptr<Genome>> genomes;
+        genomes.reserve(ants.size());
+        for (const auto &ant : ants) {
+            if (auto locked_ant = ant.lock())
+                genomes.push_back(std::make_shared<Genome>(locked_ant->getGenome()));
         }
+        return genomes;
+    }
 
-        // Si aucune espèce n'est compatible, créer une nouvelle espèce
-        if (!assigned) {
-            mPop.create_new_species(genome);
-        }
+    void speciate(const std::vector<std::shared_ptr<Genome>> &genomes) {
+        mPop.speciate(genomes, getWorld().getThreadPool());
     }
-}
 
 
 
@@ -142,17 +249,16 @@ public:
     double max_fitness = std::numeric_limits<double>::lowest();
     double min_fitness = std::numeric_limits<double>::max();
 
-    for (const auto &ant : ants) {
-        if (ant.expired()) continue;
-
-        auto locked_ant = ant.lock();
-        Vec2i antPos = getWorld().getGrid().toTileCoord((Vec2f)(locked_ant->getPos()));
+    // Évaluation parallèle, puis réduction dans l'ordre des fourmis pour des statistiques déterministes
+    const std::vector<double> fitnesses = compute_fitness.evaluate_lab_all(
+        Vec2i(90, 150), Vec2i(73, 0), getWorld().getGrid(), ants, initial_distance, current_generation, getWorld().getThreadPool()
+    );
 
-        // Calculer la fitness individuelle
-        double fitness = compute_fitness.evaluate_lab(
-            Vec2i(90, 150), Vec2i(73, 0), getWorld().getGrid(), *locked_ant, initial_distance, current_generation
-        );
+    for (size_t i = 0; i < ants.size(); i++) {
+        auto locked_ant = ants[i].lock();
+        if (!locked_ant) continue;
 
+        const double fitness = fitnesses[i];
         total_fitness += fitness;
 
         // Mettre à jour le maximum et le minimum
@@ -178,74 +284,28 @@ public:
               << " - Fitness min: " << min_fitness << std::endl;
 
     // Appeler la spéciation
-    speciate();
+    const std::vector<std::shared_ptr<Genome>> genomes = collectGenomes();
+    speciate(genomes);
 
     mPop.update_species_representatives();
 
+    writeCheckpoint(avg_fitness, max_fitness, min_fitness);
+
     // Réinitialiser pour la prochaine génération
-    nextGeneration();
+    nextGeneration(genomes);
 }
 
 
 
-    void nextGeneration() {
-    std::vector<std::shared_ptr<Genome>> genomes;
-    std::unordered_map<Genome, double> fitness_map;
-
-
-    // Collecter les génomes et leurs fitness
+    void nextGeneration(const std::vector<std::shared_ptr<Genome>> &genomes) {
+    FitnessTable fitnesses;
     for (const auto &ant : ants) {
-        if (!ant.expired()) {
-            auto locked_ant = ant.lock();
-            std::shared_ptr<Genome> genome = std::make_shared<Genome>(locked_ant->getGenome());
-            genomes.push_back(genome);
-            //std::cout << "Ajout du génome " << locked_ant->getGenome() << " avec fitness " << locked_ant->getFitness() << std::endl;
-            fitness_map[locked_ant->getGenome()] = locked_ant->getFitness();
-
-            
-
-
-
-
-        }
-    }
-
-    auto species_list = mPop.get_species_list();
-
-    // Étape 1 : Réinitialiser les espèces
-    for (auto &species : species_list) {
-        species.clear_members();
-    }
-
-    // Étape 2 : Réassigner les génomes aux espèces existantes
-    for (const auto &genome : genomes) {
-        bool assigned = false;
-        for (auto &species : species_list) {
-            if (species.representative.compute_distance(*genome, config) < config.compatibility_threshold) {
-                species.add_member(*genome);
-                assigned = true;
-                break;
-            }
-        }
-
-        // Si aucune espèce existante n'est compatible, créer une nouvelle espèce
-        if (!assigned) {
-            species_list.emplace_back(mPop.generate_next_species_id(), *genome);
-        }
-
-        //std::cout << "Taille de fitness_map: " << fitness_map.size() << std::endl;
-/*
-for (const auto &species : species_list) {
-    std::cout << "Espèce " << species.id << " a " << species.members.size() << " membres." << std::endl;
-}
-*/
-
-
+        if (auto locked_ant = ant.lock())
+            fitnesses.set(locked_ant->getGenome().get_genome_id(), locked_ant->getFitness());
     }
-      std::cerr << "Nombre total d'especes: " << species_list.size() << std::endl;
 
-    // Étape 3 : Générer la nouvelle génération en fonction des espèces
-    auto new_generation = mPop.reproduce_with_speciation(species_list, fitness_map);
+    // Générer la nouvelle génération en fonction des espèces
+    auto new_generation = mPop.next_generation(genomes, fitnesses, getWorld().getThreadPool());
     ants.clear();
     getWorld().clearEntities();
 
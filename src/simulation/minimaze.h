@@ -20,7 +20,7 @@ namespace simu
 
     class MiniMaze: public Level
     {
-   std::vector<std::weak_ptr<AntIA>> ants;
+   std::vector<EntityHandle<AntIA>> ants;
     Population mPop;
     ComputeFitness compute_fitness;
 
@@ -45,8 +45,10 @@ std::vector<double> min_fitness_per_gen; // Fitness minimum par génération
 public:
     MiniMaze(std::string name) : Level(name), mPop((NeatConfig){}, simu::gRng), compute_fitness(simu::gRng) {}
     const std::string getDescription() const override { return "Apprentissage de résolution d'un petit labyrinthe avec checkpoint"; };
+    int getGeneration() const override { return current_generation; };
 
     void onInit() override {
+        mPop.reseed(); // Graine du monde fixée par World::init
         getWorld().getGrid().fromImage("rsc/miniMaze.png");
         
 
@@ -59,8 +61,7 @@ public:
         // Calculer le nombre maximal d'actions
         Grid &grid = getWorld().getGrid();
         
-        auto path = grid.findPath(startPos2, goalPos2);
-        double path_length = static_cast<double>(path.size());
+        double path_length = static_cast<double>(grid.pathDistance(startPos2, goalPos2));
         max_steps = static_cast<int>(path_length * 1.5);
 
         //max_allowed_ticks_during_explo = max_steps * 5;
@@ -111,17 +112,16 @@ public:
     double max_fitness = std::numeric_limits<double>::lowest();
     double min_fitness = std::numeric_limits<double>::max();
 
-    for (const auto &ant : ants) {
-        if (ant.expired()) continue;
+    // Évaluation parallèle, puis réduction dans l'ordre des fourmis pour des statistiques déterministes
+    const std::vector<double> fitnesses = compute_fitness.evaluate_lab_all(
+        Vec2i(41,0), Vec2i(41, 76), getWorld().getGrid(), ants, initial_distance, current_generation, getWorld().getThreadPool()
+    );
 
-        auto locked_ant = ant.lock();
-        Vec2i antPos = getWorld().getGrid().toTileCoord((Vec2f)(locked_ant->getPos()));
-        
-        // Calculer la fitness individuelle
-        double fitness = compute_fitness.evaluate_lab(
-            Vec2i(41,0), Vec2i(41, 76), getWorld().getGrid(), *locked_ant, initial_distance, current_generation
-        );
+    for (size_t i = 0; i < ants.size(); i++) {
+        auto locked_ant = ants[i].lock();
+        if (!locked_ant) continue;
 
+        const double fitness = fitnesses[i];
         total_fitness += fitness;
 
         // Mettre à jour le maximum et le minimum
@@ -19,7 +19,7 @@ namespace simu
 NeatConfig config;
     class Road: public Level
     {
-       std::vector<std::weak_ptr<AntIA>> ants;
+       std::vector<EntityHandle<AntIA>> ants;
     Population mPop;
     ComputeFitness compute_fitness;
 
@@ -43,6 +43,7 @@ std::vector<double> min_fitness_per_gen; // Fitness minimum par génération
 public:
     Road(const std::string& name) : Level(name), mPop((NeatConfig){}, simu::gRng), compute_fitness(simu::gRng) {}
     const std::string getDescription() const override { return "Apprentissage sur une route diagonale"; };
+    int getGeneration() const override { return current_generation; };
 
 /*
     int generate_next_species_id() {
@@ -52,6 +53,7 @@ public:
     */
 
     void onInit() override {
+        mPop.reseed(); // Graine du monde fixée par World::init
         getWorld().getGrid().fromImage("rsc/road.png");
         Vec2i startPos(90, 150);
         Vec2i goalPos(73, 0);
@@ -64,8 +66,7 @@ public:
         // Calculer le nombre maximal d'actions
         Grid &grid = getWorld().getGrid();
         
-        auto path = grid.findPath(startPos, goalPos);
-        double path_length = static_cast<double>(path.size());
+        double path_length = static_cast<double>(grid.pathDistance(startPos, goalPos));
         max_steps = static_cast<int>(path_length * 1.5);
 
         max_allowed_ticks_during_explo = max_steps * 2;
@@ -110,34 +111,20 @@ public:
         current_tick++;
     }
 
-    void speciate() {
-    // Effacer les membres des espèces existantes
-    mPop.clear_species();
-
-    // Parcourir chaque fourmi et son génome
-    for (const auto &ant : ants) {
-        if (ant.expired()) continue;
-
-        auto locked_ant = ant.lock();
-        std::shared_ptr<Genome> genome = std::make_shared<Genome>(locked_ant->getGenome());
-        bool assigned = false;
-
-        // Comparer avec les représentants des espèces existantes
-        for (auto &species : mPop.get_species_list()) {
-            double distance = genome->compute_distance(species.representative, config);
-            if (distance < config.compatibility_threshold) {
-                species.add_member(*genome); // Ajouter le génome à l'espèce
-                assigned = true;
-                break;
-            }
+    // Génomes des fourmis de la génération, partagés par la spéciation et la reproduction
+    std::vector<std::shared_ptr<Genome>> collectGenomes() const {
+        std::vector<std::shared_ptr<Genome>> genomes;
+        genomes.reserve(ants.size());
+        for (const auto &ant : ants) {
+            if (auto locked_ant = ant.lock())
+                genomes.push_back(std::make_shared<Genome>(locked_ant->getGenome()));
         }
+        return genomes;
+    }
 
-        // Si aucune espèce n'est compatible, créer une nouvelle espèce
-        if (!assigned) {
-            mPop.create_new_species(genome);
-        }
+    void speciate(const std::vector<std::shared_ptr<Genome>> &genomes) {
+        mPop.speciate(genomes, getWorld().getThreadPool());
     }
-}
 
 
 
@@ -146,17 +133,16 @@ public:
     double max_fitness = std::numeric_limits<double>::lowest();
     double min_fitness = std::numeric_limits<double>::max();
 
-    for (const auto &ant : ants) {
-        if (ant.expired()) continue;
-
-        auto locked_ant = ant.lock();
-        Vec2i antPos = getWorld().getGrid().toTileCoord((Vec2f)(locked_ant->getPos()));
+    // Évaluation parallèle, puis réduction dans l'ordre des fourmis pour des statistiques déterministes
+    const std::vector<double> fitnesses = compute_fitness.evaluate_lab_all(
+        Vec2i(90, 150), Vec2i(73, 0), getWorld().getGrid(), ants, initial_distance, current_generation, getWorld().getThreadPool()
+    );
 
-        // Calculer la fitness individuelle
-        double fitness = compute_fitness.evaluate_lab(
-            Vec2i(90, 150), Vec2i(73, 0), getWorld().getGrid(), *locked_ant, initial_distance, current_generation
-        );
+    for (size_t i = 0; i < ants.size(); i++) {
+        auto locked_ant = ants[i].lock();
+        if (!locked_ant) continue;
 
+        const double fitness = fitnesses[i];
         total_fitness += fitness;
 
         // Mettre à jour le maximum et le minimum
@@ -182,74 +168,26 @@ public:
               << " - Fitness min: " << min_fitness << std::endl;
 
     // Appeler la spéciation
-    speciate();
+    const std::vector<std::shared_ptr<Genome>> genomes = collectGenomes();
+    speciate(genomes);
 
     mPop.update_species_representatives();
 
     // Réinitialiser pour la prochaine génération
-    nextGeneration();
+    nextGeneration(genomes);
 }
 
 
 
-    void nextGeneration() {
-    std::vector<std::shared_ptr<Genome>> genomes;
-    std::unordered_map<Genome, double> fitness_map;
-
-
-    // Collecter les génomes et leurs fitness
+    void nextGeneration(const std::vector<std::shared_ptr<Genome>> &genomes) {
+    FitnessTable fitnesses;
     for (const auto &ant : ants) {
-        if (!ant.expired()) {
-            auto locked_ant = ant.lock();
-            std::shared_ptr<Genome> genome = std::make_shared<Genome>(locked_ant->getGenome());
-            genomes.push_back(genome);
-            //std::cout << "Ajout du génome " << locked_ant->getGenome() << " avec fitness " << locked_ant->getFitness() << std::endl;
-            fitness_map[locked_ant->getGenome()] = locked_ant->getFitness();
-
-            
-
-
-
-
-        }
-    }
-
-    auto species_list = mPop.get_species_list();
-
-    // Étape 1 : Réinitialiser les espèces
-    for (auto &species : species_list) {
-        species.clear_members();
-    }
-
-    // Étape 2 : Réassigner les génomes aux espèces existantes
-    for (const auto &genome : genomes) {
-        bool assigned = false;
-        for (auto &species : species_list) {
-            if (species.representative.compute_distance(*genome, config) < config.compatibility_threshold) {
-                species.add_member(*genome);
-                assigned = true;
-                break;
-            }
-        }
-
-        // Si aucune espèce existante n'est compatible, créer une nouvelle espèce
-        if (!assigned) {
-            species_list.emplace_back(mPop.generate_next_species_id(), *genome);
-        }
-
-        //std::cout << "Taille de fitness_map: " << fitness_map.size() << std::endl;
-/*
-for (const auto &species : species_list) {
-    std::cout << "Espèce " << species.id << " a " << species.members.size() << " membres." << std::endl;
-}
-*/
-
-
+        if (auto locked_ant = ant.lock())
+            fitnesses.set(locked_ant->getGenome().get_genome_id(), locked_ant->getFitness());
     }
-      std::cerr << "Nombre total d'especes: " << species_list.size() << std::endl;
 
-    // Étape 3 : Générer la nouvelle génération en fonction des espèces
-    auto new_generation = mPop.reproduce_with_speciation(species_list, fitness_map);
+    // Générer la nouvelle génération en fonction des espèces
+    auto new_generation = mPop.next_generation(genomes, fitnesses, getWorld().getThreadPool());
     ants.clear();
     getWorld().clearEntities();
 
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../NEAT/BatchEvaluator.h"
+#include "../NEAT/NeuralNetwork.h"
+#include "../NEAT/Genome.h"
+#include "../NEAT/Mutator.h"
+#include "../NEAT/NeatConfig.h"
+#include "../NEAT/rng.h"
+
+// Les sorties d'un réseau évalué par BatchEvaluator ne dépendent pas du reste du lot
+// et restent à moins de 1e-12 (relatif) de FeedForwardNeuralNetwork::activate.
+// L'empreinte affichée doit être la même pour les builds SSE2, -mavx2 -mfma et -U__SSE2__.
+int main(void)
+{
+    const int inputs = 19;
+    const int outputs = 4;
+    const int count = 37;
+
+    NeatConfig config;
+    std::vector<FeedForwardNeuralNetwork> networks;
+    for (int n = 0; n < count; n++)
+    {
+        RNG rng(42, 0, n, RngPurpose::INIT);
+        Genome genome = Genome::create_minimal_genome(inputs, outputs, rng);
+
+        // Quelques topologies partagées par plusieurs réseaux, d'autres uniques
+        for (int m = 0; m < n % 5; m++)
+            Mutator::mutate(genome, config, rng);
+        networks.push_back(FeedForwardNeuralNetwork::create_from_genome(genome));
+    }
+
+    std::vector<double> in(inputs * count);
+    RNG input_rng(42, 0, 0, RngPurpose::EVALUATION);
+    for (double &x : in)
+        x = input_rng.uniform(-3.0, 3.0);
+
+    // Lot complet
+    std::vector<FeedForwardNeuralNetwork *> all;
+    for (auto &network : networks)
+        all.push_back(&network);
+
+    BatchEvaluator batch;
+    batch.rebuild(all);
+    std::vector<double> out(outputs * count);
+    batch.activate(in.data(), out.data());
+
+    int failures = 0;
+    uint64_t fingerprint = 1469598103934665603ULL;
+    for (int n = 0; n < count; n++)
+    {
+        // Le même réseau seul dans son lot
+        BatchEvaluator alone;
+        alone.rebuild({&networks[n]});
+        std::vector<double> single_in(inputs), single_out(outputs), reference(outputs);
+        for (int i = 0; i < inputs; i++)
+            single_in[i] = in[i * count + n];
+        alone.activate(single_in.data(), single_out.data());
+        networks[n].activate(single_in.data(), reference.data());
+
+        for (int o = 0; o < outputs; o++)
+        {
+            const double value = out[o * count + n];
+            if (std::memcmp(&value, &single_out[o], sizeof(double)) != 0)
+            {
+                std::cout << "Réseau " << n << ", sortie " << o << ": " << value << " dans le lot, " << single_out[o] << " seul" << std::endl;
+                failures++;
+            }
+            if (std::abs(value - reference[o]) > 1e-12 * std::max(1.0, std::abs(reference[o])))
+            {
+                std::cout << "Réseau " << n << ", sortie " << o << ": " << value << " au lieu de " << reference[o] << std::endl;
+                failures++;
+            }
+
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            fingerprint = (fingerprint ^ bits) * 1099511628211ULL;
+        }
+    }
+
+    std::cout << batch.group_count() << " topologies, " << BatchEvaluator::simd_width() << " lignes SIMD, empreinte " << std::hex << fingerprint << std::dec << std::endl;
+    std::cout << (failures ? "ECHEC" : "OK") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,167 @@
+#include <iostream>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "../engine/checkpoint.h"
+#include "../NEAT/Mutator.h"
+#include "../NEAT/NeatConfig.h"
+#include "../NEAT/rng.h"
+
+using namespace simu;
+
+namespace
+{
+    int failures = 0;
+
+    void expect(bool condition, const std::string& what)
+    {
+        if(!condition)
+        {
+            std::cout << what << std::endl;
+            failures++;
+        }
+    }
+
+    // Deux génomes sont égaux si leurs enregistrements binaires le sont
+    bool sameGenome(const Genome& a, const Genome& b)
+    {
+        Serializer sa(Serializer::VERSION), sb(Serializer::VERSION);
+        saveGenome(sa, a);
+        saveGenome(sb, b);
+        return sa.getBuffer() == sb.getBuffer();
+    }
+
+    // Génération déterministe : 12 génomes mutés, répartis en 3 espèces
+    TrainingCheckpoint makeGeneration(uint64_t generation)
+    {
+        NeatConfig config;
+        TrainingCheckpoint checkpoint;
+        checkpoint.generation = generation;
+        checkpoint.runSeed = 1234;
+        checkpoint.population = Population::State{99, generation, static_cast<int>(100 + generation), 7};
+        checkpoint.rngKey = RNG::stream_key(1234, generation, 0, RngPurpose::WORLD);
+        checkpoint.rngCounter = 17 + generation;
+
+        for(int i = 0; i < 12; i++)
+        {
+            RNG rng(1234, generation, i, RngPurpose::INIT);
+            Genome genome = Genome::create_minimal_genome(5, 3, rng);
+            for(int m = 0; m < i % 4; m++)
+                Mutator::mutate(genome, config, rng);
+
+            neat::Individual individual(std::make_shared<Genome>(genome));
+            individual.fitness = generation * 100.0 + i;
+            individual.fitness_computed = true;
+            checkpoint.individuals.push_back(individual);
+        }
+
+        for(int s = 0; s < 3; s++)
+        {
+            checkpoint.species.emplace_back(s, *checkpoint.individuals[s].genome);
+            for(size_t i = s; i < checkpoint.individuals.size(); i += 3)
+                checkpoint.species.back().add_member(checkpoint.individuals[i].genome);
+        }
+        return checkpoint;
+    }
+
+    GenerationStats statsOf(uint64_t generation)
+    {
+        return GenerationStats{generation, generation + 0.5, generation + 1.0, generation * 1.0};
+    }
+
+    void compare(const char* step, const TrainingCheckpoint& loaded, const TrainingCheckpoint& expected, size_t history)
+    {
+        const std::string prefix = std::string(step) + ": ";
+        expect(loaded.generation == expected.generation, prefix + "génération " + std::to_string(loaded.generation));
+        expect(loaded.runSeed == expected.runSeed, prefix + "graine du run");
+        expect(loaded.population.seed == expected.population.seed && loaded.population.generation == expected.population.generation
+            && loaded.population.next_genome_id == expected.population.next_genome_id
+            && loaded.population.next_species_id == expected.population.next_species_id, prefix + "état de la population");
+        expect(loaded.rngKey == expected.rngKey && loaded.rngCounter == expected.rngCounter, prefix + "état du RNG");
+        expect(loaded.history.size() == history, prefix + std::to_string(loaded.history.size()) + " générations dans l'historique");
+
+        expect(loaded.individuals.size() == expected.individuals.size(), prefix + "nombre d'individus");
+        for(size_t i = 0; i < loaded.individuals.size() && i < expected.individuals.size(); i++)
+        {
+            expect(loaded.individuals[i].fitness == expected.individuals[i].fitness, prefix + "fitness de l'individu " + std::to_string(i));
+            expect(sameGenome(*loaded.individuals[i].genome, *expected.individuals[i].genome), prefix + "génome de l'individu " + std::to_string(i));
+        }
+
+        expect(loaded.species.size() == expected.species.size(), prefix + "nombre d'espèces");
+        for(size_t s = 0; s < loaded.species.size() && s < expected.species.size(); s++)
+        {
+            const Species& a = loaded.species[s];
+            const Species& b = expected.species[s];
+            expect(a.id == b.id && sameGenome(a.representative, b.representative), prefix + "représentant de l'espèce " + std::to_string(s));
+            expect(a.members.size() == b.members.size(), prefix + "membres de l'espèce " + std::to_string(s));
+            for(size_t m = 0; m < a.members.size() && m < b.members.size(); m++)
+                expect(a.members[m]->get_genome_id() == b.members[m]->get_genome_id(), prefix + "membre " + std::to_string(m) + " de l'espèce " + std::to_string(s));
+        }
+    }
+}
+
+// Journal : relecture des générations, compactage et fin tronquée par un crash
+int main(void)
+{
+    const std::string file = "checkpointTest.journal";
+    std::remove(file.c_str());
+
+    // Construites une seule fois : les ID de génomes viennent d'un compteur global
+    std::vector<TrainingCheckpoint> generations;
+    for(uint64_t g = 0; g < 9; g++)
+        generations.push_back(makeGeneration(g));
+
+    // 5 générations, compactage toutes les 2 : le journal final est compacté puis complété d'une génération
+    {
+        CheckpointWriter writer(file, 2);
+        for(uint64_t g = 0; g < 5; g++)
+            writer.push(generations[g], statsOf(g));
+    }
+
+    TrainingCheckpoint loaded;
+    expect(loadCheckpoint(file, loaded), "aucune génération relue");
+    compare("5 générations", loaded, generations[4], 5);
+
+    // Compactage juste après la dernière génération : seule elle reste, avec les statistiques de toutes les autres
+    {
+        CheckpointWriter writer(file, 1);
+        writer.push(generations[5], statsOf(5));
+    }
+    expect(loadCheckpoint(file, loaded), "aucune génération relue après compactage");
+    compare("compactage", loaded, generations[5], 6);
+    {
+        MappedFile mapped(file);
+        Serializer journal(mapped.data(), Serializer::completeSize(mapped.data(), mapped.size()));
+        expect(journal.sections(Serializer::CHECKPOINT).size() == 1, "le compactage garde plus d'une génération");
+    }
+
+    // Une génération écrite à moitié est ignorée à la lecture, puis coupée à la réouverture
+    {
+        CheckpointWriter writer(file, 50);
+        writer.push(generations[6], statsOf(6));
+    }
+    const uintmax_t complete = std::filesystem::file_size(file);
+    {
+        CheckpointWriter writer(file, 50);
+        writer.push(generations[7], statsOf(7));
+    }
+    std::filesystem::resize_file(file, complete + (std::filesystem::file_size(file) - complete) / 2);
+
+    expect(loadCheckpoint(file, loaded), "aucune génération relue après troncature");
+    compare("fin tronquée", loaded, generations[6], 7);
+
+    {
+        CheckpointWriter writer(file, 50);
+        expect(std::filesystem::file_size(file) == complete, "la génération tronquée n'est pas coupée à la réouverture");
+        writer.push(generations[8], statsOf(8));
+    }
+    expect(loadCheckpoint(file, loaded), "aucune génération relue après reprise");
+    compare("reprise", loaded, generations[8], 8);
+
+    std::remove(file.c_str());
+
+    std::cout << (failures ? "ECHEC" : "OK") << std::endl;
+    return failures ? 1 : 0;
+}
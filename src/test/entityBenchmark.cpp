@@ -0,0 +1,71 @@
+/*
+ * Mesure l'ajout, la recherche par ID et la suppression de 100k entités.
+ * A compiler avec -DSIMU_HEADLESS (aucune fenêtre n'est ouverte).
+ */
+#include "../engine/world.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+
+using namespace simu;
+
+template<typename F>
+static double measure(F&& f)
+{
+    const auto begin = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = argc > 1 ? std::atoi(argv[1]) : 100000;
+    World& world = getWorld();
+    std::mt19937 rng(42);
+
+    std::vector<unsigned long> ids(count);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::shuffle(ids.begin(), ids.end(), rng);
+
+    // Suppressions une par une dans un ordre aléatoire
+    world.clearEntities();
+    double spawn = measure([&] { world.spawnEntities<DemoAnt>(count, Vec2f(0, 0)); });
+
+    size_t found = 0;
+    double lookup = measure([&] {
+        for(unsigned long id : ids)
+            found += world.exist(id) && world.getEntity<DemoAnt>(id).lock() != nullptr;
+    });
+
+    double remove = measure([&] {
+        for(unsigned long id : ids)
+            world.removeEntity(id);
+    });
+
+    std::printf("%zu entités : ajout %.2f ms, recherche %.2f ms (%zu trouvées), suppression une par une %.2f ms, reste %zu\n",
+        count, spawn, lookup, found, remove, world.getEntityCount());
+
+    // Suppression groupée de la moitié puis du reste
+    world.clearEntities();
+    std::vector<EntityHandle<DemoAnt>> handles = world.spawnEntities<DemoAnt>(count, Vec2f(0, 0));
+    std::shuffle(handles.begin(), handles.end(), rng);
+
+    double half = measure([&] { world.removeEntities(handles.begin(), handles.begin() + count / 2); });
+    bool valid = world.getEntityCount() == count - count / 2;
+    for(size_t i = 0; i < count; i++)
+        valid &= handles[i].expired() == (i < count / 2);
+    for(size_t i = count / 2; i < count; i++)
+        valid &= world.getEntity<DemoAnt>(handles[i].lock()->getId()).lock() == handles[i].lock();
+
+    double rest = measure([&] { world.removeEntities(handles.begin() + count / 2, handles.end()); });
+    valid &= world.getEntityCount() == 0;
+
+    std::printf("suppression groupée : moitié %.2f ms, reste %.2f ms, handles %s\n",
+        half, rest, valid ? "cohérents" : "INCOHÉRENTS");
+
+    return valid && found == count ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <vector>
+
+#include "../engine/entityPool.h"
+#include "../engine/ant.h"
+
+using namespace simu;
+
+namespace
+{
+    int failures = 0;
+
+    // Chaque handle encore valide doit désigner l'entité créée avec cet id, les autres doivent avoir expiré
+    void check(const char* step, const std::vector<EntityHandle<Test>>& handles, const std::vector<bool>& alive)
+    {
+        for(size_t id = 0; id < handles.size(); id++)
+        {
+            Test* entity = handles[id].lock();
+            if(alive[id] != (entity != nullptr) || (entity && entity->getId() != static_cast<long>(id)))
+            {
+                std::cout << step << ": handle " << id << " désigne " << (entity ? entity->getId() : -1) << std::endl;
+                failures++;
+            }
+        }
+    }
+}
+
+// Suppressions pendant que des ajouts sont différés (entités créées pendant une mise à jour)
+int main(void)
+{
+    EntityPool<Test> pool;
+    std::vector<EntityHandle<Test>> handles;
+    std::vector<bool> alive;
+
+    for(long id = 0; id < 8; id++)
+    {
+        handles.push_back(pool.emplace(id >= 5, id));
+        alive.push_back(true);
+    }
+    check("ajouts", handles, alive);
+
+    // Remplace l'entité 1 par la dernière du pool (4), les ajouts différés 5 à 7 ne bougent pas
+    pool.erase(handles[1]);
+    alive[1] = false;
+    check("erase", handles, alive);
+
+    // Un ajout différé ne peut pas être supprimé avant flush
+    if(pool.erase(handles[6]))
+    {
+        std::cout << "erase d'un ajout différé" << std::endl;
+        failures++;
+    }
+
+    // Compactage (plus d'un quart du pool), l'emplacement de l'ajout différé 5 est ignoré.
+    // slotOf refuse les ajouts différés, mais les emplacements sont attribués dans l'ordre : c'est 5
+    pool.removeSlots({pool.slotOf(handles[0]), pool.slotOf(handles[3]), 5, pool.slotOf(handles[4])});
+    alive[0] = alive[3] = alive[4] = false;
+    check("removeSlots", handles, alive);
+
+    handles.push_back(pool.emplace(false, 8L));
+    alive.push_back(true);
+    check("ajout après suppression", handles, alive);
+
+    pool.flush();
+    check("flush", handles, alive);
+    if(pool.size() != 5)
+    {
+        std::cout << "flush: " << pool.size() << " entités au lieu de 5" << std::endl;
+        failures++;
+    }
+
+    pool.erase(handles[5]);
+    alive[5] = false;
+    check("erase après flush", handles, alive);
+
+    std::cout << (failures ? "ECHEC" : "OK") << std::endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+/*
+ * Compare A*, JPS et HPA* (développements et latence) sur les labyrinthes de rsc/.
+ * A compiler avec -DSIMU_HEADLESS (aucune fenêtre n'est ouverte) et à lancer depuis la racine du dépôt.
+ */
+#include "../engine/tiles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace simu;
+
+struct Query
+{
+    Vec2i start;
+    Vec2i dest;
+    int distance;
+};
+
+static const char* name(PathAlgorithm algorithm)
+{
+    switch(algorithm)
+    {
+        case PathAlgorithm::JPS: return "JPS";
+        case PathAlgorithm::HPA: return "HPA*";
+        default: return "A*";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int queryCount = argc > 1 ? std::atoi(argv[1]) : 200;
+    const char* maps[] = {"rsc/maze.png", "rsc/mazeCheck.png", "rsc/miniMaze.png", "rsc/road.png"};
+
+    for(const char* map : maps)
+    {
+        Grid grid(1);
+        grid.fromImage(map);
+
+        // Paires de cases libres reliées, la distance exacte vient du champ BFS
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> coord(0, grid.getGridWidth() - 1);
+        std::vector<Query> queries;
+        for(int tries = 0; (int) queries.size() < queryCount && tries < queryCount * 1000; tries++)
+        {
+            const Vec2i start(coord(rng), coord(rng));
+            const Vec2i dest(coord(rng), coord(rng));
+            if(grid.getTile(start).flags.solid || grid.getTile(dest).flags.solid)
+                continue;
+
+            const uint16_t distance = grid.distanceField(dest)[start.y * grid.getGridWidth() + start.x];
+            if(distance != Grid::UNREACHABLE)
+                queries.push_back(Query{start, dest, distance});
+        }
+
+        if(queries.empty())
+        {
+            std::fprintf(stderr, "%s : aucune paire de cases libres reliées, rien à mesurer\n", map);
+            return 1;
+        }
+
+        std::printf("%s (%dx%d, %zu requêtes)\n", map, grid.getGridWidth(), grid.getGridWidth(), queries.size());
+
+        for(PathAlgorithm algorithm : {PathAlgorithm::ASTAR, PathAlgorithm::JPS, PathAlgorithm::HPA})
+        {
+            PathScratch scratch;
+            std::vector<Vec2i> path;
+            long expanded = 0;
+            long length = 0;
+            long optimal = 0;
+            int wrong = 0;
+
+            // Construit le graphe des clusters hors mesure
+            if(algorithm == PathAlgorithm::HPA)
+                grid.findPath(queries[0].start, queries[0].dest, path, scratch, algorithm);
+
+            const auto begin = std::chrono::steady_clock::now();
+            for(const Query& query : queries)
+            {
+                grid.findPath(query.start, query.dest, path, scratch, algorithm);
+                expanded += scratch.expanded;
+                length += path.size();
+                optimal += query.distance;
+                if(algorithm != PathAlgorithm::HPA && (int) path.size() != query.distance)
+                    wrong++;
+            }
+            const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+            std::printf("  %-5s %9.1f us/requête %10.1f développements/requête  longueur x%.3f  %d non optimaux\n",
+                name(algorithm), elapsed / queries.size(), (double) expanded / queries.size(), (double) length / optimal, wrong);
+        }
+
+        // Reconstruction incrémentale : un mur posé puis retiré au milieu de la grille
+        const int middle = grid.getGridWidth() / 2;
+        const Tile previous = grid.getTile(Vec2i(middle, middle));
+        PathScratch scratch;
+        std::vector<Vec2i> path;
+
+        const auto begin = std::chrono::steady_clock::now();
+        grid.setTile(previous.flags.solid ? AIR : WALL, middle, middle);
+        grid.findPath(queries[0].start, queries[0].dest, path, scratch, PathAlgorithm::HPA);
+        grid.setTile(previous, middle, middle);
+        grid.findPath(queries[0].start, queries[0].dest, path, scratch, PathAlgorithm::HPA);
+        const double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+
+        std::printf("  HPA* : 2 modifications + 2 requêtes avec reconstruction en %.1f us\n", elapsed);
+    }
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "../NEAT/SpeciesIndex.h"
+#include "../NEAT/Genome.h"
+#include "../NEAT/Mutator.h"
+#include "../NEAT/NeatConfig.h"
+#include "../NEAT/rng.h"
+#include "../engine/threadpool.h"
+
+namespace
+{
+    // Parcours séquentiel de toutes les paires génome/représentant, comme avant SpeciesIndex
+    void linear_speciate(std::vector<Species> &species, const std::vector<std::shared_ptr<Genome>> &genomes,
+                         const NeatConfig &config, int &next_species_id)
+    {
+        for (Species &s : species)
+            s.clear_members();
+
+        for (const auto &genome : genomes)
+        {
+            bool assigned = false;
+            for (Species &s : species)
+            {
+                if (genome->compute_distance(s.representative, config) < config.compatibility_threshold)
+                {
+                    s.add_member(genome);
+                    assigned = true;
+                    break;
+                }
+            }
+
+            if (!assigned)
+                species.emplace_back(next_species_id++, *genome);
+        }
+    }
+
+    // Descendants mutés de quelques ancêtres : des génomes proches et d'autres éloignés
+    std::vector<std::shared_ptr<Genome>> make_genomes(uint64_t seed, int count, const NeatConfig &config)
+    {
+        std::vector<Genome> ancestors;
+        for (int a = 0; a < 4; a++)
+        {
+            RNG rng(seed, 0, a, RngPurpose::INIT);
+            ancestors.push_back(Genome::create_minimal_genome(6, 3, rng));
+        }
+
+        std::vector<std::shared_ptr<Genome>> genomes;
+        for (int g = 0; g < count; g++)
+        {
+            RNG rng(seed, 1, g, RngPurpose::MUTATION);
+            auto genome = std::make_shared<Genome>(ancestors[g % ancestors.size()]);
+            const int mutations = rng.next_int(0, 30);
+            for (int m = 0; m < mutations; m++)
+                Mutator::mutate(*genome, config, rng);
+            genomes.push_back(genome);
+        }
+        return genomes;
+    }
+}
+
+// SpeciesIndex (minorant, arrêt anticipé, affectation parallèle) range chaque génome dans la même espèce
+// que le parcours séquentiel, quel que soit le nombre de threads.
+int main(void)
+{
+    NeatConfig config;
+    int failures = 0;
+
+    // Seuils bas : beaucoup d'espèces, dont une partie créée pendant le passage
+    for (double threshold : {0.3, 0.8, 3.0})
+    for (uint64_t seed : {1ULL, 42ULL})
+    {
+        config.compatibility_threshold = threshold;
+
+        // Les espèces existantes viennent d'une génération précédente
+        std::vector<Species> existing;
+        int next_id = 0;
+        linear_speciate(existing, make_genomes(seed + 1000, 40, config), config, next_id);
+        const int first_new_id = next_id;
+
+        const std::vector<std::shared_ptr<Genome>> genomes = make_genomes(seed, 300, config);
+
+        std::vector<Species> reference = existing;
+        linear_speciate(reference, genomes, config, next_id);
+
+        for (unsigned int threads : {1u, 2u, 3u, 8u})
+        {
+            simu::ThreadPool pool(threads);
+            std::vector<Species> indexed = existing;
+            int id = first_new_id;
+            SpeciesIndex index(config);
+            index.speciate(indexed, genomes, pool, [&id]() { return id++; });
+
+            bool same = indexed.size() == reference.size();
+            for (size_t s = 0; same && s < indexed.size(); s++)
+            {
+                same = indexed[s].id == reference[s].id && indexed[s].members.size() == reference[s].members.size();
+                for (size_t m = 0; same && m < indexed[s].members.size(); m++)
+                    same = indexed[s].members[m] == reference[s].members[m];
+            }
+
+            if (!same)
+            {
+                std::cout << "Seuil " << threshold << ", graine " << seed << ", " << threads << " threads: " << indexed.size() << " espèces au lieu de "
+                          << reference.size() << " ou membres différents" << std::endl;
+                failures++;
+            }
+            else if (threads == 1)
+            {
+                std::cout << "Seuil " << threshold << ", graine " << seed << ": " << reference.size() << " espèces, " << index.get_skipped()
+                          << " paires écartées, " << index.get_computed() << " distances calculées" << std::endl;
+            }
+        }
+    }
+
+    std::cout << (failures ? "ECHEC" : "OK") << std::endl;
+    return failures ? 1 : 0;
+}